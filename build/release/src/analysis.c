@@ -0,0 +1,185 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "analysis.h"
+#include "core_type.h"
+#include "observer.h"
+#include "queue.h"
+#include "subject.h"
+#include "task_graph.h"
+#include "task_handler.h"
+#include "timer_wheel.h"
+#include "process.h"
+#include "task.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+static bool analysis_has_run(struct task_t *task);
+static unsigned int analysis_get_last(task_handler_t *handler);
+static unsigned int analysis_get_release(task_handler_t *handler,
+                                         const unsigned int *first,
+                                         const unsigned int *index,
+                                         unsigned int node);
+
+/*!
+ * Analyzes a finished boot with the times that the tasks have recorded. The
+ * chain that decided the wall time is found by starting at the task which
+ * finished last and going back to the dependency that released each task,
+ * which is the dependency that finished last, or first for a target that
+ * only needs any of them.
+ *
+ * \param handler - A pointer to the task handler, all the tasks must have
+ *                  finished.
+ * \param result - Set to the analysis, it is deinitialized with
+ *                 \c analysis_deinit.
+ *
+ * \return \c ANALYSIS_SUCCESS if the boot was analyzed, \c ANALYSIS_FAIL
+ *         otherwise.
+ */
+int analysis_run(task_handler_t *handler, analysis_t *result)
+{
+    task_graph_t *graph = handler->graph;
+    unsigned int *first;
+    unsigned int *index;
+    unsigned int node;
+    unsigned int size = 0u;
+    task_t *task;
+    unsigned int i;
+
+    memset(result, 0, sizeof(analysis_t));
+    if (graph == NULL) {
+        return ANALYSIS_FAIL;
+    }
+
+    result->chain = malloc(sizeof(unsigned int) * (graph->nodes_size + 1u));
+    result->starved = malloc(sizeof(unsigned int) * (graph->nodes_size + 1u));
+    if ((result->chain == NULL) || (result->starved == NULL) ||
+        (task_graph_index(graph, graph->from, &first, &index) !=
+         TASK_GRAPH_SUCCESS)) {
+        analysis_deinit(result);
+        return ANALYSIS_FAIL;
+    }
+
+    node = analysis_get_last(handler);
+    if (node != TASK_GRAPH_NONE) {
+        result->wall = handler->nodes[node]->end_time;
+    }
+    for (; node != TASK_GRAPH_NONE;
+         node = analysis_get_release(handler, first, index, node)) {
+        result->chain[size] = node;
+        size++;
+    }
+
+    /* The chain was found from its end. */
+    result->chain_size = size;
+    for (i = 0u; i < size / 2u; i++) {
+        node = result->chain[i];
+        result->chain[i] = result->chain[size - 1u - i];
+        result->chain[size - 1u - i] = node;
+    }
+
+    for (i = 0u; i < graph->nodes_size; i++) {
+        task = handler->nodes[i];
+        if (analysis_has_run(task) && !task_is_target(task) &&
+            (task->start_time - task->admit_time > ANALYSIS_STARVATION_TIME)) {
+            result->starved[result->starved_size] = i;
+            result->starved_size++;
+        }
+    }
+
+    free(index);
+    free(first);
+    return ANALYSIS_SUCCESS;
+}
+
+/*!
+ * Frees the chain and the starved tasks of an analysis.
+ *
+ * \param result - A pointer to the analysis.
+ */
+void analysis_deinit(analysis_t *result)
+{
+    free(result->starved);
+    free(result->chain);
+    result->starved = NULL;
+    result->chain = NULL;
+    result->starved_size = 0u;
+    result->chain_size = 0u;
+}
+
+/*!
+ * Checks if a task has run or has been reached, the skipped tasks haven't
+ * taken any time.
+ */
+static bool analysis_has_run(task_t *task)
+{
+    return task->finished && (task_get_state(task) != TASK_STATE_SKIPPED);
+}
+
+/*!
+ * Gets the node of the task which finished last, \c TASK_GRAPH_NONE if no
+ * task has run.
+ */
+static unsigned int analysis_get_last(task_handler_t *handler)
+{
+    unsigned int last = TASK_GRAPH_NONE;
+    unsigned int i;
+
+    for (i = 0u; i < handler->graph->nodes_size; i++) {
+        if (analysis_has_run(handler->nodes[i]) &&
+            ((last == TASK_GRAPH_NONE) ||
+             (handler->nodes[i]->end_time >=
+              handler->nodes[last]->end_time))) {
+            last = i;
+        }
+    }
+    return last;
+}
+
+/*!
+ * Gets the dependency which released a task, \c TASK_GRAPH_NONE if the task
+ * didn't wait for any dependency.
+ */
+static unsigned int analysis_get_release(task_handler_t *handler,
+                                         const unsigned int *first,
+                                         const unsigned int *index,
+                                         unsigned int node)
+{
+    task_graph_t *graph = handler->graph;
+    bool any = handler->nodes[node]->any;
+    unsigned int release = TASK_GRAPH_NONE;
+    unsigned int dependency;
+    unsigned int edge;
+    unsigned int i;
+    task_t *task;
+
+    for (i = first[node]; i < first[node + 1u]; i++) {
+        edge = index[i];
+        dependency = graph->to[edge];
+        task = handler->nodes[dependency];
+        if (task_graph_is_removed(graph, edge) || !analysis_has_run(task)) {
+            continue;
+        }
+        if ((release == TASK_GRAPH_NONE) ||
+            (any ? (task->end_time < handler->nodes[release]->end_time) :
+                   (task->end_time >= handler->nodes[release]->end_time))) {
+            release = dependency;
+        }
+    }
+    return release;
+}
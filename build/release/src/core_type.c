@@ -0,0 +1,51 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "core_type.h"
+
+#include <stddef.h>
+
+/*!
+ * Initializes a service/daemon which doesn't have anything set. It is a
+ * oneshot service without any command or dependencies and every scheduling
+ * value is inherited from Speedy.
+ *
+ * \param service - A pointer to the service/daemon.
+ */
+void service_init(service_t *service)
+{
+    service->name = NULL;
+    service->provides = NULL;
+    service->dependency = NULL;
+    service->wants = NULL;
+    service->after = NULL;
+    service->action = NULL;
+    service->exec = NULL;
+    service->type = SERVICE_TYPE_ONESHOT;
+    service->listen = NULL;
+    service->nice = SERVICE_NOT_SET;
+    service->sched = SERVICE_SCHED_NOT_SET;
+    service->io_class = SERVICE_IO_CLASS_NOT_SET;
+    service->io_priority = SERVICE_NOT_SET;
+    service->cpus = NULL;
+    service->group = NULL;
+    service->io = 0u;
+    service->mem = 0u;
+    service->timeout = SERVICE_NOT_SET;
+    service->stop_timeout = SERVICE_NOT_SET;
+    service->duration = SERVICE_NOT_SET;
+    service->file = NULL;
+    service->line = 0;
+}
@@ -0,0 +1,893 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/* Needed for the CPU affinity and the scheduling policies. */
+#define _GNU_SOURCE
+
+#include "core_type.h"
+#include "process.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/capability.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+/*! The shell which is used for executing the commands of the services. */
+#define PROCESS_SHELL "/bin/sh"
+/*! The exit code of a child process that couldn't execute the shell. */
+#define PROCESS_EXEC_FAILED 127
+/*! The environment variable with the readiness file descriptor. */
+#define PROCESS_NOTIFY_ENV "NOTIFY_FD"
+/*! The environment variable with the number of passed sockets. */
+#define PROCESS_LISTEN_FDS_ENV "LISTEN_FDS"
+/*! The environment variable with the process id that the sockets are
+ *  passed to. */
+#define PROCESS_LISTEN_PID_ENV "LISTEN_PID"
+/*! The size of an environment variable with a number. */
+#define PROCESS_ENV_SIZE 32
+/*! The message that a process writes when it is ready. */
+#define PROCESS_NOTIFY_READY "READY=1"
+/*! The maximum length of a readiness message. */
+#define PROCESS_NOTIFY_LENGTH 64
+/*! The first file descriptor of the passed sockets. */
+#define PROCESS_LISTEN_FDS_START 3
+/*! The maximum length of the path of a pid file. */
+#define PROCESS_MAX_PATH 4096
+
+/*! The I/O priority definitions from the kernel, they are not exported by
+ *  the C library. */
+#define PROCESS_IOPRIO_CLASS_SHIFT 13
+#define PROCESS_IOPRIO_WHO_PROCESS 1
+#define PROCESS_IOPRIO_VALUE(class, data) \
+            (((class) << PROCESS_IOPRIO_CLASS_SHIFT) | (data))
+/*! The priority within a class when it isn't specified. */
+#define PROCESS_IOPRIO_DEFAULT 4
+/*! A nice value of n is allowed without privileges if RLIMIT_NICE is at
+ *  least this minus n. */
+#define PROCESS_NICE_RLIMIT_BASE 20
+
+/*!
+ * Everything that the child process needs between the fork and the exec.
+ * Only async-signal-safe functions may be called in the child of a process
+ * with several threads, since another thread may have held a lock such as
+ * the one of malloc when the process was forked. The parent therefore
+ * prepares the environment, the arguments and the file descriptors, and the
+ * child only moves the descriptors and executes the command.
+ */
+typedef struct process_plan_t {
+    /*! The arguments of the shell. */
+    char *argv[4];
+    /*! The environment of the command, the strings are owned by the parent
+     *  except for the variables below. */
+    char **envp;
+    /*! The LISTEN_FDS variable. */
+    char listen_fds[PROCESS_ENV_SIZE];
+    /*! The LISTEN_PID variable, the process id is filled in by the child. */
+    char listen_pid[PROCESS_ENV_SIZE];
+    /*! The NOTIFY_FD variable. */
+    char notify[PROCESS_ENV_SIZE];
+    /*! The descriptors that the child moves into place: the sockets, the
+     *  write end of the readiness pipe and the write end of the exec pipe,
+     *  -1 if not used. */
+    int *fds;
+    /*! The number of sockets in \c fds. */
+    unsigned int fds_size;
+    /*! The CPUs of the command. */
+    cpu_set_t cpus;
+    /*! \c true if the command is restricted to \c cpus. */
+    bool has_cpus;
+} process_plan_t;
+
+static int process_plan_init(process_plan_t *plan, service_t *service,
+                             const int *fds, unsigned int fds_size,
+                             int notify_fd, int exec_fd);
+static void process_plan_deinit(process_plan_t *plan);
+static void process_exec_child(process_plan_t *plan, service_t *service);
+static void process_format_pid(char *digits, pid_t pid);
+static void process_apply_class(service_t *service, pid_t tid);
+static bool process_can_restore(service_t *service,
+                                const process_class_t *saved);
+static int process_get_policy(service_sched_t sched);
+static int process_get_io_priority(service_t *service);
+static int process_parse_cpus(const char *cpus, cpu_set_t *set);
+static unsigned long process_wait_exec(int exec_fd,
+                                       const struct timespec *start);
+static unsigned long process_get_time(const struct timeval *time);
+
+/*!
+ * Starts the command of a service in a new process. The scheduling class of
+ * the service is applied in the child process before the command is
+ * executed.
+ *
+ * The command gets its own process group with the same id as the process,
+ * so that \c process_signal also reaches the processes that the shell
+ * starts.
+ *
+ * The listening sockets are passed to the command from file descriptor 3 and
+ * onwards, and the number of sockets is stored in the environment variable
+ * LISTEN_FDS. LISTEN_PID is the process id of the shell, so the command
+ * should be started with \c exec if it checks LISTEN_PID.
+ *
+ * \param service - A pointer to the service.
+ * \param fds - The listening sockets of the service.
+ * \param fds_size - The number of listening sockets.
+ * \param pid - The process id of the started process.
+ * \param notify_fd - The file descriptor that the readiness is read from if
+ *                    the service is a notify service, -1 otherwise. It can
+ *                    be \c NULL for services that aren't notify services.
+ * \param usage - Set to the time from the fork until the command was
+ *                executed, the call then returns after the exec. It can be
+ *                \c NULL if the time isn't needed.
+ *
+ * \return \c PROCESS_SUCCESS if the process was started,
+ *         \c PROCESS_FAIL otherwise.
+ */
+int process_spawn(service_t *service, const int *fds, unsigned int fds_size,
+                  pid_t *pid, int *notify_fd, process_usage_t *usage)
+{
+    int notify[2] = {-1, -1};
+    int exec[2] = {-1, -1};
+    process_plan_t plan;
+    struct timespec start;
+    pid_t child;
+
+    if (service->exec == NULL) {
+        return PROCESS_FAIL;
+    }
+
+    if ((service->type == SERVICE_TYPE_NOTIFY) && (notify_fd != NULL)) {
+        if (pipe2(notify, O_CLOEXEC) != 0) {
+            return PROCESS_FAIL;
+        }
+    }
+
+    /* The write end is closed by the exec, so the read end reaches the end
+       of the file when the command has been executed. */
+    if ((usage != NULL) && (pipe2(exec, O_CLOEXEC) != 0)) {
+        exec[0] = -1;
+        exec[1] = -1;
+    }
+
+    if (process_plan_init(&plan, service, fds, fds_size, notify[1],
+                          exec[1]) != PROCESS_SUCCESS) {
+        child = -1;
+    } else {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        child = fork();
+
+        if (child == 0) {
+            process_exec_child(&plan, service);
+        }
+        if (child > 0) {
+            /* Also done by the child, whichever runs first creates the
+               group so that it exists before anyone can signal it. */
+            setpgid(child, child);
+        }
+        process_plan_deinit(&plan);
+    }
+
+    if (notify[1] >= 0) {
+        close(notify[1]);
+    }
+    if (exec[1] >= 0) {
+        close(exec[1]);
+    }
+    if (child < 0) {
+        if (notify[0] >= 0) {
+            close(notify[0]);
+        }
+        if (exec[0] >= 0) {
+            close(exec[0]);
+        }
+        return PROCESS_FAIL;
+    }
+
+    if (usage != NULL) {
+        memset(usage, 0, sizeof(process_usage_t));
+        if (exec[0] >= 0) {
+            usage->spawn_time = process_wait_exec(exec[0], &start);
+            close(exec[0]);
+        }
+    }
+
+    if (notify_fd != NULL) {
+        *notify_fd = notify[0];
+    }
+    *pid = child;
+    return PROCESS_SUCCESS;
+}
+
+/*!
+ * Waits until a process reports that it is ready by writing a line with
+ * "READY=1" to the readiness file descriptor. Other lines are ignored.
+ *
+ * \param notify_fd - The readiness file descriptor from \c process_spawn.
+ *
+ * \return \c PROCESS_READY if the process is ready, \c PROCESS_FAIL if the
+ *         process closed the file descriptor without being ready.
+ */
+int process_wait_ready(int notify_fd)
+{
+    char line[PROCESS_NOTIFY_LENGTH];
+    size_t length = 0u;
+    ssize_t size;
+    char character;
+
+    for (;;) {
+        size = read(notify_fd, &character, 1);
+
+        if ((size < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if ((size <= 0) || (character == '\n')) {
+            line[length] = '\0';
+            if (strcmp(line, PROCESS_NOTIFY_READY) == 0) {
+                return PROCESS_READY;
+            }
+            if (size <= 0) {
+                return PROCESS_FAIL;
+            }
+            length = 0u;
+
+        } else if (length < (sizeof(line) - 1u)) {
+            line[length] = character;
+            length++;
+        }
+    }
+}
+
+/*!
+ * Waits until a process has exited and reaps it.
+ *
+ * \param pid - The process id.
+ * \param usage - Set to the resources that the process used, the spawn
+ *                time is kept. It can be \c NULL.
+ *
+ * \return \c PROCESS_SUCCESS if the process exited with exit code 0,
+ *         \c PROCESS_FAIL otherwise.
+ */
+int process_wait(pid_t pid, process_usage_t *usage)
+{
+    struct rusage resources;
+    int status;
+
+    while (wait4(pid, &status, 0, &resources) < 0) {
+        if (errno != EINTR) {
+            return PROCESS_FAIL;
+        }
+    }
+
+    if (usage != NULL) {
+        usage->user_time = process_get_time(&resources.ru_utime);
+        usage->system_time = process_get_time(&resources.ru_stime);
+        usage->max_rss = resources.ru_maxrss;
+        usage->major_faults = resources.ru_majflt;
+        usage->minor_faults = resources.ru_minflt;
+        usage->voluntary_switches = resources.ru_nvcsw;
+        usage->involuntary_switches = resources.ru_nivcsw;
+        usage->block_input = resources.ru_inblock;
+        usage->block_output = resources.ru_oublock;
+    }
+
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) {
+        return PROCESS_SUCCESS;
+    }
+    return PROCESS_FAIL;
+}
+
+/*!
+ * Waits until a process has exited without reaping it, the process id can't
+ * be reused until \c process_wait has been called. This makes it safe to
+ * signal the process from another thread until then.
+ *
+ * \param pid - The process id.
+ *
+ * \return \c PROCESS_SUCCESS if the process has exited,
+ *         \c PROCESS_FAIL otherwise.
+ */
+int process_wait_exit(pid_t pid)
+{
+    siginfo_t info;
+
+    while (waitid(P_PID, (id_t) pid, &info, WEXITED | WNOWAIT) < 0) {
+        if (errno != EINTR) {
+            return PROCESS_FAIL;
+        }
+    }
+    return PROCESS_SUCCESS;
+}
+
+/*!
+ * Sends a signal to a command started by \c process_spawn and to all the
+ * processes that it has started, they are in the process group of the
+ * command. The shell doesn't always execute the last command in place, so
+ * signalling only the shell could leave the actual work running.
+ *
+ * \param pid - The process id of the command.
+ * \param signal_number - The signal.
+ *
+ * \return \c PROCESS_SUCCESS if any process got the signal,
+ *         \c PROCESS_FAIL otherwise.
+ */
+int process_signal(pid_t pid, int signal_number)
+{
+    if ((pid <= 0) || (kill(-pid, signal_number) != 0)) {
+        return PROCESS_FAIL;
+    }
+    return PROCESS_SUCCESS;
+}
+
+/*!
+ * Opens a file descriptor which becomes readable when a process exits.
+ *
+ * \param pid - The process id.
+ *
+ * \return The file descriptor or -1 if the kernel doesn't support it.
+ */
+int process_pidfd_open(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    int pidfd = (int) syscall(SYS_pidfd_open, pid, 0);
+
+    if (pidfd >= 0) {
+        fcntl(pidfd, F_SETFD, FD_CLOEXEC);
+        return pidfd;
+    }
+#else
+    (void) pid;
+#endif
+    return -1;
+}
+
+/*!
+ * Writes the process id of a running service to "<run_dir>/<name>.pid",
+ * this lets a later "speedy stop" find the process.
+ *
+ * \param run_dir - The directory of the pid files.
+ * \param name - The name of the service.
+ * \param pid - The process id.
+ *
+ * \return \c PROCESS_SUCCESS if the file was written,
+ *         \c PROCESS_FAIL otherwise.
+ */
+int process_write_pid_file(const char *run_dir, const char *name, pid_t pid)
+{
+    char path[PROCESS_MAX_PATH];
+    int status = PROCESS_FAIL;
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s/%s.pid", run_dir, name);
+
+    file = fopen(path, "w");
+    if (file != NULL) {
+        if (fprintf(file, "%d\n", (int) pid) > 0) {
+            status = PROCESS_SUCCESS;
+        }
+        if (fclose(file) != 0) {
+            status = PROCESS_FAIL;
+        }
+    }
+    return status;
+}
+
+/*!
+ * Reads the process id of a service from its pid file.
+ *
+ * \param run_dir - The directory of the pid files.
+ * \param name - The name of the service.
+ *
+ * \return The process id or 0 if the service has no valid pid file.
+ */
+pid_t process_read_pid_file(const char *run_dir, const char *name)
+{
+    char path[PROCESS_MAX_PATH];
+    int pid = 0;
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s/%s.pid", run_dir, name);
+
+    file = fopen(path, "r");
+    if (file != NULL) {
+        if ((fscanf(file, "%d", &pid) != 1) || (pid <= 0)) {
+            pid = 0;
+        }
+        fclose(file);
+    }
+    return (pid_t) pid;
+}
+
+/*!
+ * Removes the pid file of a service.
+ *
+ * \param run_dir - The directory of the pid files.
+ * \param name - The name of the service.
+ */
+void process_remove_pid_file(const char *run_dir, const char *name)
+{
+    char path[PROCESS_MAX_PATH];
+
+    snprintf(path, sizeof(path), "%s/%s.pid", run_dir, name);
+    unlink(path);
+}
+
+/*!
+ * Executes the command of a service and waits until it has finished.
+ *
+ * \param service - A pointer to the service.
+ *
+ * \return \c PROCESS_SUCCESS if the command was successfully executed,
+ *         \c PROCESS_FAIL otherwise.
+ */
+int process_run(service_t *service)
+{
+    pid_t pid;
+
+    if (process_spawn(service, NULL, 0u, &pid, NULL, NULL) !=
+        PROCESS_SUCCESS) {
+        return PROCESS_FAIL;
+    }
+    return process_wait(pid, NULL);
+}
+
+/*!
+ * Lets the calling thread follow the scheduling class of a service, this
+ * makes the work that Speedy does on behalf of the service compete on the
+ * same terms as the service itself. Nothing is changed if the thread
+ * wouldn't be allowed to go back to its current class afterwards, since it
+ * would then run the tasks after the service with the lower priority.
+ *
+ * \note The CPU affinity is only applied to the process of the service.
+ *
+ * \param service - A pointer to the service.
+ * \param saved - Stores the previous settings of the thread.
+ */
+void process_class_enter(service_t *service, process_class_t *saved)
+{
+    pid_t tid;
+
+    saved->changed = false;
+
+    if ((service->nice == SERVICE_NOT_SET) &&
+        (service->sched == SERVICE_SCHED_NOT_SET) &&
+        (service->io_class == SERVICE_IO_CLASS_NOT_SET)) {
+
+        return;
+    }
+
+    tid = (pid_t) syscall(SYS_gettid);
+
+    errno = 0;
+    saved->nice = getpriority(PRIO_PROCESS, tid);
+    saved->policy = sched_getscheduler(tid);
+    saved->io_priority = (int) syscall(SYS_ioprio_get,
+                                       PROCESS_IOPRIO_WHO_PROCESS, tid);
+    saved->changed = (errno == 0) && (saved->policy >= 0) &&
+                     (saved->io_priority >= 0) &&
+                     process_can_restore(service, saved);
+
+    if (saved->changed) {
+        process_apply_class(service, tid);
+    }
+}
+
+/*!
+ * Restores the scheduling class of the calling thread.
+ *
+ * \param saved - The settings from \c process_class_enter.
+ */
+void process_class_leave(process_class_t *saved)
+{
+    struct sched_param param;
+    pid_t tid;
+
+    if (saved->changed) {
+        tid = (pid_t) syscall(SYS_gettid);
+        param.sched_priority = 0;
+
+        sched_setscheduler(tid, saved->policy, &param);
+        setpriority(PRIO_PROCESS, tid, saved->nice);
+        syscall(SYS_ioprio_set, PROCESS_IOPRIO_WHO_PROCESS, tid,
+                saved->io_priority);
+        saved->changed = false;
+    }
+}
+
+/*!
+ * Checks if a thread that follows the scheduling class of a service can go
+ * back to its previous class. A thread may always lower its priority and
+ * go back to the best effort I/O class, but it may only leave SCHED_IDLE or
+ * lower its nice value again with CAP_SYS_NICE or within RLIMIT_NICE.
+ *
+ * \param service - A pointer to the service.
+ * \param saved - The current settings of the thread.
+ *
+ * \return \c true if the previous class can be restored.
+ */
+static bool process_can_restore(service_t *service,
+                                const process_class_t *saved)
+{
+    struct __user_cap_header_struct header;
+    struct __user_cap_data_struct data[2];
+    struct rlimit limit;
+
+    if (((service->nice == SERVICE_NOT_SET) ||
+         (service->nice <= saved->nice)) &&
+        (service->sched != SERVICE_SCHED_IDLE)) {
+
+        return true;
+    }
+    if (geteuid() == 0) {
+        return true;
+    }
+
+    header.version = _LINUX_CAPABILITY_VERSION_3;
+    header.pid = 0;
+    if ((syscall(SYS_capget, &header, data) == 0) &&
+        ((data[CAP_TO_INDEX(CAP_SYS_NICE)].effective &
+          CAP_TO_MASK(CAP_SYS_NICE)) != 0u)) {
+
+        return true;
+    }
+
+    return (getrlimit(RLIMIT_NICE, &limit) == 0) &&
+           ((limit.rlim_cur == RLIM_INFINITY) ||
+            ((rlim_t) (PROCESS_NICE_RLIMIT_BASE - saved->nice) <=
+             limit.rlim_cur));
+}
+
+/*!
+ * Prepares the child process of a command in the parent.
+ *
+ * \param plan - The plan to fill in.
+ * \param service - A pointer to the service.
+ * \param fds - The listening sockets.
+ * \param fds_size - The number of listening sockets.
+ * \param notify_fd - The write end of the readiness pipe, -1 if the service
+ *                    isn't a notify service.
+ * \param exec_fd - The write end of the exec pipe, -1 if it isn't used.
+ *
+ * \return \c PROCESS_SUCCESS if the plan was prepared,
+ *         \c PROCESS_FAIL otherwise.
+ */
+static int process_plan_init(process_plan_t *plan, service_t *service,
+                             const int *fds, unsigned int fds_size,
+                             int notify_fd, int exec_fd)
+{
+    static const char *replaced[] = {
+        PROCESS_NOTIFY_ENV "=", PROCESS_LISTEN_FDS_ENV "=",
+        PROCESS_LISTEN_PID_ENV "="
+    };
+    unsigned int environ_size = 0u;
+    unsigned int size = 0u;
+    unsigned int i;
+    unsigned int j;
+    bool keep;
+
+    plan->argv[0] = "sh";
+    plan->argv[1] = "-c";
+    plan->argv[2] = service->exec;
+    plan->argv[3] = NULL;
+    plan->fds_size = fds_size;
+
+    plan->has_cpus = (service->cpus != NULL) &&
+                     (process_parse_cpus(service->cpus, &plan->cpus) ==
+                      PROCESS_SUCCESS);
+
+    plan->fds = malloc(sizeof(int) * (fds_size + 2u));
+    while ((environ != NULL) && (environ[environ_size] != NULL)) {
+        environ_size++;
+    }
+    plan->envp = malloc(sizeof(char*) * (environ_size + 4u));
+    if ((plan->fds == NULL) || (plan->envp == NULL)) {
+        process_plan_deinit(plan);
+        return PROCESS_FAIL;
+    }
+
+    for (i = 0u; i < fds_size; i++) {
+        plan->fds[i] = fds[i];
+    }
+    plan->fds[fds_size] = notify_fd;
+    plan->fds[fds_size + 1u] = exec_fd;
+
+    /* The variables of Speedy itself are never passed on, only the ones
+       that belong to this command. */
+    for (i = 0u; i < environ_size; i++) {
+        keep = true;
+        for (j = 0u; j < sizeof(replaced) / sizeof(replaced[0]); j++) {
+            if (strncmp(environ[i], replaced[j], strlen(replaced[j])) == 0) {
+                keep = false;
+            }
+        }
+        if (keep) {
+            plan->envp[size++] = environ[i];
+        }
+    }
+
+    if (notify_fd >= 0) {
+        /* The write end is placed right after the sockets. */
+        snprintf(plan->notify, sizeof(plan->notify), "%s=%u",
+                 PROCESS_NOTIFY_ENV, PROCESS_LISTEN_FDS_START + fds_size);
+        plan->envp[size++] = plan->notify;
+    }
+    if (fds_size > 0u) {
+        snprintf(plan->listen_fds, sizeof(plan->listen_fds), "%s=%u",
+                 PROCESS_LISTEN_FDS_ENV, fds_size);
+        snprintf(plan->listen_pid, sizeof(plan->listen_pid), "%s=",
+                 PROCESS_LISTEN_PID_ENV);
+        plan->envp[size++] = plan->listen_fds;
+        plan->envp[size++] = plan->listen_pid;
+    }
+    plan->envp[size] = NULL;
+    return PROCESS_SUCCESS;
+}
+
+/*!
+ * Frees what the parent allocated for a child process.
+ */
+static void process_plan_deinit(process_plan_t *plan)
+{
+    free(plan->fds);
+    free(plan->envp);
+    plan->fds = NULL;
+    plan->envp = NULL;
+}
+
+/*!
+ * Sets up the child process and executes the command, this never returns.
+ * Only async-signal-safe functions are called here.
+ *
+ * The sockets end up from file descriptor 3 and onwards, directly followed
+ * by the write end of the readiness pipe. Every descriptor is first moved
+ * above that range, otherwise one could be overwritten before it has been
+ * moved to its place. All the other descriptors are closed by the exec,
+ * including the exec pipe which tells the parent that the command is
+ * running.
+ *
+ * \param plan - The plan from the parent.
+ * \param service - A pointer to the service.
+ */
+static void process_exec_child(process_plan_t *plan, service_t *service)
+{
+    int first_free = PROCESS_LISTEN_FDS_START + (int) plan->fds_size + 1;
+    unsigned int i;
+
+    setpgid(0, 0);
+
+    for (i = 0u; i < plan->fds_size + 2u; i++) {
+        if (plan->fds[i] >= 0) {
+            plan->fds[i] = fcntl(plan->fds[i], F_DUPFD_CLOEXEC, first_free);
+            if (plan->fds[i] < 0) {
+                _exit(PROCESS_EXEC_FAILED);
+            }
+        }
+    }
+    /* The sockets and the readiness pipe are inherited, dup2 clears the
+       close-on-exec flag of the copies. */
+    for (i = 0u; i < plan->fds_size + 1u; i++) {
+        if ((plan->fds[i] >= 0) &&
+            (dup2(plan->fds[i], PROCESS_LISTEN_FDS_START + (int) i) < 0)) {
+            _exit(PROCESS_EXEC_FAILED);
+        }
+    }
+
+    if (plan->fds_size > 0u) {
+        process_format_pid(plan->listen_pid +
+                           strlen(PROCESS_LISTEN_PID_ENV "="), getpid());
+    }
+
+    process_apply_class(service, 0);
+    if (plan->has_cpus) {
+        sched_setaffinity(0, sizeof(plan->cpus), &plan->cpus);
+    }
+
+    execve(PROCESS_SHELL, plan->argv, plan->envp);
+    _exit(PROCESS_EXEC_FAILED);
+}
+
+/*!
+ * Writes a process id as decimal digits, it is async-signal-safe unlike
+ * \c snprintf.
+ *
+ * \param digits - The buffer, it must have room for the digits of any
+ *                 process id and the terminating zero.
+ * \param pid - The process id.
+ */
+static void process_format_pid(char *digits, pid_t pid)
+{
+    char reversed[PROCESS_ENV_SIZE];
+    unsigned long value = (unsigned long) pid;
+    unsigned int size = 0u;
+
+    do {
+        reversed[size++] = (char) ('0' + (value % 10u));
+        value /= 10u;
+    } while (value > 0u);
+
+    while (size > 0u) {
+        *digits++ = reversed[--size];
+    }
+    *digits = '\0';
+}
+
+/*!
+ * Applies the nice value, the CPU scheduling policy and the I/O scheduling
+ * class of a service to a thread.
+ *
+ * \param service - A pointer to the service.
+ * \param tid - The thread id, 0 for the calling thread.
+ */
+static void process_apply_class(service_t *service, pid_t tid)
+{
+    struct sched_param param;
+
+    if (service->sched != SERVICE_SCHED_NOT_SET) {
+        param.sched_priority = 0;
+        sched_setscheduler(tid, process_get_policy(service->sched), &param);
+    }
+    if (service->nice != SERVICE_NOT_SET) {
+        setpriority(PRIO_PROCESS, tid, service->nice);
+    }
+    if (service->io_class != SERVICE_IO_CLASS_NOT_SET) {
+        syscall(SYS_ioprio_set, PROCESS_IOPRIO_WHO_PROCESS, tid,
+                process_get_io_priority(service));
+    }
+}
+
+/*!
+ * Converts a CPU scheduling policy to the value used by the kernel.
+ *
+ * \param sched - The CPU scheduling policy.
+ *
+ * \return The kernel value of the policy.
+ */
+static int process_get_policy(service_sched_t sched)
+{
+    switch (sched) {
+        case SERVICE_SCHED_BATCH:
+            return SCHED_BATCH;
+
+        case SERVICE_SCHED_IDLE:
+            return SCHED_IDLE;
+
+        case SERVICE_SCHED_OTHER:
+        case SERVICE_SCHED_NOT_SET:
+        default:
+            return SCHED_OTHER;
+    }
+}
+
+/*!
+ * Converts the I/O scheduling class and priority of a service to the value
+ * used by the kernel.
+ *
+ * \param service - A pointer to the service.
+ *
+ * \return The kernel value of the I/O priority.
+ */
+static int process_get_io_priority(service_t *service)
+{
+    int priority = PROCESS_IOPRIO_DEFAULT;
+
+    if ((service->io_priority >= 0) && (service->io_priority <= 7)) {
+        priority = service->io_priority;
+    }
+
+    switch (service->io_class) {
+        case SERVICE_IO_CLASS_REALTIME:
+            return PROCESS_IOPRIO_VALUE(1, priority);
+
+        case SERVICE_IO_CLASS_IDLE:
+            /* The idle class doesn't have any priority levels. */
+            return PROCESS_IOPRIO_VALUE(3, 0);
+
+        case SERVICE_IO_CLASS_BEST_EFFORT:
+        case SERVICE_IO_CLASS_NOT_SET:
+        default:
+            return PROCESS_IOPRIO_VALUE(2, priority);
+    }
+}
+
+/*!
+ * Parses a list of CPUs.
+ *
+ * \param cpus - A list of CPUs and CPU ranges, for example "0-3,6".
+ * \param set - Set to the CPUs in the list.
+ *
+ * \return \c PROCESS_SUCCESS if the list was valid,
+ *         \c PROCESS_FAIL otherwise.
+ */
+static int process_parse_cpus(const char *cpus, cpu_set_t *set)
+{
+    const char *current = cpus;
+    char *end;
+    long first;
+    long last;
+    long cpu;
+
+    CPU_ZERO(set);
+
+    while (*current != '\0') {
+        first = strtol(current, &end, 10);
+        if ((end == current) || (first < 0)) {
+            return PROCESS_FAIL;
+        }
+        last = first;
+
+        if (*end == '-') {
+            current = end + 1;
+            last = strtol(current, &end, 10);
+            if ((end == current) || (last < first)) {
+                return PROCESS_FAIL;
+            }
+        }
+
+        for (cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++) {
+            CPU_SET(cpu, set);
+        }
+
+        current = end;
+        if (*current == ',') {
+            current++;
+        } else if (*current != '\0') {
+            return PROCESS_FAIL;
+        }
+    }
+    return PROCESS_SUCCESS;
+}
+
+/*!
+ * Waits until the command of a new process has been executed, or until the
+ * child has exited without executing it.
+ *
+ * \param exec_fd - The read end of the pipe which is closed by the exec.
+ * \param start - The time of the fork.
+ *
+ * \return The time in microseconds since the fork.
+ */
+static unsigned long process_wait_exec(int exec_fd,
+                                       const struct timespec *start)
+{
+    struct timespec now;
+    char buffer;
+    long elapsed;
+
+    while ((read(exec_fd, &buffer, 1) < 0) && (errno == EINTR)) {
+        /* Retry. */
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (long) (now.tv_sec - start->tv_sec) * 1000000L +
+              (now.tv_nsec - start->tv_nsec) / 1000L;
+    return (elapsed > 0) ? (unsigned long) elapsed : 0u;
+}
+
+/*!
+ * Converts a CPU time from the kernel to microseconds.
+ */
+static unsigned long process_get_time(const struct timeval *time)
+{
+    return (unsigned long) time->tv_sec * 1000000u +
+           (unsigned long) time->tv_usec;
+}
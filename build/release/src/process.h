@@ -0,0 +1,93 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_PROCESS_H_
+#define _SPEEDY_PROCESS_H_
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*! The process was successfully started or exited successfully. */
+#define PROCESS_SUCCESS 0
+/*! The process couldn't be started or exited with an error. */
+#define PROCESS_FAIL -1
+/*! The process has reported that it is ready. */
+#define PROCESS_READY 1
+
+struct service_t;
+
+/*!
+ * The scheduling settings of a thread before it started to follow the
+ * scheduling class of a service. It is used for restoring the thread when the
+ * service has finished.
+ */
+typedef struct process_class_t {
+    /*! \c true if the scheduling settings of the thread were changed. */
+    bool changed;
+    /*! The previous nice value of the thread. */
+    int nice;
+    /*! The previous CPU scheduling policy of the thread. */
+    int policy;
+    /*! The previous I/O priority of the thread. */
+    int io_priority;
+} process_class_t;
+
+/*!
+ * The resources that a command used, they are taken from the kernel when
+ * the process is reaped.
+ */
+typedef struct process_usage_t {
+    /*! The time in microseconds from the fork until the command was
+     *  executed. */
+    unsigned long spawn_time;
+    /*! The CPU time in microseconds spent in user mode. */
+    unsigned long user_time;
+    /*! The CPU time in microseconds spent in the kernel. */
+    unsigned long system_time;
+    /*! The maximum resident set size in kilobytes. */
+    long max_rss;
+    /*! The page faults which needed I/O. */
+    long major_faults;
+    /*! The page faults which were served without I/O. */
+    long minor_faults;
+    /*! The times the process gave up the CPU while waiting. */
+    long voluntary_switches;
+    /*! The times the process was preempted. */
+    long involuntary_switches;
+    /*! The number of block input operations. */
+    long block_input;
+    /*! The number of block output operations. */
+    long block_output;
+} process_usage_t;
+
+int process_spawn(struct service_t *service, const int *fds,
+                  unsigned int fds_size, pid_t *pid, int *notify_fd,
+                  process_usage_t *usage);
+int process_wait_ready(int notify_fd);
+int process_wait(pid_t pid, process_usage_t *usage);
+int process_wait_exit(pid_t pid);
+int process_run(struct service_t *service);
+int process_signal(pid_t pid, int signal_number);
+int process_pidfd_open(pid_t pid);
+
+int process_write_pid_file(const char *run_dir, const char *name, pid_t pid);
+pid_t process_read_pid_file(const char *run_dir, const char *name);
+void process_remove_pid_file(const char *run_dir, const char *name);
+
+void process_class_enter(struct service_t *service, process_class_t *saved);
+void process_class_leave(process_class_t *saved);
+
+#endif /* _SPEEDY_PROCESS_H_ */
@@ -0,0 +1,416 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "simulator.h"
+#include "core_type.h"
+#include "observer.h"
+#include "queue.h"
+#include "subject.h"
+#include "task_graph.h"
+#include "task_handler.h"
+#include "timer_wheel.h"
+#include "process.h"
+#include "task.h"
+
+#include <pthread.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int simulator_init(simulator_t *this_ptr, task_handler_t *handler,
+                          unsigned int threads, simulator_policy_t policy);
+static void simulator_deinit(simulator_t *this_ptr);
+static bool simulator_is_instant(simulator_t *this_ptr, unsigned int node);
+static void simulator_finish(simulator_t *this_ptr, unsigned int node);
+static void simulator_admit(simulator_t *this_ptr, task_t *task);
+static void simulator_dispatch(simulator_t *this_ptr, unsigned int cause);
+static int simulator_get_chain(simulator_t *this_ptr,
+                               simulator_result_t *result);
+
+/*!
+ * Predicts a boot with the calculated dependencies of a task handler. The
+ * task handler isn't changed, its admission state is borrowed during the
+ * simulation and is the same afterwards. The pressure thresholds are ignored
+ * since there isn't any pressure to measure.
+ *
+ * \param handler - A pointer to the task handler, the dependencies must have
+ *                  been calculated.
+ * \param threads - The number of worker threads.
+ * \param policy - The order in which the ready tasks are started.
+ * \param result - Set to the predicted boot, it is deinitialized with
+ *                 \c simulator_result_deinit.
+ *
+ * \return \c SIMULATOR_SUCCESS if the boot was simulated,
+ *         \c SIMULATOR_FAIL otherwise.
+ */
+int simulator_run(task_handler_t *handler, unsigned int threads,
+                  simulator_policy_t policy, simulator_result_t *result)
+{
+    simulator_t simulator;
+    struct pressure_t *pressure;
+    unsigned int i;
+    int status;
+
+    memset(result, 0, sizeof(simulator_result_t));
+    result->threads = threads;
+    if ((handler->graph == NULL) || (threads == 0u)) {
+        return SIMULATOR_FAIL;
+    }
+    if (simulator_init(&simulator, handler, threads, policy) !=
+        SIMULATOR_SUCCESS) {
+        return SIMULATOR_FAIL;
+    }
+
+    pthread_mutex_lock(&handler->mutex);
+    pressure = handler->pressure;
+    handler->pressure = NULL;
+
+    for (i = 0u; i < simulator.graph->nodes_size; i++) {
+        if (simulator.released[i] || (simulator.remaining[i] > 0u)) {
+            continue;
+        }
+        simulator.released[i] = true;
+        if (simulator_is_instant(&simulator, i)) {
+            simulator_finish(&simulator, i);
+        } else {
+            simulator.batch[simulator.batch_size] = simulator.nodes[i];
+            simulator.batch_size++;
+        }
+    }
+    simulator_admit(&simulator, NULL);
+    simulator_dispatch(&simulator, TASK_GRAPH_NONE);
+
+    while (simulator.running_size > 0u) {
+        unsigned int next = 0u;
+        task_t *task;
+
+        for (i = 1u; i < simulator.running_size; i++) {
+            if (simulator.end[simulator.running[i]->index] <
+                simulator.end[simulator.running[next]->index]) {
+                next = i;
+            }
+        }
+        task = simulator.running[next];
+        simulator.running_size--;
+        simulator.running[next] = simulator.running[simulator.running_size];
+
+        simulator.now = simulator.end[task->index];
+        simulator_finish(&simulator, task->index);
+        simulator_admit(&simulator, task);
+        simulator_dispatch(&simulator, task->index);
+    }
+
+    handler->pressure = pressure;
+    pthread_mutex_unlock(&handler->mutex);
+
+    result->makespan = simulator.now;
+    result->busy = simulator.busy;
+    result->finished = simulator.finished;
+    status = simulator_get_chain(&simulator, result);
+
+    simulator_deinit(&simulator);
+    return status;
+}
+
+/*!
+ * Frees the critical chain of a simulated boot.
+ *
+ * \param result - A pointer to the result of \c simulator_run.
+ */
+void simulator_result_deinit(simulator_result_t *result)
+{
+    free(result->chain);
+    result->chain = NULL;
+    result->chain_size = 0u;
+}
+
+/*!
+ * Allocates the state of a simulation, every node waits for its dependencies
+ * which haven't been removed from the graph.
+ */
+static int simulator_init(simulator_t *this_ptr, task_handler_t *handler,
+                          unsigned int threads, simulator_policy_t policy)
+{
+    task_graph_t *graph = handler->graph;
+    unsigned int size = graph->nodes_size + 1u;
+    unsigned int i;
+
+    memset(this_ptr, 0, sizeof(simulator_t));
+    this_ptr->handler = handler;
+    this_ptr->graph = graph;
+    this_ptr->nodes = handler->nodes;
+    this_ptr->policy = policy;
+    this_ptr->threads = threads;
+
+    this_ptr->remaining = calloc(size, sizeof(unsigned int));
+    this_ptr->released = calloc(size, sizeof(bool));
+    this_ptr->ready_at = calloc(size, sizeof(unsigned long));
+    this_ptr->end = calloc(size, sizeof(unsigned long));
+    this_ptr->cause = malloc(sizeof(unsigned int) * size);
+    this_ptr->batch = malloc(sizeof(task_t*) * size);
+    this_ptr->pending = malloc(sizeof(task_t*) * size);
+    this_ptr->kept = malloc(sizeof(task_t*) * size);
+    this_ptr->queue = malloc(sizeof(task_t*) * size);
+    this_ptr->running = malloc(sizeof(task_t*) * size);
+    this_ptr->stack = malloc(sizeof(unsigned int) * size);
+
+    if ((this_ptr->remaining == NULL) || (this_ptr->released == NULL) ||
+        (this_ptr->ready_at == NULL) || (this_ptr->end == NULL) ||
+        (this_ptr->cause == NULL) || (this_ptr->batch == NULL) ||
+        (this_ptr->pending == NULL) || (this_ptr->kept == NULL) ||
+        (this_ptr->queue == NULL) ||
+        (this_ptr->running == NULL) || (this_ptr->stack == NULL) ||
+        (task_graph_index(graph, graph->to, &this_ptr->first,
+                          &this_ptr->index) != TASK_GRAPH_SUCCESS)) {
+        simulator_deinit(this_ptr);
+        return SIMULATOR_FAIL;
+    }
+
+    for (i = 0u; i < graph->nodes_size; i++) {
+        this_ptr->cause[i] = TASK_GRAPH_NONE;
+    }
+    for (i = 0u; i < graph->edges_size; i++) {
+        if (!task_graph_is_removed(graph, i)) {
+            this_ptr->remaining[graph->from[i]]++;
+        }
+    }
+    return SIMULATOR_SUCCESS;
+}
+
+/*!
+ * Frees the state of a simulation.
+ */
+static void simulator_deinit(simulator_t *this_ptr)
+{
+    free(this_ptr->index);
+    free(this_ptr->first);
+    free(this_ptr->stack);
+    free(this_ptr->running);
+    free(this_ptr->queue);
+    free(this_ptr->kept);
+    free(this_ptr->pending);
+    free(this_ptr->batch);
+    free(this_ptr->cause);
+    free(this_ptr->end);
+    free(this_ptr->ready_at);
+    free(this_ptr->released);
+    free(this_ptr->remaining);
+}
+
+/*!
+ * Checks if a node is done as soon as it is ready, the targets don't execute
+ * anything and the skipped tasks are never started.
+ */
+static bool simulator_is_instant(simulator_t *this_ptr, unsigned int node)
+{
+    task_t *task = this_ptr->nodes[node];
+
+    return task_is_target(task) ||
+           (task_get_state(task) == TASK_STATE_SKIPPED);
+}
+
+/*!
+ * Finishes a node at the current time and releases the nodes that have been
+ * waiting for it. A released task is added to the batch, while a released
+ * target is finished directly and releases its own dependents in turn. A
+ * target which only needs any of its dependencies is released by the first
+ * of them.
+ *
+ * \param this_ptr - A pointer to the simulator.
+ * \param node - The node which has finished, it must have been released.
+ */
+static void simulator_finish(simulator_t *this_ptr, unsigned int node)
+{
+    task_graph_t *graph = this_ptr->graph;
+    unsigned int stack_size = 0u;
+    unsigned int dependent;
+    unsigned int edge;
+    unsigned int i;
+
+    this_ptr->stack[stack_size] = node;
+    stack_size++;
+
+    while (stack_size > 0u) {
+        stack_size--;
+        node = this_ptr->stack[stack_size];
+        this_ptr->end[node] = this_ptr->now;
+        this_ptr->finished++;
+
+        for (i = this_ptr->first[node]; i < this_ptr->first[node + 1u];
+             i++) {
+            edge = this_ptr->index[i];
+            dependent = graph->from[edge];
+            if (task_graph_is_removed(graph, edge) ||
+                this_ptr->released[dependent]) {
+                continue;
+            }
+            this_ptr->remaining[dependent]--;
+            if ((this_ptr->remaining[dependent] > 0u) &&
+                !this_ptr->nodes[dependent]->any) {
+                continue;
+            }
+
+            this_ptr->released[dependent] = true;
+            this_ptr->ready_at[dependent] = this_ptr->now;
+            this_ptr->cause[dependent] = node;
+            if (simulator_is_instant(this_ptr, dependent)) {
+                this_ptr->stack[stack_size] = dependent;
+                stack_size++;
+            } else {
+                this_ptr->batch[this_ptr->batch_size] =
+                    this_ptr->nodes[dependent];
+                this_ptr->batch_size++;
+            }
+        }
+    }
+}
+
+/*!
+ * Admits the batch of released tasks in the same way as
+ * \c task_handler_run_finish, the admitted tasks are queued for a worker and
+ * the others are kept pending in order.
+ *
+ * \param this_ptr - A pointer to the simulator.
+ * \param task - The task which has finished, \c NULL at the start.
+ */
+static void simulator_admit(simulator_t *this_ptr, task_t *task)
+{
+    task_handler_t *handler = this_ptr->handler;
+    unsigned int pending_size = this_ptr->pending_size;
+    unsigned int kept_size = 0u;
+    unsigned int p = 0u;
+    unsigned int i = 0u;
+    task_t **kept = this_ptr->kept;
+    unsigned int slot;
+    bool from_pending;
+    task_t *next;
+
+    if ((this_ptr->policy == SIMULATOR_PRIORITY) &&
+        (this_ptr->batch_size > 1u)) {
+        qsort(this_ptr->batch, this_ptr->batch_size, sizeof(task_t*),
+              task_handler_compare_priority);
+    }
+
+    if (handler->admission_control && (task != NULL)) {
+        task_handler_release(handler, task);
+    }
+
+    while ((p < pending_size) || (i < this_ptr->batch_size)) {
+        if (this_ptr->policy == SIMULATOR_PRIORITY) {
+            from_pending = (p < pending_size) &&
+                           ((i == this_ptr->batch_size) ||
+                            (this_ptr->batch[i]->priority <=
+                             this_ptr->pending[p]->priority));
+        } else {
+            from_pending = (p < pending_size);
+        }
+        if (from_pending) {
+            next = this_ptr->pending[p];
+            p++;
+        } else {
+            next = this_ptr->batch[i];
+            i++;
+        }
+
+        if (!handler->admission_control ||
+            task_handler_admit(handler, next)) {
+            slot = (this_ptr->queue_first + this_ptr->queue_size) %
+                   (this_ptr->graph->nodes_size + 1u);
+            this_ptr->queue[slot] = next;
+            this_ptr->queue_size++;
+        } else {
+            kept[kept_size] = next;
+            kept_size++;
+        }
+    }
+
+    this_ptr->kept = this_ptr->pending;
+    this_ptr->pending = kept;
+    this_ptr->pending_size = kept_size;
+    this_ptr->batch_size = 0u;
+}
+
+/*!
+ * Starts the queued tasks on the idle workers in the order that they were
+ * admitted. A task which had to wait for a worker or for the admission after
+ * it became ready was started by the end of the task that freed the worker.
+ *
+ * \param this_ptr - A pointer to the simulator.
+ * \param cause - The node which has just finished, \c TASK_GRAPH_NONE at the
+ *                start.
+ */
+static void simulator_dispatch(simulator_t *this_ptr, unsigned int cause)
+{
+    unsigned int node;
+    task_t *task;
+
+    while ((this_ptr->running_size < this_ptr->threads) &&
+           (this_ptr->queue_size > 0u)) {
+        task = this_ptr->queue[this_ptr->queue_first];
+        this_ptr->queue_first = (this_ptr->queue_first + 1u) %
+                                (this_ptr->graph->nodes_size + 1u);
+        this_ptr->queue_size--;
+
+        node = task->index;
+        if (this_ptr->ready_at[node] < this_ptr->now) {
+            this_ptr->cause[node] = cause;
+        }
+        this_ptr->end[node] = this_ptr->now + task->cost;
+        this_ptr->busy += task->cost;
+        this_ptr->running[this_ptr->running_size] = task;
+        this_ptr->running_size++;
+    }
+}
+
+/*!
+ * Walks back from the node that finished last through the nodes that
+ * started each other, this is the chain of tasks that decided the makespan.
+ *
+ * \return \c SIMULATOR_SUCCESS if the chain was stored, \c SIMULATOR_FAIL
+ *         otherwise.
+ */
+static int simulator_get_chain(simulator_t *this_ptr,
+                               simulator_result_t *result)
+{
+    unsigned int last = TASK_GRAPH_NONE;
+    unsigned int size = 0u;
+    unsigned int node;
+    unsigned int i;
+
+    for (i = 0u; i < this_ptr->graph->nodes_size; i++) {
+        if (this_ptr->released[i] && !simulator_is_instant(this_ptr, i) &&
+            ((last == TASK_GRAPH_NONE) ||
+             (this_ptr->end[i] >= this_ptr->end[last]))) {
+            last = i;
+        }
+    }
+    if (last == TASK_GRAPH_NONE) {
+        return SIMULATOR_SUCCESS;
+    }
+
+    for (node = last; node != TASK_GRAPH_NONE; node = this_ptr->cause[node]) {
+        size++;
+    }
+    result->chain = malloc(sizeof(unsigned int) * size);
+    if (result->chain == NULL) {
+        return SIMULATOR_FAIL;
+    }
+    result->chain_size = size;
+    for (node = last; node != TASK_GRAPH_NONE; node = this_ptr->cause[node]) {
+        size--;
+        result->chain[size] = node;
+    }
+    return SIMULATOR_SUCCESS;
+}
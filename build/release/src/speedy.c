@@ -0,0 +1,475 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "task_handler.h"
+#include "analysis.h"
+#include "core_type.h"
+#include "simulator.h"
+#include "stats.h"
+#include "observer.h"
+#include "queue.h"
+#include "subject.h"
+#include "timer_wheel.h"
+#include "process.h"
+#include "task.h"
+#include "task_parser.h"
+#include "thread_pool.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*! The configuration file that is used if none is given. */
+#define SPEEDY_DEFAULT_CONFIG "config/speedy.conf"
+/*! The option which selects the targets to start. */
+#define SPEEDY_TARGET_OPTION "--target="
+/*! The option which queries the dependencies of a task. */
+#define SPEEDY_QUERY_OPTION "--query="
+/*! The option which reports where the time of the boot went. */
+#define SPEEDY_ANALYZE_OPTION "--analyze"
+/*! The option which writes a trace of the boot. */
+#define SPEEDY_TRACE_OPTION "--trace="
+/*! The option which writes the scheduler statistics. */
+#define SPEEDY_STATS_OPTION "--stats="
+/*! The option which predicts the boot instead of starting it. */
+#define SPEEDY_SIMULATE_OPTION "--simulate"
+/*! The numbers of worker threads that are simulated if none are given. */
+#define SPEEDY_SIMULATE_THREADS "1,2,4,8,16"
+/*! The command which stops the running services. */
+#define SPEEDY_STOP_COMMAND "stop"
+
+/*!
+ * Adds a comma separated list of targets.
+ *
+ * \param task_parser - A pointer to the task parser.
+ * \param targets - The targets, for example "httpd,samba".
+ */
+static void speedy_add_targets(task_parser_t *task_parser, const char *targets)
+{
+    char *list = strdup(targets);
+    char *saveptr;
+    char *target;
+
+    if (list == NULL) {
+        return;
+    }
+
+    target = strtok_r(list, ",", &saveptr);
+    while (target != NULL) {
+        task_parser_add_target(task_parser, target);
+        target = strtok_r(NULL, ",", &saveptr);
+    }
+    free(list);
+}
+
+/*!
+ * Prints a \c NULL terminated list of tasks and frees it.
+ */
+static void speedy_print_tasks(const char *title, const char *name,
+                               task_t **tasks)
+{
+    task_t **task = tasks;
+
+    printf("%s %s:", title, name);
+    while ((task != NULL) && (*task != NULL)) {
+        printf(" %s", (*task)->service->name);
+        task++;
+    }
+    printf("\n");
+    free(tasks);
+}
+
+/*!
+ * Prints all the tasks that a task depends on and all the tasks that depend
+ * on it, directly or through other tasks.
+ *
+ * \param task_handler - A pointer to the task handler.
+ * \param name - The name of the task.
+ */
+static void speedy_query(task_handler_t *task_handler, const char *name)
+{
+    task_t **dependencies = task_handler_get_dependencies(task_handler, name);
+
+    if (dependencies == NULL) {
+        printf("Unknown task: %s\n", name);
+        return;
+    }
+    speedy_print_tasks("Dependencies of", name, dependencies);
+    speedy_print_tasks("Dependents of", name,
+                       task_handler_get_dependents(task_handler, name));
+}
+
+/*!
+ * Prints the critical chain of a simulated boot.
+ */
+static void speedy_print_chain(task_handler_t *task_handler,
+                               simulator_result_t *result)
+{
+    task_t *task;
+    unsigned int i;
+
+    printf("Critical chain with %u threads:", result->threads);
+    for (i = 0u; i < result->chain_size; i++) {
+        task = task_handler->nodes[result->chain[i]];
+        printf("%s %s (%lu ms)", (i == 0u) ? "" : " ->",
+               task->service->name, task->cost);
+    }
+    printf("\n");
+}
+
+/*!
+ * Simulates the boot with each number of worker threads, both with the
+ * priority order of the task handler and in the order that the tasks become
+ * ready, and prints the predicted makespans.
+ *
+ * \param task_handler - A pointer to the task handler, the dependencies must
+ *                       have been calculated.
+ * \param threads - A comma separated list of thread counts, e.g. "1,2,4".
+ *
+ * \return \c EXIT_SUCCESS if the boot could be simulated,
+ *         \c EXIT_FAILURE otherwise.
+ */
+static int speedy_simulate(task_handler_t *task_handler, const char *threads)
+{
+    static const char *policy_names[] = {"priority", "fifo"};
+    simulator_result_t results[2];
+    char *list = strdup(threads);
+    unsigned long busy;
+    unsigned long count;
+    char *saveptr;
+    char *token;
+    char *end;
+    int status = EXIT_SUCCESS;
+    int policy;
+
+    if ((list == NULL) || (task_handler->graph == NULL)) {
+        free(list);
+        return EXIT_FAILURE;
+    }
+
+    printf("%8s %-9s %12s %12s\n", "Threads", "Policy", "Makespan",
+           "Utilization");
+    token = strtok_r(list, ",", &saveptr);
+    while (token != NULL) {
+        count = strtoul(token, &end, 10);
+        if ((*end != '\0') || (count == 0u) || (count > UINT_MAX)) {
+            printf("Invalid number of threads: %s\n", token);
+            status = EXIT_FAILURE;
+            break;
+        }
+
+        for (policy = SIMULATOR_PRIORITY; policy <= SIMULATOR_FIFO;
+             policy++) {
+            if (simulator_run(task_handler, (unsigned int) count,
+                              (simulator_policy_t) policy,
+                              &results[policy]) != SIMULATOR_SUCCESS) {
+                status = EXIT_FAILURE;
+            }
+            busy = (results[policy].makespan > 0u) ?
+                   (100u * results[policy].busy) /
+                   (count * results[policy].makespan) : 0u;
+            printf("%8lu %-9s %9lu ms %10lu %%\n", count,
+                   policy_names[policy], results[policy].makespan, busy);
+        }
+        speedy_print_chain(task_handler, &results[SIMULATOR_PRIORITY]);
+        simulator_result_deinit(&results[SIMULATOR_PRIORITY]);
+        simulator_result_deinit(&results[SIMULATOR_FIFO]);
+
+        token = strtok_r(NULL, ",", &saveptr);
+    }
+
+    free(list);
+    return status;
+}
+
+/*!
+ * Prints a time in microseconds as milliseconds.
+ */
+static void speedy_print_time(unsigned long time)
+{
+    printf(" %9lu.%03lu ms", time / 1000u, time % 1000u);
+}
+
+/*!
+ * Prints two numbers of a resource as one column, like "12/3".
+ */
+static void speedy_print_pair(long first, long second)
+{
+    char pair[32];
+
+    snprintf(pair, sizeof(pair), "%ld/%ld", first, second);
+    printf(" %16s", pair);
+}
+
+/*!
+ * Prints the resources that the commands on the critical chain used next to
+ * the time they ran. A command with much CPU time compared to the time it
+ * ran is CPU bound, and many major faults or block operations point at I/O,
+ * while a command that used neither was waiting for something.
+ *
+ * \param task_handler - A pointer to the task handler.
+ * \param analysis - The analysis of the boot.
+ */
+static void speedy_analyze_usage(task_handler_t *task_handler,
+                                 analysis_t *analysis)
+{
+    process_usage_t *usage;
+    task_t *task;
+    unsigned int i;
+
+    printf("Resources of the commands on the chain:\n");
+    printf("%-20s %16s %16s %16s %16s %10s %16s %16s %16s\n", "Task",
+           "Running", "Spawn", "User", "System", "RSS (kB)",
+           "Faults maj/min", "Switches vol/inv", "Blocks in/out");
+    for (i = 0u; i < analysis->chain_size; i++) {
+        task = task_handler->nodes[analysis->chain[i]];
+        if (!task->reaped) {
+            continue;
+        }
+        usage = &task->usage;
+        printf("%-20s", task->service->name);
+        speedy_print_time(task->end_time - task->start_time);
+        speedy_print_time(usage->spawn_time);
+        speedy_print_time(usage->user_time);
+        speedy_print_time(usage->system_time);
+        printf(" %10ld", usage->max_rss);
+        speedy_print_pair(usage->major_faults, usage->minor_faults);
+        speedy_print_pair(usage->voluntary_switches,
+                          usage->involuntary_switches);
+        speedy_print_pair(usage->block_input, usage->block_output);
+        printf("\n");
+    }
+}
+
+/*!
+ * Prints the chain of tasks that decided the boot time. For each task, the
+ * time until its dependencies were done, the time it waited for the
+ * admission and for a worker and the time it ran are printed, followed by
+ * the resources that the commands used. The tasks that were admitted but
+ * had to wait for a worker are listed after the chain, they are a sign that
+ * there were too few threads.
+ *
+ * \param task_handler - A pointer to the task handler, all the tasks must
+ *                       have finished.
+ */
+static void speedy_analyze(task_handler_t *task_handler)
+{
+    analysis_t analysis;
+    task_t *task;
+    unsigned int i;
+
+    if (analysis_run(task_handler, &analysis) != ANALYSIS_SUCCESS) {
+        printf("Could not analyze the boot\n");
+        return;
+    }
+
+    printf("Critical chain of %lu.%03lu ms:\n", analysis.wall / 1000u,
+           analysis.wall % 1000u);
+    printf("%-20s %16s %16s %16s %16s\n", "Task", "Dependencies",
+           "Admission", "Worker", "Running");
+    for (i = 0u; i < analysis.chain_size; i++) {
+        task = task_handler->nodes[analysis.chain[i]];
+        printf("%-20s", task->service->name);
+        if (task_is_target(task)) {
+            speedy_print_time(task->end_time);
+            printf(" %16s\n", "target");
+            continue;
+        }
+        speedy_print_time(task->ready_time);
+        speedy_print_time(task->admit_time - task->ready_time);
+        speedy_print_time(task->start_time - task->admit_time);
+        speedy_print_time(task->end_time - task->start_time);
+        printf("\n");
+    }
+    speedy_analyze_usage(task_handler, &analysis);
+
+    for (i = 0u; i < analysis.starved_size; i++) {
+        task = task_handler->nodes[analysis.starved[i]];
+        printf("%s waited for a worker for %lu.%03lu ms\n",
+               task->service->name,
+               (task->start_time - task->admit_time) / 1000u,
+               (task->start_time - task->admit_time) % 1000u);
+    }
+    analysis_deinit(&analysis);
+}
+
+/*!
+ * The main function for Speedy.
+ *
+ * Usage: speedy [stop] [--target=NAME[,NAME...]]... [--query=NAME]...
+ *               [--simulate[=THREADS[,THREADS...]]] [--trace=FILE]
+ *               [--analyze] [--stats=FILE] [CONFIG]
+ *
+ * When targets are given, only the targets and the tasks that they require
+ * or want are read and started instead of all the tasks in the
+ * configuration. When a query is given, nothing is started. The tasks that
+ * the queried task depends on and the tasks that depend on it are printed
+ * instead. The stop command stops the running services of the configuration
+ * in reverse dependency order. The simulate option predicts the boot with
+ * the estimated durations of the tasks for a number of worker threads
+ * instead of starting it, the sockets of the tasks are assumed to open like
+ * in a real boot. The trace option writes every state transition of
+ * the tasks as a Chrome trace, which can be opened in Perfetto. The analyze
+ * option prints the chain of tasks that decided the boot time when all the
+ * tasks have finished. The stats option writes counters and histograms of
+ * the thread pool and the lock contention as JSON when speedy exits and
+ * when it receives SIGUSR1.
+ *
+ * \param argc - Number of parameters from the command line.
+ * \param argv - Array of parameters from the command line.
+ *
+ * \return success
+ */
+int main(int argc, char *argv[])
+{
+    const char *config = SPEEDY_DEFAULT_CONFIG;
+    task_handler_t *task_handler;
+    task_parser_t *task_parser;
+    thread_pool_t *thread_pool;
+    const char *simulate = NULL;
+    bool analyze = false;
+    bool query = false;
+    bool stop = false;
+    long threads;
+    int status = EXIT_SUCCESS;
+    int first = 1;
+    int i;
+
+    if ((argc > 1) && (strcmp(argv[1], SPEEDY_STOP_COMMAND) == 0)) {
+        stop = true;
+        first = 2;
+    }
+
+    for (i = first; i < argc; i++) {
+        if (strncmp(argv[i], SPEEDY_QUERY_OPTION,
+                    strlen(SPEEDY_QUERY_OPTION)) == 0) {
+            query = true;
+        } else if (strcmp(argv[i], SPEEDY_ANALYZE_OPTION) == 0) {
+            analyze = true;
+        } else if (strcmp(argv[i], SPEEDY_SIMULATE_OPTION) == 0) {
+            simulate = SPEEDY_SIMULATE_THREADS;
+        } else if (strncmp(argv[i], SPEEDY_SIMULATE_OPTION "=",
+                           strlen(SPEEDY_SIMULATE_OPTION "=")) == 0) {
+            simulate = argv[i] + strlen(SPEEDY_SIMULATE_OPTION "=");
+        } else if ((strncmp(argv[i], SPEEDY_TARGET_OPTION,
+                            strlen(SPEEDY_TARGET_OPTION)) != 0) &&
+                   (strncmp(argv[i], SPEEDY_TRACE_OPTION,
+                            strlen(SPEEDY_TRACE_OPTION)) != 0) &&
+                   (strncmp(argv[i], SPEEDY_STATS_OPTION,
+                            strlen(SPEEDY_STATS_OPTION)) != 0)) {
+            config = argv[i];
+        }
+    }
+
+    /* The statistics have to be started before any threads exist, the
+       threads read the flag that enables them without locking. */
+    for (i = first; i < argc; i++) {
+        if ((strncmp(argv[i], SPEEDY_STATS_OPTION,
+                     strlen(SPEEDY_STATS_OPTION)) == 0) &&
+            (stats_enable(argv[i] + strlen(SPEEDY_STATS_OPTION)) !=
+             STATS_SUCCESS)) {
+            printf("Could not start the statistics\n");
+        }
+    }
+
+    /* The threads are created once and are shared between the parser and
+       the task handler. */
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    thread_pool = thread_pool_create((unsigned int) threads);
+    if (thread_pool == NULL) {
+        stats_finish();
+        return EXIT_FAILURE;
+    }
+
+    task_handler = task_handler_create(thread_pool);
+    task_parser = task_parser_create(task_handler, thread_pool);
+
+    if ((task_handler == NULL) || (task_parser == NULL)) {
+        if (task_parser != NULL) {
+            task_parser_destroy(task_parser);
+        }
+        if (task_handler != NULL) {
+            task_handler_destroy(task_handler);
+        }
+        thread_pool_destroy(thread_pool);
+        stats_finish();
+        return EXIT_FAILURE;
+    }
+
+    for (i = first; i < argc; i++) {
+        if (strncmp(argv[i], SPEEDY_TARGET_OPTION,
+                    strlen(SPEEDY_TARGET_OPTION)) == 0) {
+            speedy_add_targets(task_parser,
+                               argv[i] + strlen(SPEEDY_TARGET_OPTION));
+        } else if ((strncmp(argv[i], SPEEDY_TRACE_OPTION,
+                            strlen(SPEEDY_TRACE_OPTION)) == 0) &&
+                   (task_handler_set_trace(task_handler,
+                        argv[i] + strlen(SPEEDY_TRACE_OPTION)) !=
+                    TASK_HANDLER_SUCCESS)) {
+            printf("Could not start the trace\n");
+        }
+    }
+
+    /* Read which tasks that need to be executed and all the dependency
+       information from the configuration. */
+    task_parser_read(task_parser, config);
+    task_parser_wait(task_parser);
+
+    /* Read the dependency from the configuration. */
+    task_handler_set_dry_run(task_handler,
+                             query || stop || (simulate != NULL));
+    task_handler_set_simulate(task_handler, simulate != NULL);
+    task_handler_calculate_dependency(task_handler);
+
+    if (query) {
+        for (i = first; i < argc; i++) {
+            if (strncmp(argv[i], SPEEDY_QUERY_OPTION,
+                        strlen(SPEEDY_QUERY_OPTION)) == 0) {
+                speedy_query(task_handler,
+                             argv[i] + strlen(SPEEDY_QUERY_OPTION));
+            }
+        }
+    } else if (simulate != NULL) {
+        status = speedy_simulate(task_handler, simulate);
+    } else if (stop) {
+        if (task_handler_stop(task_handler) != TASK_HANDLER_SUCCESS) {
+            status = EXIT_FAILURE;
+        }
+    } else {
+        task_handler_wait(task_handler);
+        task_handler_report(task_handler);
+        if (analyze) {
+            speedy_analyze(task_handler);
+        }
+
+        /* The services which keep running after they are ready are
+           supervised until they exit. */
+        task_handler_supervise(task_handler);
+    }
+
+    task_parser_destroy(task_parser);
+    task_handler_destroy(task_handler);
+    thread_pool_destroy(thread_pool);
+    stats_finish();
+    return status;
+}
@@ -0,0 +1,438 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/* Needed for pipe2. */
+#define _GNU_SOURCE
+
+#include "stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*! The byte which tells the writer thread to write the statistics. */
+#define STATS_WAKE_WRITE 'w'
+/*! The byte which tells the writer thread to exit. */
+#define STATS_WAKE_EXIT 'x'
+
+/*! The names of the counters in the written statistics. */
+static const char *priv_stats_counter_names[STATS_COUNTERS] = {
+    "wakeups", "useful_wakeups", "worker_busy_us", "worker_idle_us"
+};
+
+/*! The names of the histograms in the written statistics. */
+static const char *priv_stats_histogram_names[STATS_HISTOGRAMS] = {
+    "queue_depth", "ready_to_dispatch_us", "thread_pool_mutex_wait_us",
+    "thread_pool_mutex_hold_us", "task_parser_mutex_wait_us",
+    "task_parser_mutex_hold_us", "observer_mutex_wait_us",
+    "observer_mutex_hold_us"
+};
+
+/*! The statistics of the process, there is only one set since they are
+ *  written from a signal. */
+static stats_t priv_stats;
+
+static void stats_signal(int signal_number);
+static void *stats_thread(void *arg);
+static void stats_write_histogram(FILE *file, stats_histogram_t *histogram);
+
+/*!
+ * Starts to collect the statistics, they are written when the process
+ * receives SIGUSR1 and when \c stats_finish is called. It must be called
+ * before any other thread is started.
+ *
+ * \param path - The file where the statistics are written.
+ *
+ * \return \c STATS_SUCCESS if the statistics were started, \c STATS_FAIL
+ *         otherwise.
+ */
+int stats_enable(const char *path)
+{
+    struct sigaction action;
+
+    if (priv_stats.enabled) {
+        return STATS_FAIL;
+    }
+
+    memset(&priv_stats, 0, sizeof(stats_t));
+    priv_stats.path = strdup(path);
+    if (priv_stats.path == NULL) {
+        return STATS_FAIL;
+    }
+    if (pipe2(priv_stats.wake, O_CLOEXEC) != 0) {
+        free(priv_stats.path);
+        return STATS_FAIL;
+    }
+    if (pthread_create(&priv_stats.thread, NULL, stats_thread, NULL) != 0) {
+        close(priv_stats.wake[0]);
+        close(priv_stats.wake[1]);
+        free(priv_stats.path);
+        return STATS_FAIL;
+    }
+    pthread_mutex_init(&priv_stats.mutex, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &priv_stats.start);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stats_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, NULL);
+
+    priv_stats.enabled = true;
+    return STATS_SUCCESS;
+}
+
+/*!
+ * Checks if the statistics are collected.
+ *
+ * \return \c true if the statistics have been enabled.
+ */
+bool stats_is_enabled(void)
+{
+    return priv_stats.enabled;
+}
+
+/*!
+ * Writes the statistics a last time and stops collecting them. No other
+ * thread may use the statistics anymore.
+ */
+void stats_finish(void)
+{
+    char wake = STATS_WAKE_EXIT;
+
+    if (!priv_stats.enabled) {
+        return;
+    }
+
+    signal(SIGUSR1, SIG_DFL);
+    while ((write(priv_stats.wake[1], &wake, 1) < 0) && (errno == EINTR)) {
+        /* Retry. */
+    }
+    pthread_join(priv_stats.thread, NULL);
+    close(priv_stats.wake[0]);
+    close(priv_stats.wake[1]);
+
+    if (stats_write(priv_stats.path) != STATS_SUCCESS) {
+        printf("Could not write the statistics %s\n", priv_stats.path);
+    }
+    priv_stats.enabled = false;
+    pthread_mutex_destroy(&priv_stats.mutex);
+    free(priv_stats.path);
+    priv_stats.path = NULL;
+}
+
+/*!
+ * Gets the time since the statistics were started.
+ *
+ * \return The time in microseconds, 0 if the statistics aren't collected.
+ */
+unsigned long stats_now(void)
+{
+    struct timespec now;
+    long elapsed;
+
+    if (!priv_stats.enabled) {
+        return 0u;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (long) (now.tv_sec - priv_stats.start.tv_sec) * 1000000L +
+              (now.tv_nsec - priv_stats.start.tv_nsec) / 1000L;
+    return (elapsed > 0) ? (unsigned long) elapsed : 0u;
+}
+
+/*!
+ * Adds a value to a counter.
+ *
+ * \param counter - The counter.
+ * \param value - The value to add.
+ */
+void stats_add(stats_counter_t counter, unsigned long value)
+{
+    if (priv_stats.enabled) {
+        __atomic_add_fetch(&priv_stats.counters[counter], value,
+                           __ATOMIC_RELAXED);
+    }
+}
+
+/*!
+ * Adds a value to a histogram.
+ *
+ * \param histogram - The histogram.
+ * \param value - The value.
+ */
+void stats_sample(stats_histogram_id_t histogram, unsigned long value)
+{
+    stats_histogram_t *this_ptr = &priv_stats.histograms[histogram];
+    unsigned long max;
+    unsigned long bits = value;
+    unsigned int bucket = 0u;
+
+    if (!priv_stats.enabled) {
+        return;
+    }
+
+    while ((bits > 0u) && (bucket < STATS_BUCKETS - 1u)) {
+        bits >>= 1;
+        bucket++;
+    }
+    __atomic_add_fetch(&this_ptr->buckets[bucket], 1u, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&this_ptr->count, 1u, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&this_ptr->sum, value, __ATOMIC_RELAXED);
+
+    max = __atomic_load_n(&this_ptr->max, __ATOMIC_RELAXED);
+    while ((value > max) &&
+           !__atomic_compare_exchange_n(&this_ptr->max, &max, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        /* The maximum has changed, try again. */
+    }
+}
+
+/*!
+ * Samples the depth of the ready queue. The depth is added to the histogram
+ * and to the series, where a later sample in the same millisecond replaces
+ * the earlier one.
+ *
+ * \param depth - The number of queued tasks.
+ */
+void stats_sample_depth(unsigned long depth)
+{
+    stats_sample_t *last = NULL;
+    unsigned long now;
+
+    if (!priv_stats.enabled) {
+        return;
+    }
+    stats_sample(STATS_QUEUE_DEPTH, depth);
+
+    now = stats_now();
+    pthread_mutex_lock(&priv_stats.mutex);
+    if (priv_stats.series_size > 0u) {
+        last = &priv_stats.series[priv_stats.series_size - 1u];
+    }
+    if ((last != NULL) && (last->time / 1000u == now / 1000u)) {
+        last->value = depth;
+    } else if (priv_stats.series_size < STATS_SERIES_SIZE) {
+        priv_stats.series[priv_stats.series_size].time = now;
+        priv_stats.series[priv_stats.series_size].value = depth;
+        priv_stats.series_size++;
+    }
+    pthread_mutex_unlock(&priv_stats.mutex);
+}
+
+/*!
+ * Locks a mutex and records how long it was waited for.
+ *
+ * \param lock - The mutex that is timed.
+ * \param mutex - A pointer to the mutex.
+ *
+ * \return The time when the mutex was locked, it is passed to
+ *         \c stats_unlock.
+ */
+unsigned long stats_lock(stats_lock_t lock, pthread_mutex_t *mutex)
+{
+    unsigned long start;
+    unsigned long locked;
+
+    if (!priv_stats.enabled) {
+        pthread_mutex_lock(mutex);
+        return 0u;
+    }
+
+    start = stats_now();
+    pthread_mutex_lock(mutex);
+    locked = stats_now();
+    stats_sample((stats_histogram_id_t) (STATS_THREAD_POOL_WAIT + 2 * lock),
+                 locked - start);
+    return locked;
+}
+
+/*!
+ * Unlocks a mutex and records how long it was held.
+ *
+ * \param lock - The mutex that is timed.
+ * \param mutex - A pointer to the mutex.
+ * \param locked - The time from \c stats_lock.
+ */
+void stats_unlock(stats_lock_t lock, pthread_mutex_t *mutex,
+                  unsigned long locked)
+{
+    if (priv_stats.enabled) {
+        stats_sample((stats_histogram_id_t) (STATS_THREAD_POOL_HOLD +
+                                             2 * lock),
+                     stats_now() - locked);
+    }
+    pthread_mutex_unlock(mutex);
+}
+
+/*!
+ * Waits for a condition with a timed mutex. The mutex isn't held while the
+ * condition is waited for.
+ *
+ * \param lock - The mutex that is timed.
+ * \param condition - A pointer to the condition.
+ * \param mutex - A pointer to the locked mutex.
+ * \param locked - The time from \c stats_lock, it is set to the time when
+ *                 the mutex was locked again.
+ */
+void stats_cond_wait(stats_lock_t lock, pthread_cond_t *condition,
+                     pthread_mutex_t *mutex, unsigned long *locked)
+{
+    if (priv_stats.enabled) {
+        stats_sample((stats_histogram_id_t) (STATS_THREAD_POOL_HOLD +
+                                             2 * lock),
+                     stats_now() - *locked);
+    }
+    pthread_cond_wait(condition, mutex);
+    *locked = stats_now();
+}
+
+/*!
+ * Writes the statistics as JSON. The file is replaced when it has been
+ * written, so a reader never sees a partly written file.
+ *
+ * \param path - The file where the statistics are written.
+ *
+ * \return \c STATS_SUCCESS if the statistics were written, \c STATS_FAIL
+ *         otherwise.
+ */
+int stats_write(const char *path)
+{
+    size_t size = strlen(path) + sizeof(".tmp");
+    char *temporary = malloc(size);
+    unsigned int series_size;
+    unsigned int i;
+    FILE *file;
+    int status = STATS_SUCCESS;
+
+    if (temporary == NULL) {
+        return STATS_FAIL;
+    }
+    snprintf(temporary, size, "%s.tmp", path);
+    file = fopen(temporary, "w");
+    if (file == NULL) {
+        free(temporary);
+        return STATS_FAIL;
+    }
+
+    fprintf(file, "{\n  \"uptime_us\": %lu,\n  \"counters\": {", stats_now());
+    for (i = 0u; i < STATS_COUNTERS; i++) {
+        fprintf(file, "%s\n    \"%s\": %lu", (i == 0u) ? "" : ",",
+                priv_stats_counter_names[i],
+                __atomic_load_n(&priv_stats.counters[i], __ATOMIC_RELAXED));
+    }
+    fprintf(file, "\n  },\n  \"histograms\": {");
+    for (i = 0u; i < STATS_HISTOGRAMS; i++) {
+        fprintf(file, "%s\n    \"%s\": ", (i == 0u) ? "" : ",",
+                priv_stats_histogram_names[i]);
+        stats_write_histogram(file, &priv_stats.histograms[i]);
+    }
+
+    fprintf(file, "\n  },\n  \"queue_depth_series\": [");
+    pthread_mutex_lock(&priv_stats.mutex);
+    series_size = priv_stats.series_size;
+    for (i = 0u; i < series_size; i++) {
+        fprintf(file, "%s[%lu, %lu]", (i == 0u) ? "" : ", ",
+                priv_stats.series[i].time, priv_stats.series[i].value);
+    }
+    pthread_mutex_unlock(&priv_stats.mutex);
+    fprintf(file, "]\n}\n");
+
+    if (ferror(file)) {
+        status = STATS_FAIL;
+    }
+    if (fclose(file) != 0) {
+        status = STATS_FAIL;
+    }
+    if ((status == STATS_SUCCESS) && (rename(temporary, path) != 0)) {
+        status = STATS_FAIL;
+    }
+    if (status != STATS_SUCCESS) {
+        unlink(temporary);
+    }
+    free(temporary);
+    return status;
+}
+
+/*!
+ * Tells the writer thread to write the statistics, only async-signal-safe
+ * functions may be called here.
+ */
+static void stats_signal(int signal_number)
+{
+    char wake = STATS_WAKE_WRITE;
+    int saved_errno = errno;
+    ssize_t size;
+
+    (void) signal_number;
+    size = write(priv_stats.wake[1], &wake, 1);
+    (void) size;
+    errno = saved_errno;
+}
+
+/*!
+ * Writes the statistics each time the signal handler asks for it, until it
+ * is told to exit.
+ */
+static void *stats_thread(void *arg)
+{
+    ssize_t size;
+    char wake;
+
+    for (;;) {
+        size = read(priv_stats.wake[0], &wake, 1);
+        if ((size < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if ((size <= 0) || (wake == STATS_WAKE_EXIT)) {
+            break;
+        }
+        if (stats_write(priv_stats.path) != STATS_SUCCESS) {
+            printf("Could not write the statistics %s\n", priv_stats.path);
+        }
+    }
+    return arg;
+}
+
+/*!
+ * Writes a histogram with the upper bound and the count of each bucket that
+ * isn't empty, the upper bound of the last bucket is the largest value.
+ */
+static void stats_write_histogram(FILE *file, stats_histogram_t *histogram)
+{
+    unsigned long max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    unsigned long count;
+    unsigned long bound;
+    bool first = true;
+    unsigned int i;
+
+    fprintf(file, "{\"count\": %lu, \"sum\": %lu, \"max\": %lu, "
+            "\"buckets\": [",
+            __atomic_load_n(&histogram->count, __ATOMIC_RELAXED),
+            __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED), max);
+    for (i = 0u; i < STATS_BUCKETS; i++) {
+        count = __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+        if (count == 0u) {
+            continue;
+        }
+        bound = (i + 1u < STATS_BUCKETS) ? (1ul << i) - 1u : max;
+        fprintf(file, "%s[%lu, %lu]", first ? "" : ", ", bound, count);
+        first = false;
+    }
+    fprintf(file, "]}");
+}
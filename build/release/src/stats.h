@@ -0,0 +1,132 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#ifndef _SPEEDY_STATS_H_
+#define _SPEEDY_STATS_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+/*! The operation was successfully executed. */
+#define STATS_SUCCESS 0
+/*! The statistics couldn't be written or started. */
+#define STATS_FAIL -1
+/*! The number of buckets in a histogram, bucket n counts the values below
+ *  2^n that don't fit in a lower bucket, the last bucket counts the rest. */
+#define STATS_BUCKETS 32u
+/*! The number of samples of the ready queue depth that are kept. */
+#define STATS_SERIES_SIZE 4096u
+
+/*! The counters. */
+typedef enum stats_counter_t {
+    /*! The number of times that a parked thread has been woken up. */
+    STATS_WAKEUPS,
+    /*! The number of wakeups after which the thread found a task. */
+    STATS_USEFUL_WAKEUPS,
+    /*! The time in microseconds that the threads have executed tasks. */
+    STATS_BUSY_TIME,
+    /*! The time in microseconds that the threads have been idle. */
+    STATS_IDLE_TIME,
+    STATS_COUNTERS /*!< The number of counters. */
+} stats_counter_t;
+
+/*! The histograms. */
+typedef enum stats_histogram_id_t {
+    /*! The number of queued tasks in the thread pool when it changes. */
+    STATS_QUEUE_DEPTH,
+    /*! The time in microseconds from when a task is ready until a thread
+     *  picks it up. */
+    STATS_READY_TO_DISPATCH,
+    /*! The time in microseconds that the thread pool mutex is waited for. */
+    STATS_THREAD_POOL_WAIT,
+    /*! The time in microseconds that the thread pool mutex is held. */
+    STATS_THREAD_POOL_HOLD,
+    /*! The time in microseconds that the task parser mutex is waited for. */
+    STATS_TASK_PARSER_WAIT,
+    /*! The time in microseconds that the task parser mutex is held. */
+    STATS_TASK_PARSER_HOLD,
+    /*! The time in microseconds that an observer mutex is waited for. */
+    STATS_OBSERVER_WAIT,
+    /*! The time in microseconds that an observer mutex is held. */
+    STATS_OBSERVER_HOLD,
+    STATS_HISTOGRAMS /*!< The number of histograms. */
+} stats_histogram_id_t;
+
+/*! The mutexes that are timed, each has a wait and a hold histogram. */
+typedef enum stats_lock_t {
+    STATS_LOCK_THREAD_POOL, /*!< \c thread_pool_t::mutex. */
+    STATS_LOCK_TASK_PARSER, /*!< \c task_parser_t::mutex. */
+    STATS_LOCK_OBSERVER /*!< \c observer_t::mutex. */
+} stats_lock_t;
+
+/*!
+ * A distribution of values in buckets of powers of two.
+ */
+typedef struct stats_histogram_t {
+    unsigned long count; /*!< The number of values. */
+    unsigned long sum; /*!< The sum of the values. */
+    unsigned long max; /*!< The largest value. */
+    unsigned long buckets[STATS_BUCKETS]; /*!< The values in each bucket. */
+} stats_histogram_t;
+
+/*!
+ * A sample of the ready queue depth.
+ */
+typedef struct stats_sample_t {
+    unsigned long time; /*!< Microseconds since the statistics started. */
+    unsigned long value; /*!< The number of queued tasks. */
+} stats_sample_t;
+
+/*!
+ * The statistics of the process. They are only collected when they have
+ * been enabled, and all the updates are lock free except for the series of
+ * samples.
+ */
+typedef struct stats_t {
+    bool enabled; /*!< \c true if the statistics are collected. */
+    struct timespec start; /*!< The time when the statistics started. */
+    unsigned long counters[STATS_COUNTERS]; /*!< The counters. */
+    stats_histogram_t histograms[STATS_HISTOGRAMS]; /*!< The histograms. */
+    pthread_mutex_t mutex; /*!< Protects the series. */
+    /*! The depth of the ready queue over time, at most one sample for each
+     *  millisecond. */
+    stats_sample_t series[STATS_SERIES_SIZE];
+    unsigned int series_size; /*!< The number of samples. */
+    char *path; /*!< The file where the statistics are written. */
+    /*! A pipe which tells the writer thread to write the statistics, it is
+     *  written to by the signal handler. */
+    int wake[2];
+    pthread_t thread; /*!< The writer thread. */
+} stats_t;
+
+int stats_enable(const char *path);
+bool stats_is_enabled(void);
+void stats_finish(void);
+
+unsigned long stats_now(void);
+void stats_add(stats_counter_t counter, unsigned long value);
+void stats_sample(stats_histogram_id_t histogram, unsigned long value);
+void stats_sample_depth(unsigned long depth);
+
+unsigned long stats_lock(stats_lock_t lock, pthread_mutex_t *mutex);
+void stats_unlock(stats_lock_t lock, pthread_mutex_t *mutex,
+                  unsigned long locked);
+void stats_cond_wait(stats_lock_t lock, pthread_cond_t *condition,
+                     pthread_mutex_t *mutex, unsigned long *locked);
+
+int stats_write(const char *path);
+
+#endif /* _SPEEDY_STATS_H_ */
@@ -0,0 +1,264 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/* Needed for pipe2. */
+#define _GNU_SOURCE
+
+#include "process.h"
+#include "supervisor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*! How often in milliseconds the processes without a pidfd are polled. */
+#define SUPERVISOR_POLL_INTERVAL 100
+
+static void *supervisor_thread(void *arg);
+static void supervisor_wake(supervisor_t *this_ptr);
+
+/*!
+ * Creates a supervisor.
+ *
+ * \return A pointer to the supervisor or \c NULL if it couldn't be created.
+ */
+supervisor_t *supervisor_create(void)
+{
+    supervisor_t *this_ptr = (supervisor_t*) malloc(sizeof(supervisor_t));
+
+    if (this_ptr != NULL) {
+        if (pipe2(this_ptr->wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+            free(this_ptr);
+            return NULL;
+        }
+        pthread_mutex_init(&this_ptr->mutex, NULL);
+        pthread_cond_init(&this_ptr->condition, NULL);
+        this_ptr->children = NULL;
+        this_ptr->children_size = 0u;
+        this_ptr->started = false;
+        this_ptr->exit = false;
+    }
+    return this_ptr;
+}
+
+/*!
+ * Supervises a process until it exits.
+ *
+ * \param this_ptr - A pointer to the supervisor.
+ * \param pid - The process id, it must be a child process.
+ * \param exited - Called from the supervisor thread when the process has
+ *                 exited.
+ * \param context - The argument to the exited function.
+ *
+ * \return \c SUPERVISOR_SUCCESS if the process is supervised,
+ *         \c SUPERVISOR_FAIL otherwise.
+ */
+int supervisor_add(supervisor_t *this_ptr, pid_t pid,
+                   void (*exited)(void *context, int status), void *context)
+{
+    supervisor_child_t *child = malloc(sizeof(supervisor_child_t));
+    int status = SUPERVISOR_SUCCESS;
+
+    if (child == NULL) {
+        return SUPERVISOR_FAIL;
+    }
+    child->pid = pid;
+    child->pidfd = process_pidfd_open(pid);
+    child->exited = exited;
+    child->context = context;
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    if (!this_ptr->started) {
+        if (pthread_create(&this_ptr->thread, NULL, supervisor_thread,
+                           this_ptr) == 0) {
+            this_ptr->started = true;
+        } else {
+            status = SUPERVISOR_FAIL;
+        }
+    }
+    if (status == SUPERVISOR_SUCCESS) {
+        child->next = this_ptr->children;
+        this_ptr->children = child;
+        this_ptr->children_size++;
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    if (status == SUPERVISOR_SUCCESS) {
+        supervisor_wake(this_ptr);
+    } else {
+        if (child->pidfd >= 0) {
+            close(child->pidfd);
+        }
+        free(child);
+    }
+    return status;
+}
+
+/*!
+ * Waits until all the supervised processes have exited.
+ *
+ * \param this_ptr - A pointer to the supervisor.
+ */
+void supervisor_wait(supervisor_t *this_ptr)
+{
+    pthread_mutex_lock(&this_ptr->mutex);
+    while (this_ptr->children_size > 0u) {
+        pthread_cond_wait(&this_ptr->condition, &this_ptr->mutex);
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Destroys a supervisor. The processes which are still running are no longer
+ * supervised.
+ *
+ * \param this_ptr - A pointer to the supervisor.
+ */
+void supervisor_destroy(supervisor_t *this_ptr)
+{
+    supervisor_child_t *child;
+
+    if (this_ptr == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    this_ptr->exit = true;
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    if (this_ptr->started) {
+        supervisor_wake(this_ptr);
+        pthread_join(this_ptr->thread, NULL);
+    }
+
+    while (this_ptr->children != NULL) {
+        child = this_ptr->children;
+        this_ptr->children = child->next;
+        if (child->pidfd >= 0) {
+            close(child->pidfd);
+        }
+        free(child);
+    }
+    close(this_ptr->wake[0]);
+    close(this_ptr->wake[1]);
+    pthread_cond_destroy(&this_ptr->condition);
+    pthread_mutex_destroy(&this_ptr->mutex);
+    free(this_ptr);
+}
+
+/*!
+ * The supervisor thread, it waits until any of the processes has exited or
+ * until it is woken up because the processes have changed.
+ */
+static void *supervisor_thread(void *arg)
+{
+    supervisor_t *this_ptr = arg;
+    supervisor_child_t **previous;
+    supervisor_child_t *exited = NULL;
+    supervisor_child_t *child;
+    struct pollfd *fds = NULL;
+    unsigned int fds_size;
+    unsigned int size = 0u;
+    int timeout;
+    int status;
+    char buffer[16];
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    while (!this_ptr->exit) {
+        /* Make room for all the processes and the wake up pipe. */
+        if (size < this_ptr->children_size + 1u) {
+            size = this_ptr->children_size + 1u;
+            free(fds);
+            fds = malloc(sizeof(struct pollfd) * size);
+            if (fds == NULL) {
+                size = 0u;
+                break;
+            }
+        }
+
+        fds[0].fd = this_ptr->wake[0];
+        fds[0].events = POLLIN;
+        fds_size = 1u;
+        timeout = -1;
+
+        for (child = this_ptr->children; child != NULL; child = child->next) {
+            if (child->pidfd >= 0) {
+                fds[fds_size].fd = child->pidfd;
+                fds[fds_size].events = POLLIN;
+                fds_size++;
+            } else {
+                timeout = SUPERVISOR_POLL_INTERVAL;
+            }
+        }
+        pthread_mutex_unlock(&this_ptr->mutex);
+
+        poll(fds, fds_size, timeout);
+        while (read(this_ptr->wake[0], buffer, sizeof(buffer)) > 0) {
+            /* Empty the wake up pipe. */
+        }
+
+        /* Collect the processes that have exited. Only the supervisor
+           thread removes processes, so the children are still valid. */
+        pthread_mutex_lock(&this_ptr->mutex);
+        previous = &this_ptr->children;
+        while ((child = *previous) != NULL) {
+            if (waitpid(child->pid, &status, WNOHANG) == child->pid) {
+                *previous = child->next;
+                child->status = status;
+                child->next = exited;
+                exited = child;
+                this_ptr->children_size--;
+            } else {
+                previous = &child->next;
+            }
+        }
+        pthread_mutex_unlock(&this_ptr->mutex);
+
+        while (exited != NULL) {
+            child = exited;
+            exited = child->next;
+            child->exited(child->context, child->status);
+            if (child->pidfd >= 0) {
+                close(child->pidfd);
+            }
+            free(child);
+        }
+
+        pthread_mutex_lock(&this_ptr->mutex);
+        if (this_ptr->children_size == 0u) {
+            pthread_cond_broadcast(&this_ptr->condition);
+        }
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    free(fds);
+    return NULL;
+}
+
+/*!
+ * Wakes up the supervisor thread.
+ */
+static void supervisor_wake(supervisor_t *this_ptr)
+{
+    char wake = 1;
+
+    while ((write(this_ptr->wake[1], &wake, 1) < 0) && (errno == EINTR)) {
+        /* Retry. */
+    }
+}
@@ -0,0 +1,71 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_SUPERVISOR_H_
+#define _SPEEDY_SUPERVISOR_H_
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+/*! The operation was successfully executed. */
+#define SUPERVISOR_SUCCESS 0
+/*! General error which mostly likely happens during malloc. */
+#define SUPERVISOR_FAIL -1
+
+/*!
+ * A process which is supervised until it exits.
+ */
+typedef struct supervisor_child_t {
+    pid_t pid; /*!< The process id. */
+    /*! A file descriptor which refers to the process, -1 if the kernel
+     *  doesn't support it and the process has to be polled instead. */
+    int pidfd;
+    /*! The status from \c waitpid when the process has exited. */
+    int status;
+    /*! Called from the supervisor thread when the process has exited. */
+    void (*exited)(void *context, int status);
+    void *context; /*!< The argument to the exited function. */
+    struct supervisor_child_t *next; /*!< The next supervised process. */
+} supervisor_child_t;
+
+/*!
+ * Supervises processes which keep running after they have reported that
+ * they are ready. A single thread waits for all the processes, the thread is
+ * started when the first process is added.
+ */
+typedef struct supervisor_t {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    /*! Signaled when the last process has exited. */
+    pthread_cond_t condition;
+    /*! A pipe which wakes up the supervisor thread. */
+    int wake[2];
+    supervisor_child_t *children; /*!< The supervised processes. */
+    unsigned int children_size; /*!< The number of supervised processes. */
+    bool started; /*!< \c true if the thread has been started. */
+    bool exit; /*!< \c true if the thread should exit. */
+} supervisor_t;
+
+supervisor_t *supervisor_create(void);
+
+int supervisor_add(supervisor_t *this_ptr, pid_t pid,
+                   void (*exited)(void *context, int status), void *context);
+void supervisor_wait(supervisor_t *this_ptr);
+
+void supervisor_destroy(supervisor_t *this_ptr);
+
+#endif /* _SPEEDY_SUPERVISOR_H_ */
@@ -0,0 +1,171 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_TASK_H_
+#define _SPEEDY_TASK_H_
+
+/*! An error code if everything was successfully executed. */
+#define TASK_SUCCESS 0
+#define TASK_FAIL -1
+
+struct service_t;
+struct subject_t;
+struct hash_lookup_t;
+struct task_handler_t;
+struct task_handler_group_t;
+struct task_graph_t;
+
+/*! The strength of a dependency. */
+typedef enum task_dependency_kind_t {
+    /*! The task fails if the dependency is missing or fails. */
+    TASK_DEPENDENCY_REQUIRES,
+    /*! The task waits for the dependency but doesn't care if it is missing
+     *  or fails. */
+    TASK_DEPENDENCY_WANTS,
+    /*! The task is only ordered after the dependency, it doesn't pull in the
+     *  dependency. */
+    TASK_DEPENDENCY_AFTER
+} task_dependency_kind_t;
+
+/*! The states of a task. */
+typedef enum task_state_t {
+    /*! The task is waiting for its dependencies or to be admitted. */
+    TASK_STATE_WAITING,
+    /*! The task has been started but it isn't ready yet. */
+    TASK_STATE_RUNNING,
+    /*! The task has reported that it is ready and it is still running. */
+    TASK_STATE_READY,
+    /*! The task has exited. */
+    TASK_STATE_EXITED,
+    /*! The task was never started since a required dependency is missing
+     *  or has failed. */
+    TASK_STATE_SKIPPED
+} task_state_t;
+
+typedef struct task_t {
+    /*! A C inheritance of the \c struct \c subject_t type which makes
+     * it possible to use a task as both an observer and a subject. The point
+     * of this is to actually be able to track dependencies, more or less to
+     * know when a task can execute. */
+    struct subject_t task;
+    /*! An unique id for the task, this is used for tracking dependecies. */
+    unsigned int task_id;
+    /*! An alternative id for the task, this is also used for tracking
+     * dependencies, especially dependencies that can be provided by different
+     * tasks. */
+    unsigned int provides_id;
+
+    struct queue_t *dependency_queue;
+    /*! A pointer to the service struct which contains function pointers for
+     *  getting the task name, the alternative name of the task, the
+     *  dependencies, the initialization function and the shutdown function.
+     *  This actually gives the task something to do during startup or shutdown
+     *  and it also gives basic knowledge of the dependencies for the task. */
+    service_t *service;
+
+    struct task_handler_t *task_handler;
+
+    /*! The number of dependencies that haven't finished yet. */
+    int counter;
+    /*! The number of tasks that depends on this task. */
+    unsigned int dependents;
+    /*! The concurrency group of the task, \c NULL if the task isn't limited
+     *  by any group. */
+    struct task_handler_group_t *group;
+    /*! The current state of the task. */
+    task_state_t state;
+    /*! \c TASK_SUCCESS if the task was successfully started, \c TASK_FAIL
+     *  otherwise. */
+    int status;
+    /*! The listening sockets which are passed to the service. */
+    int *listen_fds;
+    /*! The number of listening sockets. */
+    unsigned int listen_fds_size;
+    /*! \c true if the sockets of the task are listening, the dependents
+     *  then don't wait for the task. A simulated boot assumes that the
+     *  sockets would be opened. */
+    bool listening;
+    /*! Describes why the task was skipped, \c NULL if it wasn't skipped. */
+    char *skip_reason;
+    /*! Expires when the command of the task has run for too long. */
+    timer_wheel_timer_t timer;
+    /*! The process id of the command while the timer is armed. */
+    pid_t pid;
+    /*! \c true if the command has timed out and has been asked to
+     *  terminate. */
+    bool timed_out;
+    /*! \c true if the task is needed by any of the targets. */
+    bool selected;
+    /*! The number of the task in the dependency graph. */
+    unsigned int index;
+    /*! \c true if the task is a target which is reached as soon as any of
+     *  its dependencies is ready, it is used for the tasks which provide the
+     *  same name. */
+    bool any;
+    /*! The time in milliseconds from when the task was started until it was
+     *  ready or had exited. */
+    unsigned long duration;
+    /*! \c true if the task has run successfully and \c duration is set. */
+    bool measured;
+    /*! The estimated time in milliseconds of the longest chain of tasks that
+     *  waits for this task, including the task itself. The tasks with the
+     *  highest priority are started first. */
+    unsigned long priority;
+    /*! The estimated time in milliseconds that the task takes, 0 for a
+     *  target. */
+    unsigned long cost;
+    /*! The time in microseconds from when the tasks were started until all
+     *  the dependencies of the task were done. */
+    unsigned long ready_time;
+    /*! The time when the task was admitted and handed to the threads. */
+    unsigned long admit_time;
+    /*! The time when a thread picked up the task. */
+    unsigned long start_time;
+    /*! The time when the dependents of the task were notified. */
+    unsigned long end_time;
+    /*! \c true if the task has notified its dependents. */
+    bool finished;
+    /*! The resources used by the command of the task. */
+    process_usage_t usage;
+    /*! \c true if the command has exited and \c usage is set. */
+    bool reaped;
+} task_t;
+
+task_t * task_create(struct service_t *service, struct task_handler_t *handler);
+
+int task_run_action(void *task);
+void task_replace_requires(task_t *this_ptr, char *name);
+void task_fail(task_t *this_ptr, const char *reason);
+void task_skip(task_t *this_ptr);
+void task_reach(task_t *this_ptr);
+bool task_is_target(task_t *this_ptr);
+
+unsigned int task_get_id(task_t *this_ptr);
+unsigned int task_get_provides_id(task_t *this_ptr);
+task_state_t task_get_state(task_t *this_ptr);
+
+int task_open_listeners(task_t *this_ptr);
+int task_build_dependency(task_t *this_ptr, struct hash_lookup_t *lookup);
+void task_add_graph_edges(task_t *this_ptr, struct task_graph_t *graph,
+                          struct hash_lookup_t *lookup);
+unsigned int task_remove_graph_edges(task_t *this_ptr,
+                                     struct task_graph_t *graph,
+                                     struct hash_lookup_t *lookup,
+                                     unsigned int edge);
+
+void task_destroy(task_t *task);
+
+#endif /* _SPEEDY_TASK_H_ */
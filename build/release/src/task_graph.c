@@ -0,0 +1,1023 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "task_graph.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! The number of bits in a bitset word. */
+#define TASK_GRAPH_WORD_BITS (sizeof(unsigned long) * CHAR_BIT)
+/*! The number of words in a bitset with one bit per node. */
+#define TASK_GRAPH_WORDS(nodes) \
+            (((nodes) + TASK_GRAPH_WORD_BITS - 1u) / TASK_GRAPH_WORD_BITS)
+/*! Checks if a bit is set in a bitset. */
+#define TASK_GRAPH_TEST(set, bit) \
+            (((set)[(bit) / TASK_GRAPH_WORD_BITS] >> \
+              ((bit) % TASK_GRAPH_WORD_BITS)) & 1u)
+/*! Sets a bit in a bitset. */
+#define TASK_GRAPH_SET(set, bit) \
+            ((set)[(bit) / TASK_GRAPH_WORD_BITS] |= \
+             1ul << ((bit) % TASK_GRAPH_WORD_BITS))
+
+static unsigned int *task_graph_sort(task_graph_t *this_ptr);
+static unsigned int task_graph_remove_duplicates(task_graph_t *this_ptr,
+                                                 const unsigned int *first,
+                                                 const unsigned int *index);
+static void task_graph_union(unsigned long *set, const unsigned long *other,
+                             unsigned int words);
+static int task_graph_closure_add(task_graph_closure_t *this_ptr,
+                                  task_graph_t *graph, unsigned int set,
+                                  unsigned int node, const unsigned int *first,
+                                  const unsigned int *index,
+                                  const unsigned int *other,
+                                  unsigned long *scratch);
+static unsigned int task_graph_closure_list(task_graph_closure_t *this_ptr,
+                                            unsigned int set,
+                                            unsigned int *nodes);
+
+/*!
+ * Creates an empty dependency graph.
+ *
+ * \param nodes_size - The number of nodes.
+ *
+ * \return A pointer to the graph or \c NULL if it couldn't be created.
+ */
+task_graph_t *task_graph_create(unsigned int nodes_size)
+{
+    task_graph_t *this_ptr = (task_graph_t*) malloc(sizeof(task_graph_t));
+
+    if (this_ptr != NULL) {
+        this_ptr->nodes_size = nodes_size;
+        this_ptr->edges_size = 0u;
+        this_ptr->edges_capacity = 0u;
+        this_ptr->from = NULL;
+        this_ptr->to = NULL;
+        this_ptr->strong = NULL;
+        this_ptr->removed = NULL;
+    }
+    return this_ptr;
+}
+
+/*!
+ * Adds an edge to the graph, the edges are numbered in the order that they
+ * are added.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param from - The dependent node.
+ * \param to - The dependency node.
+ * \param strong - \c true if the dependent node requires the dependency.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the edge was added,
+ *         \c TASK_GRAPH_FAIL otherwise.
+ */
+int task_graph_add_edge(task_graph_t *this_ptr, unsigned int from,
+                        unsigned int to, bool strong)
+{
+    unsigned int capacity;
+    unsigned int *new_from;
+    unsigned int *new_to;
+    bool *new_strong;
+    bool *new_removed;
+
+    if ((from >= this_ptr->nodes_size) || (to >= this_ptr->nodes_size)) {
+        return TASK_GRAPH_FAIL;
+    }
+
+    if (this_ptr->edges_size == this_ptr->edges_capacity) {
+        capacity = (this_ptr->edges_capacity > 0u) ?
+                   (this_ptr->edges_capacity * 2u) : 16u;
+
+        /* The arrays that were reallocated are kept even if another one
+           fails, they are still valid with the old capacity. */
+        new_from = realloc(this_ptr->from, sizeof(unsigned int) * capacity);
+        if (new_from != NULL) {
+            this_ptr->from = new_from;
+        }
+        new_to = realloc(this_ptr->to, sizeof(unsigned int) * capacity);
+        if (new_to != NULL) {
+            this_ptr->to = new_to;
+        }
+        new_strong = realloc(this_ptr->strong, sizeof(bool) * capacity);
+        if (new_strong != NULL) {
+            this_ptr->strong = new_strong;
+        }
+        new_removed = realloc(this_ptr->removed, sizeof(bool) * capacity);
+        if (new_removed != NULL) {
+            this_ptr->removed = new_removed;
+        }
+        if ((new_from == NULL) || (new_to == NULL) || (new_strong == NULL) ||
+            (new_removed == NULL)) {
+            return TASK_GRAPH_FAIL;
+        }
+        this_ptr->edges_capacity = capacity;
+    }
+
+    this_ptr->from[this_ptr->edges_size] = from;
+    this_ptr->to[this_ptr->edges_size] = to;
+    this_ptr->strong[this_ptr->edges_size] = strong;
+    this_ptr->removed[this_ptr->edges_size] = false;
+    this_ptr->edges_size++;
+
+    return TASK_GRAPH_SUCCESS;
+}
+
+/*!
+ * Removes the duplicate edges and the edges which are implied by other
+ * edges, the transitive reduction of the graph.
+ *
+ * An edge from A to B is implied if A reaches B through another node using
+ * strong edges only. A then can't start before B has finished, and A is
+ * skipped if B fails, so the edge changes nothing. A path with a weak edge
+ * doesn't imply anything since a node which is skipped releases the nodes
+ * which only want it at once. Of two duplicate edges the strong one is kept.
+ *
+ * The reachability is computed with one bitset per node in reverse
+ * topological order, which takes O(N * E / W) time where W is the number of
+ * bits in a word. The closure of the graph can't be used for it, since it
+ * follows the weak edges as well and the reachability has to leave out the
+ * edges as they are removed.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param removed - Set to the number of edges that the reduction removed,
+ *                  the edges which already were removed aren't counted.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the graph was reduced,
+ *         \c TASK_GRAPH_FAIL if it has a cycle or if the memory couldn't be
+ *         allocated, nothing is removed then.
+ */
+int task_graph_reduce(task_graph_t *this_ptr, unsigned int *removed)
+{
+    unsigned int words = TASK_GRAPH_WORDS(this_ptr->nodes_size);
+    unsigned long *reach = NULL;
+    unsigned long *implied = NULL;
+    unsigned int *first = NULL;
+    unsigned int *index = NULL;
+    unsigned int *order = NULL;
+    unsigned int node;
+    unsigned int edge;
+    unsigned int i;
+    unsigned int j;
+    int status = TASK_GRAPH_FAIL;
+
+    *removed = 0u;
+
+    if (task_graph_index(this_ptr, this_ptr->from, &first, &index) ==
+        TASK_GRAPH_SUCCESS) {
+        order = task_graph_sort(this_ptr);
+        reach = calloc((size_t) this_ptr->nodes_size * words + 1u,
+                       sizeof(unsigned long));
+        implied = malloc(sizeof(unsigned long) * (words + 1u));
+    }
+
+    if ((order != NULL) && (reach != NULL) && (implied != NULL)) {
+        *removed = task_graph_remove_duplicates(this_ptr, first, index);
+
+        /* The dependencies come before the dependent nodes in the order. */
+        for (i = 0u; i < this_ptr->nodes_size; i++) {
+            node = order[i];
+
+            /* The nodes that are reached through strong paths of two or
+               more edges. */
+            memset(implied, 0, sizeof(unsigned long) * words);
+            for (j = first[node]; j < first[node + 1u]; j++) {
+                edge = index[j];
+                if (this_ptr->strong[edge] && !this_ptr->removed[edge]) {
+                    task_graph_union(implied,
+                                     &reach[this_ptr->to[edge] * words],
+                                     words);
+                }
+            }
+
+            for (j = first[node]; j < first[node + 1u]; j++) {
+                edge = index[j];
+                if (!this_ptr->removed[edge] &&
+                    TASK_GRAPH_TEST(implied, this_ptr->to[edge])) {
+                    this_ptr->removed[edge] = true;
+                    (*removed)++;
+                }
+            }
+
+            /* The nodes that are reached through strong edges. */
+            memcpy(&reach[node * words], implied,
+                   sizeof(unsigned long) * words);
+            for (j = first[node]; j < first[node + 1u]; j++) {
+                edge = index[j];
+                if (this_ptr->strong[edge] && !this_ptr->removed[edge]) {
+                    TASK_GRAPH_SET(&reach[node * words], this_ptr->to[edge]);
+                }
+            }
+        }
+        status = TASK_GRAPH_SUCCESS;
+    }
+
+    free(implied);
+    free(reach);
+    free(order);
+    free(index);
+    free(first);
+    return status;
+}
+
+/*!
+ * Finds the strongly connected components of the graph with an iterative
+ * version of Tarjan's algorithm, so that deep graphs don't overflow the
+ * stack. Two nodes are in the same component if they reach each other, a
+ * component with more than one node, or a node with an edge to itself, is a
+ * cycle. The removed edges are ignored. It takes O(N + E) time.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param component - Set to the component of each node, it must have room
+ *                    for all the nodes. The components are numbered from 0
+ *                    and a component is numbered before the components
+ *                    which depend on it.
+ * \param components_size - Set to the number of components.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the components were found,
+ *         \c TASK_GRAPH_FAIL if the memory couldn't be allocated.
+ */
+int task_graph_components(task_graph_t *this_ptr, unsigned int *component,
+                          unsigned int *components_size)
+{
+    size_t size = sizeof(unsigned int) * (this_ptr->nodes_size + 1u);
+    unsigned int *first = NULL;
+    unsigned int *index = NULL;
+    unsigned int *number = malloc(size);
+    unsigned int *low = malloc(size);
+    unsigned int *next = malloc(size);
+    unsigned int *stack = malloc(size);
+    unsigned int *calls = malloc(size);
+    unsigned int stack_size = 0u;
+    unsigned int calls_size = 0u;
+    unsigned int counter = 0u;
+    unsigned int root;
+    unsigned int node;
+    unsigned int edge;
+    unsigned int to;
+    int status = TASK_GRAPH_FAIL;
+
+    *components_size = 0u;
+
+    if ((number != NULL) && (low != NULL) && (next != NULL) &&
+        (stack != NULL) && (calls != NULL) &&
+        (task_graph_index(this_ptr, this_ptr->from, &first, &index) ==
+         TASK_GRAPH_SUCCESS)) {
+
+        for (node = 0u; node < this_ptr->nodes_size; node++) {
+            number[node] = TASK_GRAPH_NONE;
+            component[node] = TASK_GRAPH_NONE;
+        }
+
+        for (root = 0u; root < this_ptr->nodes_size; root++) {
+            if (number[root] != TASK_GRAPH_NONE) {
+                continue;
+            }
+
+            /* The call stack of the depth first search, each node remembers
+               the next edge to follow. */
+            number[root] = counter;
+            low[root] = counter;
+            counter++;
+            next[root] = first[root];
+            stack[stack_size] = root;
+            stack_size++;
+            calls[calls_size] = root;
+            calls_size++;
+
+            while (calls_size > 0u) {
+                node = calls[calls_size - 1u];
+
+                if (next[node] < first[node + 1u]) {
+                    edge = index[next[node]];
+                    next[node]++;
+                    to = this_ptr->to[edge];
+
+                    if (this_ptr->removed[edge]) {
+                        continue;
+                    } else if (number[to] == TASK_GRAPH_NONE) {
+                        number[to] = counter;
+                        low[to] = counter;
+                        counter++;
+                        next[to] = first[to];
+                        stack[stack_size] = to;
+                        stack_size++;
+                        calls[calls_size] = to;
+                        calls_size++;
+                    } else if ((component[to] == TASK_GRAPH_NONE) &&
+                               (number[to] < low[node])) {
+                        /* The node is still on the stack. */
+                        low[node] = number[to];
+                    }
+                    continue;
+                }
+
+                calls_size--;
+                if (low[node] == number[node]) {
+                    /* The node is the root of a component, which contains
+                       the nodes above it on the stack. */
+                    do {
+                        stack_size--;
+                        to = stack[stack_size];
+                        component[to] = *components_size;
+                    } while (to != node);
+                    (*components_size)++;
+                }
+                if ((calls_size > 0u) &&
+                    (low[node] < low[calls[calls_size - 1u]])) {
+                    low[calls[calls_size - 1u]] = low[node];
+                }
+            }
+        }
+        status = TASK_GRAPH_SUCCESS;
+    }
+
+    free(calls);
+    free(stack);
+    free(next);
+    free(low);
+    free(number);
+    free(index);
+    free(first);
+    return status;
+}
+
+/*!
+ * Finds a cycle in each strongly connected component which is a cycle. The
+ * cycle is found by following the edges within the component from its first
+ * node until a node is visited again. It takes O(N + E) time.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param component - The component of each node from
+ *                    \c task_graph_components.
+ * \param cycle - Set to the edge that leaves each node in the cycle of its
+ *                component, \c TASK_GRAPH_NONE for the nodes which aren't in
+ *                any cycle. It must have room for all the nodes. Each cycle
+ *                can be followed from any of its nodes.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the cycles were found,
+ *         \c TASK_GRAPH_FAIL if the memory couldn't be allocated.
+ */
+int task_graph_find_cycles(task_graph_t *this_ptr,
+                           const unsigned int *component, unsigned int *cycle)
+{
+    size_t size = sizeof(unsigned int) * (this_ptr->nodes_size + 1u);
+    unsigned int *first = NULL;
+    unsigned int *index = NULL;
+    unsigned int *position = malloc(size);
+    unsigned int *path = malloc(size);
+    bool *visited = calloc(this_ptr->nodes_size + 1u, sizeof(bool));
+    unsigned int path_size;
+    unsigned int node;
+    unsigned int edge;
+    unsigned int start;
+    unsigned int i;
+
+    if ((position == NULL) || (path == NULL) || (visited == NULL) ||
+        (task_graph_index(this_ptr, this_ptr->from, &first, &index) !=
+         TASK_GRAPH_SUCCESS)) {
+        free(visited);
+        free(path);
+        free(position);
+        return TASK_GRAPH_FAIL;
+    }
+
+    for (node = 0u; node < this_ptr->nodes_size; node++) {
+        position[node] = TASK_GRAPH_NONE;
+        cycle[node] = TASK_GRAPH_NONE;
+    }
+
+    /* The components are numbered below the number of nodes, a component is
+       only walked from its first node. */
+    for (start = 0u; start < this_ptr->nodes_size; start++) {
+        if (visited[component[start]]) {
+            continue;
+        }
+        visited[component[start]] = true;
+
+        node = start;
+        path_size = 0u;
+        while (position[node] == TASK_GRAPH_NONE) {
+            position[node] = path_size;
+
+            /* Every node in a cycle has an edge within the component. */
+            edge = TASK_GRAPH_NONE;
+            for (i = first[node]; i < first[node + 1u]; i++) {
+                if (!this_ptr->removed[index[i]] &&
+                    (component[this_ptr->to[index[i]]] ==
+                     component[node])) {
+                    edge = index[i];
+                    break;
+                }
+            }
+            if (edge == TASK_GRAPH_NONE) {
+                break;
+            }
+            path[path_size] = edge;
+            path_size++;
+            node = this_ptr->to[edge];
+        }
+
+        /* The walk ends where it reaches a node on the path again, the
+           edges before that node aren't part of the cycle. */
+        if (position[node] != TASK_GRAPH_NONE) {
+            for (i = position[node]; i < path_size; i++) {
+                cycle[this_ptr->from[path[i]]] = path[i];
+            }
+        }
+        for (i = 0u; i < path_size; i++) {
+            position[this_ptr->from[path[i]]] = TASK_GRAPH_NONE;
+        }
+        position[start] = TASK_GRAPH_NONE;
+    }
+
+    free(index);
+    free(first);
+    free(visited);
+    free(path);
+    free(position);
+    return TASK_GRAPH_SUCCESS;
+}
+
+/*!
+ * Removes an edge from the graph.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param edge - The number of the edge.
+ */
+void task_graph_remove_edge(task_graph_t *this_ptr, unsigned int edge)
+{
+    if (edge < this_ptr->edges_size) {
+        this_ptr->removed[edge] = true;
+    }
+}
+
+/*!
+ * Checks if an edge has been removed.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param edge - The number of the edge.
+ *
+ * \return \c true if the edge has been removed, \c false otherwise.
+ */
+bool task_graph_is_removed(task_graph_t *this_ptr, unsigned int edge)
+{
+    return (edge < this_ptr->edges_size) && this_ptr->removed[edge];
+}
+
+/*!
+ * Indexes the edges by one of their nodes with a counting sort.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param node - The node of each edge that the edges are indexed by, either
+ *               \c from or \c to of the graph.
+ * \param first - Set to the position in \c index of the first edge of each
+ *                node, the edges of a node end where the next node begins.
+ * \param index - Set to the edges in the order of their nodes.
+ *
+ * \note The caller frees \c first and \c index.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the edges were indexed,
+ *         \c TASK_GRAPH_FAIL otherwise.
+ */
+int task_graph_index(task_graph_t *this_ptr, const unsigned int *node,
+                     unsigned int **first, unsigned int **index)
+{
+    unsigned int *position;
+    unsigned int i;
+
+    *first = calloc(this_ptr->nodes_size + 1u, sizeof(unsigned int));
+    *index = malloc(sizeof(unsigned int) * (this_ptr->edges_size + 1u));
+    position = malloc(sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+
+    if ((*first == NULL) || (*index == NULL) || (position == NULL)) {
+        free(position);
+        free(*index);
+        free(*first);
+        *index = NULL;
+        *first = NULL;
+        return TASK_GRAPH_FAIL;
+    }
+
+    for (i = 0u; i < this_ptr->edges_size; i++) {
+        (*first)[node[i] + 1u]++;
+    }
+    for (i = 0u; i < this_ptr->nodes_size; i++) {
+        (*first)[i + 1u] += (*first)[i];
+        position[i] = (*first)[i];
+    }
+    for (i = 0u; i < this_ptr->edges_size; i++) {
+        (*index)[position[node[i]]] = i;
+        position[node[i]]++;
+    }
+
+    free(position);
+    return TASK_GRAPH_SUCCESS;
+}
+
+/*!
+ * Calculates the longest path from each node through the nodes that depend
+ * on it, where every node on the path adds its cost. The node with the
+ * longest path is the one that most of the remaining work waits for. The
+ * removed edges are ignored.
+ *
+ * \param this_ptr - A pointer to the graph.
+ * \param cost - The cost of each node.
+ * \param length - Set to the length of the longest path from each node,
+ *                 including the cost of the node itself.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the lengths were calculated,
+ *         \c TASK_GRAPH_FAIL if the graph has a cycle or the memory
+ *         couldn't be allocated.
+ */
+int task_graph_longest_paths(task_graph_t *this_ptr, const unsigned long *cost,
+                             unsigned long *length)
+{
+    unsigned int *order;
+    unsigned int *first;
+    unsigned int *index;
+    unsigned int node;
+    unsigned int edge;
+    unsigned int i;
+    unsigned int j;
+    unsigned long longest;
+
+    order = task_graph_sort(this_ptr);
+    if ((order == NULL) ||
+        (task_graph_index(this_ptr, this_ptr->to, &first, &index) !=
+         TASK_GRAPH_SUCCESS)) {
+        free(order);
+        return TASK_GRAPH_FAIL;
+    }
+
+    /* The dependent nodes come last in the order, so walking it backwards
+       calculates them before the nodes that they depend on. */
+    for (i = this_ptr->nodes_size; i > 0u; i--) {
+        node = order[i - 1u];
+        longest = 0u;
+
+        for (j = first[node]; j < first[node + 1u]; j++) {
+            edge = index[j];
+            if (!this_ptr->removed[edge] &&
+                (length[this_ptr->from[edge]] > longest)) {
+                longest = length[this_ptr->from[edge]];
+            }
+        }
+        length[node] = cost[node] + longest;
+    }
+
+    free(index);
+    free(first);
+    free(order);
+    return TASK_GRAPH_SUCCESS;
+}
+
+/*!
+ * Destroys a graph.
+ *
+ * \param this_ptr - A pointer to the graph.
+ */
+void task_graph_destroy(task_graph_t *this_ptr)
+{
+    if (this_ptr != NULL) {
+        free(this_ptr->from);
+        free(this_ptr->to);
+        free(this_ptr->strong);
+        free(this_ptr->removed);
+        free(this_ptr);
+    }
+}
+
+/*!
+ * Creates the transitive closure of a graph without cycles. The sets of the
+ * dependencies are built in topological order from the sets of the direct
+ * dependencies, and the sets of the dependents in the reverse order. The
+ * removed edges are ignored.
+ *
+ * \param graph - A pointer to the graph.
+ *
+ * \return A pointer to the closure, \c NULL if the graph has a cycle or if
+ *         the memory couldn't be allocated.
+ */
+task_graph_closure_t *task_graph_closure_create(task_graph_t *graph)
+{
+    unsigned int sets_size = graph->nodes_size * 2u;
+    task_graph_closure_t *this_ptr = malloc(sizeof(task_graph_closure_t));
+    unsigned long *scratch = calloc(TASK_GRAPH_WORDS(graph->nodes_size) + 1u,
+                                    sizeof(unsigned long));
+    unsigned int *order = task_graph_sort(graph);
+    unsigned int *dependencies_first = NULL;
+    unsigned int *dependencies = NULL;
+    unsigned int *dependents_first = NULL;
+    unsigned int *dependents = NULL;
+    int status = TASK_GRAPH_FAIL;
+    unsigned int i;
+
+    if (this_ptr != NULL) {
+        this_ptr->nodes_size = graph->nodes_size;
+        this_ptr->first = malloc(sizeof(unsigned int) * (sets_size + 1u));
+        this_ptr->size = malloc(sizeof(unsigned int) * (sets_size + 1u));
+        this_ptr->offset = malloc(sizeof(size_t) * (sets_size + 1u));
+        this_ptr->words = NULL;
+        this_ptr->words_size = 0u;
+        this_ptr->words_capacity = 0u;
+    }
+
+    if ((this_ptr != NULL) && (this_ptr->first != NULL) &&
+        (this_ptr->size != NULL) && (this_ptr->offset != NULL) &&
+        (scratch != NULL) && (order != NULL) &&
+        (task_graph_index(graph, graph->from, &dependencies_first,
+                          &dependencies) == TASK_GRAPH_SUCCESS) &&
+        (task_graph_index(graph, graph->to, &dependents_first,
+                          &dependents) == TASK_GRAPH_SUCCESS)) {
+
+        status = TASK_GRAPH_SUCCESS;
+        for (i = 0u; (i < graph->nodes_size) &&
+                     (status == TASK_GRAPH_SUCCESS); i++) {
+            status = task_graph_closure_add(this_ptr, graph, order[i],
+                                            order[i], dependencies_first,
+                                            dependencies, graph->to, scratch);
+        }
+        for (i = graph->nodes_size; (i > 0u) &&
+                                    (status == TASK_GRAPH_SUCCESS); i--) {
+            status = task_graph_closure_add(this_ptr, graph,
+                                            graph->nodes_size + order[i - 1u],
+                                            order[i - 1u], dependents_first,
+                                            dependents, graph->from, scratch);
+        }
+    }
+
+    if (status != TASK_GRAPH_SUCCESS) {
+        task_graph_closure_destroy(this_ptr);
+        this_ptr = NULL;
+    }
+
+    free(dependents);
+    free(dependents_first);
+    free(dependencies);
+    free(dependencies_first);
+    free(order);
+    free(scratch);
+    return this_ptr;
+}
+
+/*!
+ * Checks if a node depends on another node, directly or through other
+ * nodes. It takes O(1) time.
+ *
+ * \param this_ptr - A pointer to the closure.
+ * \param node - The dependent node.
+ * \param dependency - The dependency node.
+ *
+ * \return \c true if the node depends on the dependency node, \c false
+ *         otherwise.
+ */
+bool task_graph_closure_depends(task_graph_closure_t *this_ptr,
+                                unsigned int node, unsigned int dependency)
+{
+    unsigned int word = dependency / TASK_GRAPH_WORD_BITS;
+
+    if ((node >= this_ptr->nodes_size) ||
+        (dependency >= this_ptr->nodes_size) ||
+        (word < this_ptr->first[node]) ||
+        (word >= this_ptr->first[node] + this_ptr->size[node])) {
+        return false;
+    }
+    return ((this_ptr->words[this_ptr->offset[node] + word -
+                             this_ptr->first[node]] >>
+             (dependency % TASK_GRAPH_WORD_BITS)) & 1u) != 0u;
+}
+
+/*!
+ * Gets all the nodes that a node depends on, directly or through other
+ * nodes.
+ *
+ * \param this_ptr - A pointer to the closure.
+ * \param node - The node.
+ * \param nodes - Set to the dependencies in increasing order, it must have
+ *                room for all the nodes.
+ *
+ * \return The number of dependencies.
+ */
+unsigned int task_graph_closure_dependencies(task_graph_closure_t *this_ptr,
+                                             unsigned int node,
+                                             unsigned int *nodes)
+{
+    if (node >= this_ptr->nodes_size) {
+        return 0u;
+    }
+    return task_graph_closure_list(this_ptr, node, nodes);
+}
+
+/*!
+ * Gets all the nodes that depend on a node, directly or through other
+ * nodes.
+ *
+ * \param this_ptr - A pointer to the closure.
+ * \param node - The node.
+ * \param nodes - Set to the dependents in increasing order, it must have
+ *                room for all the nodes.
+ *
+ * \return The number of dependents.
+ */
+unsigned int task_graph_closure_dependents(task_graph_closure_t *this_ptr,
+                                           unsigned int node,
+                                           unsigned int *nodes)
+{
+    if (node >= this_ptr->nodes_size) {
+        return 0u;
+    }
+    return task_graph_closure_list(this_ptr, this_ptr->nodes_size + node,
+                                   nodes);
+}
+
+/*!
+ * Destroys a closure.
+ *
+ * \param this_ptr - A pointer to the closure.
+ */
+void task_graph_closure_destroy(task_graph_closure_t *this_ptr)
+{
+    if (this_ptr != NULL) {
+        free(this_ptr->first);
+        free(this_ptr->size);
+        free(this_ptr->offset);
+        free(this_ptr->words);
+        free(this_ptr);
+    }
+}
+
+/*!
+ * Sorts the nodes in topological order with Kahn's algorithm, the
+ * dependencies come before the dependent nodes. The removed edges are
+ * ignored.
+ *
+ * \param this_ptr - A pointer to the graph.
+ *
+ * \return The nodes in topological order, \c NULL if the graph has a cycle
+ *         or if the memory couldn't be allocated.
+ */
+static unsigned int *task_graph_sort(task_graph_t *this_ptr)
+{
+    unsigned int *dependents_first = NULL;
+    unsigned int *dependents = NULL;
+    unsigned int *pending;
+    unsigned int *order;
+    unsigned int head = 0u;
+    unsigned int tail = 0u;
+    unsigned int node;
+    unsigned int i;
+
+    pending = malloc(sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+    order = malloc(sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+
+    if ((pending == NULL) || (order == NULL) ||
+        (task_graph_index(this_ptr, this_ptr->to, &dependents_first,
+                          &dependents) != TASK_GRAPH_SUCCESS)) {
+        free(pending);
+        free(order);
+        return NULL;
+    }
+
+    memset(pending, 0, sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+    for (i = 0u; i < this_ptr->edges_size; i++) {
+        if (!this_ptr->removed[i]) {
+            pending[this_ptr->from[i]]++;
+        }
+    }
+    for (node = 0u; node < this_ptr->nodes_size; node++) {
+        if (pending[node] == 0u) {
+            order[tail] = node;
+            tail++;
+        }
+    }
+
+    while (head < tail) {
+        node = order[head];
+        head++;
+
+        for (i = dependents_first[node]; i < dependents_first[node + 1u];
+             i++) {
+            if (this_ptr->removed[dependents[i]]) {
+                continue;
+            }
+            pending[this_ptr->from[dependents[i]]]--;
+            if (pending[this_ptr->from[dependents[i]]] == 0u) {
+                order[tail] = this_ptr->from[dependents[i]];
+                tail++;
+            }
+        }
+    }
+
+    /* The nodes in a cycle never get rid of their dependencies. */
+    if (tail < this_ptr->nodes_size) {
+        free(order);
+        order = NULL;
+    }
+
+    free(dependents);
+    free(dependents_first);
+    free(pending);
+    return order;
+}
+
+/*!
+ * Removes the duplicate edges of each node, a strong edge is kept before a
+ * weak edge. The edges which already have been removed are ignored.
+ *
+ * \return The number of removed edges.
+ */
+static unsigned int task_graph_remove_duplicates(task_graph_t *this_ptr,
+                                                 const unsigned int *first,
+                                                 const unsigned int *index)
+{
+    unsigned int removed = 0u;
+    unsigned int *seen;
+    unsigned int *kept;
+    unsigned int node;
+    unsigned int edge;
+    unsigned int to;
+    unsigned int i;
+
+    /* The node whose edges were checked when a node was last seen, and the
+       edge to it that is kept. */
+    seen = malloc(sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+    kept = malloc(sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+    if ((seen == NULL) || (kept == NULL)) {
+        free(seen);
+        free(kept);
+        return 0u;
+    }
+    memset(seen, 0xFF, sizeof(unsigned int) * (this_ptr->nodes_size + 1u));
+
+    for (node = 0u; node < this_ptr->nodes_size; node++) {
+        for (i = first[node]; i < first[node + 1u]; i++) {
+            edge = index[i];
+            to = this_ptr->to[edge];
+
+            if (this_ptr->removed[edge]) {
+                continue;
+            } else if (seen[to] != node) {
+                seen[to] = node;
+                kept[to] = edge;
+            } else {
+                if (this_ptr->strong[edge] && !this_ptr->strong[kept[to]]) {
+                    this_ptr->removed[kept[to]] = true;
+                    kept[to] = edge;
+                } else {
+                    this_ptr->removed[edge] = true;
+                }
+                removed++;
+            }
+        }
+    }
+
+    free(seen);
+    free(kept);
+    return removed;
+}
+
+/*!
+ * Adds all the bits of a bitset to another bitset.
+ */
+static void task_graph_union(unsigned long *set, const unsigned long *other,
+                             unsigned int words)
+{
+    unsigned int i;
+
+    for (i = 0u; i < words; i++) {
+        set[i] |= other[i];
+    }
+}
+
+/*!
+ * Builds a set of the closure from the sets of the nodes at the other end of
+ * the edges of a node, the sets of those nodes must already be built.
+ *
+ * \param this_ptr - A pointer to the closure.
+ * \param graph - A pointer to the graph.
+ * \param set - The set which is built.
+ * \param node - The node of the set.
+ * \param first - The first edge of each node in \c index.
+ * \param index - The edges indexed by their node at this end.
+ * \param other - The node at the other end of each edge.
+ * \param scratch - A bitset with room for all the nodes where the set is
+ *                  built, it is cleared again afterwards.
+ *
+ * \return \c TASK_GRAPH_SUCCESS if the set was built,
+ *         \c TASK_GRAPH_FAIL if the memory couldn't be allocated.
+ */
+static int task_graph_closure_add(task_graph_closure_t *this_ptr,
+                                  task_graph_t *graph, unsigned int set,
+                                  unsigned int node, const unsigned int *first,
+                                  const unsigned int *index,
+                                  const unsigned int *other,
+                                  unsigned long *scratch)
+{
+    unsigned int base = (set < this_ptr->nodes_size) ?
+                        0u : this_ptr->nodes_size;
+    unsigned int low = UINT_MAX;
+    unsigned int high = 0u;
+    unsigned long *words;
+    size_t capacity;
+    unsigned int next;
+    unsigned int i;
+
+    for (i = first[node]; i < first[node + 1u]; i++) {
+        if (graph->removed[index[i]]) {
+            continue;
+        }
+        next = other[index[i]];
+
+        TASK_GRAPH_SET(scratch, next);
+        if (next / TASK_GRAPH_WORD_BITS < low) {
+            low = next / TASK_GRAPH_WORD_BITS;
+        }
+        if (next / TASK_GRAPH_WORD_BITS + 1u > high) {
+            high = next / TASK_GRAPH_WORD_BITS + 1u;
+        }
+
+        next += base;
+        if (this_ptr->size[next] > 0u) {
+            task_graph_union(&scratch[this_ptr->first[next]],
+                             &this_ptr->words[this_ptr->offset[next]],
+                             this_ptr->size[next]);
+            if (this_ptr->first[next] < low) {
+                low = this_ptr->first[next];
+            }
+            if (this_ptr->first[next] + this_ptr->size[next] > high) {
+                high = this_ptr->first[next] + this_ptr->size[next];
+            }
+        }
+    }
+
+    this_ptr->first[set] = 0u;
+    this_ptr->size[set] = 0u;
+    this_ptr->offset[set] = this_ptr->words_size;
+    if (high == 0u) {
+        return TASK_GRAPH_SUCCESS;
+    }
+
+    if (this_ptr->words_size + (high - low) > this_ptr->words_capacity) {
+        capacity = (this_ptr->words_capacity > 0u) ?
+                   (this_ptr->words_capacity * 2u) : 64u;
+        while (capacity < this_ptr->words_size + (high - low)) {
+            capacity *= 2u;
+        }
+        words = realloc(this_ptr->words, sizeof(unsigned long) * capacity);
+        if (words == NULL) {
+            return TASK_GRAPH_FAIL;
+        }
+        this_ptr->words = words;
+        this_ptr->words_capacity = capacity;
+    }
+
+    memcpy(&this_ptr->words[this_ptr->words_size], &scratch[low],
+           sizeof(unsigned long) * (high - low));
+    memset(&scratch[low], 0, sizeof(unsigned long) * (high - low));
+    this_ptr->first[set] = low;
+    this_ptr->size[set] = high - low;
+    this_ptr->words_size += high - low;
+    return TASK_GRAPH_SUCCESS;
+}
+
+/*!
+ * Gets the nodes in a set of the closure.
+ *
+ * \return The number of nodes in the set.
+ */
+static unsigned int task_graph_closure_list(task_graph_closure_t *this_ptr,
+                                            unsigned int set,
+                                            unsigned int *nodes)
+{
+    const unsigned long *words = &this_ptr->words[this_ptr->offset[set]];
+    unsigned int nodes_size = 0u;
+    unsigned long word;
+    unsigned int node;
+    unsigned int i;
+
+    for (i = 0u; i < this_ptr->size[set]; i++) {
+        node = (this_ptr->first[set] + i) * TASK_GRAPH_WORD_BITS;
+        for (word = words[i]; word != 0ul; word >>= 1) {
+            if ((word & 1ul) != 0ul) {
+                nodes[nodes_size] = node;
+                nodes_size++;
+            }
+            node++;
+        }
+    }
+    return nodes_size;
+}
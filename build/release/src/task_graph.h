@@ -0,0 +1,95 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_TASK_GRAPH_H_
+#define _SPEEDY_TASK_GRAPH_H_
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*! The operation was successfully executed. */
+#define TASK_GRAPH_SUCCESS 0
+/*! The memory couldn't be allocated or the graph has a cycle. */
+#define TASK_GRAPH_FAIL -1
+/*! Used for a node which doesn't have any edge in a cycle. */
+#define TASK_GRAPH_NONE UINT_MAX
+
+/*!
+ * A dependency graph where the nodes are numbered from 0. An edge from a node
+ * to another node means that the node depends on the other node.
+ */
+typedef struct task_graph_t {
+    unsigned int nodes_size; /*!< The number of nodes. */
+    unsigned int edges_size; /*!< The number of edges. */
+    unsigned int edges_capacity; /*!< The allocated number of edges. */
+    unsigned int *from; /*!< The dependent node of each edge. */
+    unsigned int *to; /*!< The dependency node of each edge. */
+    /*! \c true if the dependent node requires the dependency node, it is
+     *  then skipped if the dependency fails. */
+    bool *strong;
+    /*! \c true if the edge has been removed by the reduction. */
+    bool *removed;
+} task_graph_t;
+
+/*!
+ * The transitive closure of a dependency graph, all the nodes that each node
+ * depends on and all the nodes that depend on each node. Each set is a
+ * bitset where only the words from the first to the last word with any bit
+ * set are stored, which keeps the sets small when the graph is sparse.
+ */
+typedef struct task_graph_closure_t {
+    unsigned int nodes_size; /*!< The number of nodes. */
+    /*! The first stored word of each set, the sets of the dependencies come
+     *  first and then the sets of the dependents. */
+    unsigned int *first;
+    unsigned int *size; /*!< The number of stored words of each set. */
+    size_t *offset; /*!< The position of each set in \c words. */
+    unsigned long *words; /*!< The stored words of all the sets. */
+    size_t words_size; /*!< The number of stored words. */
+    size_t words_capacity; /*!< The allocated number of words. */
+} task_graph_closure_t;
+
+task_graph_t *task_graph_create(unsigned int nodes_size);
+
+int task_graph_add_edge(task_graph_t *this_ptr, unsigned int from,
+                        unsigned int to, bool strong);
+int task_graph_reduce(task_graph_t *this_ptr, unsigned int *removed);
+int task_graph_components(task_graph_t *this_ptr, unsigned int *component,
+                          unsigned int *components_size);
+int task_graph_find_cycles(task_graph_t *this_ptr,
+                           const unsigned int *component, unsigned int *cycle);
+void task_graph_remove_edge(task_graph_t *this_ptr, unsigned int edge);
+bool task_graph_is_removed(task_graph_t *this_ptr, unsigned int edge);
+int task_graph_index(task_graph_t *this_ptr, const unsigned int *node,
+                     unsigned int **first, unsigned int **index);
+int task_graph_longest_paths(task_graph_t *this_ptr, const unsigned long *cost,
+                             unsigned long *length);
+
+void task_graph_destroy(task_graph_t *this_ptr);
+
+task_graph_closure_t *task_graph_closure_create(task_graph_t *graph);
+bool task_graph_closure_depends(task_graph_closure_t *this_ptr,
+                                unsigned int node, unsigned int dependency);
+unsigned int task_graph_closure_dependencies(task_graph_closure_t *this_ptr,
+                                             unsigned int node,
+                                             unsigned int *nodes);
+unsigned int task_graph_closure_dependents(task_graph_closure_t *this_ptr,
+                                           unsigned int node,
+                                           unsigned int *nodes);
+void task_graph_closure_destroy(task_graph_closure_t *this_ptr);
+
+#endif /* _SPEEDY_TASK_GRAPH_H_ */
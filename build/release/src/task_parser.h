@@ -0,0 +1,54 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_TASK_PARSER_H_
+#define _SPEEDY_TASK_PARSER_H_
+
+
+#include <pthread.h>
+
+struct thread_pool_t;
+struct task_handler_t;
+struct queue_t;
+struct hash_lookup_t;
+
+typedef struct task_parser_t {
+    /*! The group in the shared thread pool which executes the parser tasks. */
+    struct thread_pool_group_t *thread_pool_group;
+    struct task_handler_t *handler;
+    pthread_mutex_t *mutex;
+    /*! The names of the targets, \c NULL if all the tasks in the
+     *  configuration should be read. When there are targets, only the
+     *  targets and the tasks that they require or want are read. */
+    struct queue_t *targets;
+    /*! The directories where the task files are looked for when there are
+     *  targets. */
+    struct queue_t *paths;
+    /*! The tasks that have been looked for when there are targets. */
+    struct hash_lookup_t *requested;
+} task_parser_t;
+
+task_parser_t* task_parser_create(struct task_handler_t *handler,
+                                  struct thread_pool_t *thread_pool);
+
+int task_parser_add_target(task_parser_t *this_ptr, const char *name);
+void task_parser_read(task_parser_t *this_ptr, const char * filename);
+void task_parser_wait(task_parser_t* this_ptr);
+
+void task_parser_destroy(task_parser_t *task_parser);
+
+
+#endif /* _SPEEDY_TASK_PARSER_H_ */
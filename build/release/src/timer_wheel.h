@@ -0,0 +1,99 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_TIMER_WHEEL_H_
+#define _SPEEDY_TIMER_WHEEL_H_
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+/*! The operation was successfully executed. */
+#define TIMER_WHEEL_SUCCESS 0
+/*! The timer thread couldn't be started. */
+#define TIMER_WHEEL_FAIL -1
+
+/*! The number of bits that are used for the slots in each level. */
+#define TIMER_WHEEL_SLOT_BITS 6
+/*! The number of slots in each level. */
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+/*! The number of levels, each level covers 64 times longer time than the
+ *  previous level. */
+#define TIMER_WHEEL_LEVELS 4
+
+/*!
+ * A timer which can be added to a timer wheel. The timer is owned by the
+ * user of the timer wheel, usually it is embedded in another struct.
+ */
+typedef struct timer_wheel_timer_t {
+    /*! The next timer in the same slot. */
+    struct timer_wheel_timer_t *next;
+    /*! The previous timer in the same slot. */
+    struct timer_wheel_timer_t *previous;
+    /*! The tick when the timer expires. */
+    unsigned long expires;
+    /*! \c true while the timer is in the timer wheel. */
+    bool armed;
+    /*! Called from the timer thread when the timer expires. The timer can be
+     *  added again from the function. */
+    void (*expired)(struct timer_wheel_timer_t *timer);
+    /*! A pointer which can be used by the expired function. */
+    void *context;
+} timer_wheel_timer_t;
+
+/*!
+ * A hierarchical timer wheel. Adding and cancelling a timer is done in
+ * constant time no matter how many timers there are, and a single thread
+ * drives all the timers.
+ */
+typedef struct timer_wheel_t {
+    /*! The slots of each level, each slot is the list head of a circular
+     *  list of timers. */
+    timer_wheel_timer_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    /*! The current tick. */
+    unsigned long current;
+    /*! The number of milliseconds per tick. */
+    unsigned int resolution;
+    /*! The number of timers in the timer wheel. */
+    unsigned int timers;
+    /*! The timer whose expired function is being called, \c NULL if none. */
+    timer_wheel_timer_t *running;
+    pthread_mutex_t mutex;
+    /*! Signaled when a timer is added or when an expired function has
+     *  returned. */
+    pthread_cond_t condition;
+    pthread_t thread;
+    /*! The time when the timer thread was started. */
+    struct timespec start;
+    bool started; /*!< \c true if the timer thread has been started. */
+    bool exit; /*!< \c true if the timer thread should exit. */
+} timer_wheel_t;
+
+timer_wheel_t *timer_wheel_create(unsigned int resolution);
+
+void timer_wheel_timer_init(timer_wheel_timer_t *timer,
+                            void (*expired)(timer_wheel_timer_t *timer),
+                            void *context);
+void timer_wheel_add(timer_wheel_t *this_ptr, timer_wheel_timer_t *timer,
+                     unsigned long timeout);
+void timer_wheel_cancel(timer_wheel_t *this_ptr, timer_wheel_timer_t *timer);
+
+int timer_wheel_start(timer_wheel_t *this_ptr);
+void timer_wheel_advance(timer_wheel_t *this_ptr, unsigned long ticks);
+
+void timer_wheel_destroy(timer_wheel_t *this_ptr);
+
+#endif /* _SPEEDY_TIMER_WHEEL_H_ */
@@ -0,0 +1,69 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#ifndef _SPEEDY_TIMING_DB_H_
+#define _SPEEDY_TIMING_DB_H_
+
+#include "queue.h"
+
+#include <stdbool.h>
+
+/*! The operation was successfully executed. */
+#define TIMING_DB_SUCCESS 0
+/*! The database couldn't be written or the memory couldn't be allocated. */
+#define TIMING_DB_FAIL -1
+
+struct hash_lookup_t;
+struct service_t;
+
+/*!
+ * The estimated duration of a service from the earlier boots.
+ */
+typedef struct timing_db_entry_t {
+    unsigned int name_id; /*!< The hash of the name of the service. */
+    /*! The hash of the configuration of the service, the estimate starts
+     *  over when the configuration changes. */
+    unsigned int config_id;
+    /*! The exponentially weighted average of the durations in
+     *  milliseconds. */
+    unsigned long estimate;
+    unsigned int samples; /*!< The number of recorded durations. */
+} timing_db_entry_t;
+
+/*!
+ * A small database with the durations of the services, it is read before
+ * the boot and written after it. A service takes the time from when it is
+ * started until it is ready or has exited.
+ */
+typedef struct timing_db_t {
+    char *path; /*!< The file of the database. */
+    queue_t entries; /*!< All the entries in the order that they were added. */
+    /*! The entries by the hash of the name of the service. */
+    struct hash_lookup_t *lookup;
+    bool changed; /*!< \c true if any entry has changed since it was read. */
+} timing_db_t;
+
+timing_db_t *timing_db_create(const char *path);
+
+unsigned int timing_db_config_id(const struct service_t *service);
+bool timing_db_get(timing_db_t *this_ptr, unsigned int name_id,
+                   unsigned int config_id, unsigned long *estimate);
+int timing_db_update(timing_db_t *this_ptr, unsigned int name_id,
+                     unsigned int config_id, unsigned long duration);
+int timing_db_save(timing_db_t *this_ptr);
+
+void timing_db_destroy(timing_db_t *this_ptr);
+
+#endif /* _SPEEDY_TIMING_DB_H_ */
@@ -0,0 +1,515 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "trace.h"
+#include "core_type.h"
+#include "hash_lookup.h"
+#include "observer.h"
+#include "subject.h"
+#include "task_graph.h"
+#include "timer_wheel.h"
+#include "process.h"
+#include "task.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+/*! The names of the event types in the trace. */
+static const char *priv_trace_event_names[TRACE_EVENT_TYPES] = {
+    "parsed", "wired", "ready", "dispatched", "spawned", "readiness",
+    "exited", "notified"
+};
+
+/*!
+ * The run of a task on a worker thread, from when it was picked up until the
+ * dependents have been notified.
+ */
+typedef struct trace_slice_t {
+    uint64_t start; /*!< When the task was dispatched. */
+    uint64_t end; /*!< When the dependents were notified. */
+    unsigned int track; /*!< The thread that ran the task. */
+    bool used; /*!< \c true if the task has run. */
+} trace_slice_t;
+
+static trace_buffer_t *trace_get_buffer(trace_t *this_ptr);
+static void trace_write_separator(FILE *file, bool *first);
+static void trace_write_time(FILE *file, uint64_t time);
+static void trace_write_name(FILE *file, struct hash_lookup_t *lookup,
+                             unsigned int task);
+static void trace_write_buffer(FILE *file, bool *first, trace_t *this_ptr,
+                               trace_buffer_t *buffer,
+                               struct hash_lookup_t *lookup,
+                               trace_slice_t *slices);
+static void trace_write_usage(FILE *file, const process_usage_t *usage);
+static void trace_write_flows(FILE *file, bool *first,
+                              struct task_graph_t *graph,
+                              const trace_slice_t *slices);
+static void trace_write_limit(FILE *file, bool *first,
+                              const trace_limit_t *limit);
+
+/*!
+ * Creates an empty trace, the time of the events is counted from now.
+ *
+ * \param capacity - The number of events that each thread keeps.
+ *
+ * \return A pointer to the trace or \c NULL if it couldn't be created.
+ */
+trace_t *trace_create(unsigned int capacity)
+{
+    trace_t *this_ptr = (trace_t*) malloc(sizeof(trace_t));
+
+    if (this_ptr != NULL) {
+        if (pthread_key_create(&this_ptr->key, NULL) != 0) {
+            free(this_ptr);
+            return NULL;
+        }
+        pthread_mutex_init(&this_ptr->mutex, NULL);
+        queue_init(&this_ptr->buffers);
+        queue_init(&this_ptr->limits);
+        this_ptr->capacity = (capacity > 1u) ? capacity : 2u;
+        this_ptr->tracks = 0u;
+        clock_gettime(CLOCK_MONOTONIC, &this_ptr->start);
+    }
+    return this_ptr;
+}
+
+/*!
+ * Records a state transition of a task in the buffer of the calling thread.
+ * Nothing is recorded if there isn't any trace or if the buffer of the
+ * thread couldn't be allocated.
+ *
+ * \param this_ptr - A pointer to the trace, may be \c NULL.
+ * \param type - The transition.
+ * \param task - The hashed name of the task.
+ */
+void trace_record(trace_t *this_ptr, trace_event_type_t type,
+                  unsigned int task)
+{
+    trace_buffer_t *buffer;
+    trace_event_t *event;
+    struct timespec now;
+
+    if (this_ptr == NULL) {
+        return;
+    }
+    buffer = trace_get_buffer(this_ptr);
+    if (buffer == NULL) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    event = &buffer->events[buffer->head % this_ptr->capacity];
+    event->time = (uint64_t) (now.tv_sec - this_ptr->start.tv_sec) *
+                  1000000000u +
+                  (uint64_t) now.tv_nsec - (uint64_t) this_ptr->start.tv_nsec;
+    event->task = task;
+    event->type = type;
+
+    /* The event is complete before it is counted, so a reader only sees
+       complete events. */
+    __atomic_store_n(&buffer->head, buffer->head + 1u, __ATOMIC_RELEASE);
+}
+
+/*!
+ * Records that the number of tasks which may run at the same time has been
+ * changed because of the system pressure. The limit is only changed under
+ * the lock of the task handler, it isn't on the hot path. Nothing is
+ * recorded if there isn't any trace or if the memory couldn't be allocated.
+ *
+ * \param this_ptr - A pointer to the trace, may be \c NULL.
+ * \param limit - The new limit, 0 if there isn't any limit.
+ * \param resource - The name of the resource whose pressure was above its
+ *                   threshold, \c NULL if all of them were below. It must
+ *                   outlive the trace.
+ * \param pressure - The sampled pressure of the resource in percent.
+ * \param threshold - The threshold of the resource in percent.
+ */
+void trace_record_limit(trace_t *this_ptr, unsigned int limit,
+                        const char *resource, double pressure,
+                        double threshold)
+{
+    trace_limit_t *event;
+    struct timespec now;
+
+    if (this_ptr == NULL) {
+        return;
+    }
+    event = (trace_limit_t*) malloc(sizeof(trace_limit_t));
+    if (event == NULL) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    event->time = (uint64_t) (now.tv_sec - this_ptr->start.tv_sec) *
+                  1000000000u +
+                  (uint64_t) now.tv_nsec - (uint64_t) this_ptr->start.tv_nsec;
+    event->limit = limit;
+    event->resource = resource;
+    event->pressure = pressure;
+    event->threshold = threshold;
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    if (queue_push(&this_ptr->limits, event) != QUEUE_SUCESS) {
+        free(event);
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Writes the recorded events as a Chrome trace, it can be opened in
+ * chrome://tracing or in Perfetto. Each thread is a track, the run of each
+ * task is a slice on the thread that ran it and every transition is an
+ * instant event. The dependencies between the tasks that have run are drawn
+ * as flow arrows. The changes of the pressure limit are a counter with an
+ * instant event that tells which resource caused them.
+ *
+ * \param this_ptr - A pointer to the trace.
+ * \param path - The file to write.
+ * \param graph - The dependency graph, \c NULL if it isn't known.
+ * \param nodes - The task of each node in the graph, \c NULL if the graph
+ *                isn't known.
+ *
+ * \return \c TRACE_SUCCESS if the trace was written, \c TRACE_FAIL
+ *         otherwise.
+ */
+int trace_write(trace_t *this_ptr, const char *path,
+                struct task_graph_t *graph, struct task_t **nodes)
+{
+    struct hash_lookup_t *lookup = NULL;
+    trace_slice_t *slices = NULL;
+    trace_buffer_t *buffer;
+    trace_limit_t *limit;
+    bool first = true;
+    FILE *file;
+    unsigned int i;
+    int status = TRACE_SUCCESS;
+
+    if ((graph != NULL) && (nodes != NULL)) {
+        lookup = hash_lookup_create(64);
+        slices = calloc(graph->nodes_size + 1u, sizeof(trace_slice_t));
+        if ((lookup == NULL) || (slices == NULL)) {
+            hash_lookup_destroy(lookup);
+            free(slices);
+            return TRACE_FAIL;
+        }
+        for (i = 0u; i < graph->nodes_size; i++) {
+            hash_lookup_insert(lookup, task_get_id(nodes[i]), nodes[i]);
+        }
+    }
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        hash_lookup_destroy(lookup);
+        free(slices);
+        return TRACE_FAIL;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    queue_first(&this_ptr->buffers);
+    while ((buffer = queue_get_current(&this_ptr->buffers)) != NULL) {
+        trace_write_buffer(file, &first, this_ptr, buffer, lookup, slices);
+        queue_next(&this_ptr->buffers);
+    }
+    queue_first(&this_ptr->limits);
+    while ((limit = queue_get_current(&this_ptr->limits)) != NULL) {
+        trace_write_limit(file, &first, limit);
+        queue_next(&this_ptr->limits);
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    if (slices != NULL) {
+        trace_write_flows(file, &first, graph, slices);
+    }
+    fprintf(file, "\n]}\n");
+
+    if (ferror(file)) {
+        status = TRACE_FAIL;
+    }
+    if (fclose(file) != 0) {
+        status = TRACE_FAIL;
+    }
+    hash_lookup_destroy(lookup);
+    free(slices);
+    return status;
+}
+
+/*!
+ * Destroys the trace and the buffers of all the threads. No thread may
+ * record anything afterwards.
+ *
+ * \param this_ptr - A pointer to the trace, may be \c NULL.
+ */
+void trace_destroy(trace_t *this_ptr)
+{
+    trace_buffer_t *buffer;
+    trace_limit_t *limit;
+
+    if (this_ptr != NULL) {
+        while ((buffer = queue_pop(&this_ptr->buffers)) != NULL) {
+            free(buffer->events);
+            free(buffer);
+        }
+        queue_deinit(&this_ptr->buffers);
+        while ((limit = queue_pop(&this_ptr->limits)) != NULL) {
+            free(limit);
+        }
+        queue_deinit(&this_ptr->limits);
+        pthread_mutex_destroy(&this_ptr->mutex);
+        pthread_key_delete(this_ptr->key);
+        free(this_ptr);
+    }
+}
+
+/*!
+ * Gets the buffer of the calling thread, it is created the first time.
+ */
+static trace_buffer_t *trace_get_buffer(trace_t *this_ptr)
+{
+    trace_buffer_t *buffer = pthread_getspecific(this_ptr->key);
+
+    if (buffer != NULL) {
+        return buffer;
+    }
+
+    buffer = (trace_buffer_t*) malloc(sizeof(trace_buffer_t));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->head = 0u;
+    buffer->events = malloc(sizeof(trace_event_t) * this_ptr->capacity);
+    if (buffer->events == NULL) {
+        free(buffer);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    buffer->track = this_ptr->tracks;
+    if (queue_push(&this_ptr->buffers, buffer) != QUEUE_SUCESS) {
+        pthread_mutex_unlock(&this_ptr->mutex);
+        free(buffer->events);
+        free(buffer);
+        return NULL;
+    }
+    this_ptr->tracks++;
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    pthread_setspecific(this_ptr->key, buffer);
+    return buffer;
+}
+
+/*!
+ * Separates the events in the trace.
+ */
+static void trace_write_separator(FILE *file, bool *first)
+{
+    fprintf(file, *first ? "\n" : ",\n");
+    *first = false;
+}
+
+/*!
+ * Writes a time in nanoseconds as the microseconds of the trace format.
+ */
+static void trace_write_time(FILE *file, uint64_t time)
+{
+    fprintf(file, "%llu.%03u", (unsigned long long) (time / 1000u),
+            (unsigned int) (time % 1000u));
+}
+
+/*!
+ * Writes the name of a task as a JSON string, the hashed name is used if the
+ * task isn't known.
+ */
+static void trace_write_name(FILE *file, struct hash_lookup_t *lookup,
+                             unsigned int task)
+{
+    task_t *found = NULL;
+    const char *name;
+
+    if (lookup != NULL) {
+        found = hash_lookup_find(lookup, task);
+    }
+    if (found == NULL) {
+        fprintf(file, "\"%08x\"", task);
+        return;
+    }
+
+    fputc('"', file);
+    for (name = found->service->name; *name != '\0'; name++) {
+        if ((*name == '"') || (*name == '\\')) {
+            fprintf(file, "\\%c", *name);
+        } else if ((unsigned char) *name < 0x20u) {
+            fprintf(file, "\\u%04x", (unsigned int) (unsigned char) *name);
+        } else {
+            fputc(*name, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/*!
+ * Writes the events of one thread. The oldest events are gone if the thread
+ * has recorded more than its buffer holds, and the thread may still record
+ * events while they are written. A slice is written for each task
+ * which the thread has run, with the resources of its command when it has
+ * been reaped, and it is remembered for the flow arrows.
+ */
+static void trace_write_buffer(FILE *file, bool *first, trace_t *this_ptr,
+                               trace_buffer_t *buffer,
+                               struct hash_lookup_t *lookup,
+                               trace_slice_t *slices)
+{
+    unsigned long head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+    unsigned long i = 0u;
+    trace_event_t *dispatched = NULL;
+    trace_event_t *event;
+    task_t *task;
+
+    /* The oldest event in a full ring may be overwritten while it is read,
+       it is left out. */
+    if (head >= this_ptr->capacity) {
+        i = head - this_ptr->capacity + 1u;
+    }
+
+    trace_write_separator(file, first);
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", buffer->track,
+            buffer->track);
+
+    for (; i < head; i++) {
+        event = &buffer->events[i % this_ptr->capacity];
+
+        trace_write_separator(file, first);
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"i\","
+                "\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":",
+                priv_trace_event_names[event->type], buffer->track);
+        trace_write_time(file, event->time);
+        fprintf(file, ",\"args\":{\"task\":");
+        trace_write_name(file, lookup, event->task);
+        fprintf(file, "}}");
+
+        if (event->type == TRACE_DISPATCHED) {
+            dispatched = event;
+        } else if ((event->type == TRACE_NOTIFIED) && (dispatched != NULL) &&
+                   (dispatched->task == event->task)) {
+            task = (lookup != NULL) ? hash_lookup_find(lookup, event->task) :
+                                      NULL;
+
+            trace_write_separator(file, first);
+            fprintf(file, "{\"name\":");
+            trace_write_name(file, lookup, event->task);
+            fprintf(file, ",\"cat\":\"run\",\"ph\":\"X\",\"pid\":1,"
+                    "\"tid\":%u,\"ts\":", buffer->track);
+            trace_write_time(file, dispatched->time);
+            fprintf(file, ",\"dur\":");
+            trace_write_time(file, event->time - dispatched->time);
+            if ((task != NULL) && task->reaped) {
+                trace_write_usage(file, &task->usage);
+            }
+            fprintf(file, "}");
+
+            if ((task != NULL) && (slices != NULL)) {
+                slices[task->index].start = dispatched->time;
+                slices[task->index].end = event->time;
+                slices[task->index].track = buffer->track;
+                slices[task->index].used = true;
+            }
+            dispatched = NULL;
+        }
+    }
+}
+
+/*!
+ * Writes the resources that the command of a task used as the arguments of
+ * its slice, the times are in microseconds like the duration of the slice.
+ */
+static void trace_write_usage(FILE *file, const process_usage_t *usage)
+{
+    fprintf(file, ",\"args\":{\"spawn_us\":%lu,\"user_us\":%lu,"
+            "\"system_us\":%lu,\"max_rss_kb\":%ld,\"major_faults\":%ld,"
+            "\"minor_faults\":%ld,\"voluntary_switches\":%ld,"
+            "\"involuntary_switches\":%ld,\"block_input\":%ld,"
+            "\"block_output\":%ld}", usage->spawn_time, usage->user_time,
+            usage->system_time, usage->max_rss, usage->major_faults,
+            usage->minor_faults, usage->voluntary_switches,
+            usage->involuntary_switches, usage->block_input,
+            usage->block_output);
+}
+
+/*!
+ * Writes a flow arrow from the run of each dependency to the run of the task
+ * which waited for it. The dependencies that haven't run, like the targets,
+ * don't get any arrow.
+ */
+static void trace_write_flows(FILE *file, bool *first,
+                              struct task_graph_t *graph,
+                              const trace_slice_t *slices)
+{
+    const trace_slice_t *from;
+    const trace_slice_t *to;
+    unsigned int edge;
+
+    for (edge = 0u; edge < graph->edges_size; edge++) {
+        from = &slices[graph->to[edge]];
+        to = &slices[graph->from[edge]];
+        if (task_graph_is_removed(graph, edge) || !from->used || !to->used) {
+            continue;
+        }
+
+        trace_write_separator(file, first);
+        fprintf(file, "{\"name\":\"dependency\",\"cat\":\"dependency\","
+                "\"ph\":\"s\",\"id\":%u,\"pid\":1,\"tid\":%u,\"ts\":",
+                edge + 1u, from->track);
+        trace_write_time(file, from->start);
+        fprintf(file, "}");
+
+        trace_write_separator(file, first);
+        fprintf(file, "{\"name\":\"dependency\",\"cat\":\"dependency\","
+                "\"ph\":\"f\",\"bp\":\"e\",\"id\":%u,\"pid\":1,\"tid\":%u,"
+                "\"ts\":", edge + 1u, to->track);
+        trace_write_time(file, to->start);
+        fprintf(file, "}");
+    }
+}
+
+/*!
+ * Writes a change of the pressure limit as a counter of the number of tasks
+ * that may run, 0 when there isn't any limit, and as an instant event with
+ * the resource and the sample that caused it.
+ */
+static void trace_write_limit(FILE *file, bool *first,
+                              const trace_limit_t *limit)
+{
+    trace_write_separator(file, first);
+    fprintf(file, "{\"name\":\"pressure limit\",\"cat\":\"pressure\","
+            "\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":");
+    trace_write_time(file, limit->time);
+    fprintf(file, ",\"args\":{\"limit\":%u}}", limit->limit);
+
+    trace_write_separator(file, first);
+    fprintf(file, "{\"name\":\"limit\",\"cat\":\"pressure\",\"ph\":\"i\","
+            "\"s\":\"p\",\"pid\":1,\"tid\":0,\"ts\":");
+    trace_write_time(file, limit->time);
+    fprintf(file, ",\"args\":{\"limit\":%u", limit->limit);
+    if (limit->resource != NULL) {
+        fprintf(file, ",\"resource\":\"%s\",\"pressure\":%.2f,"
+                "\"threshold\":%.2f", limit->resource, limit->pressure,
+                limit->threshold);
+    }
+    fprintf(file, "}}");
+}
@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#ifndef _SPEEDY_ANALYSIS_H_
+#define _SPEEDY_ANALYSIS_H_
+
+/*! The operation was successfully executed. */
+#define ANALYSIS_SUCCESS 0
+/*! General error which mostly likely happens during malloc. */
+#define ANALYSIS_FAIL -1
+/*! The time in microseconds that an admitted task may wait for a worker
+ *  before it counts as starved. */
+#define ANALYSIS_STARVATION_TIME 1000u
+
+struct task_handler_t;
+
+/*!
+ * Where the time of a finished boot went, the nodes refer to the dependency
+ * graph of the task handler.
+ */
+typedef struct analysis_t {
+    /*! The time in microseconds until the last task had finished. */
+    unsigned long wall;
+    /*! The chain of tasks that decided the wall time, each task was
+     *  released by the task before it. */
+    unsigned int *chain;
+    unsigned int chain_size; /*!< The number of nodes in the chain. */
+    /*! The tasks which were admitted but waited for a worker longer than
+     *  \c ANALYSIS_STARVATION_TIME. */
+    unsigned int *starved;
+    unsigned int starved_size; /*!< The number of starved tasks. */
+} analysis_t;
+
+int analysis_run(struct task_handler_t *handler, analysis_t *result);
+void analysis_deinit(analysis_t *result);
+
+#endif /* _SPEEDY_ANALYSIS_H_ */
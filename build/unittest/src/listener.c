@@ -0,0 +1,144 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "listener.h"
+
+#include <netdb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*! The prefix of a Unix domain socket address. */
+#define LISTENER_UNIX "unix:"
+/*! The prefix of a TCP socket address. */
+#define LISTENER_TCP "tcp:"
+
+static int listener_open_unix(const char *path);
+static int listener_open_tcp(const char *address);
+
+/*!
+ * Creates a socket which is bound to an address and is listening for
+ * connections. The socket is closed automatically in processes that are
+ * started, it has to be passed on explicitly.
+ *
+ * \param address - The address, either "unix:/path/to/socket" or
+ *                  "tcp:host:port". An IPv6 host is written within brackets,
+ *                  for example "tcp:[::1]:80".
+ *
+ * \return The file descriptor of the socket or \c LISTENER_FAIL if the socket
+ *         couldn't be created.
+ */
+int listener_open(const char *address)
+{
+    if (strncmp(address, LISTENER_UNIX, strlen(LISTENER_UNIX)) == 0) {
+        return listener_open_unix(address + strlen(LISTENER_UNIX));
+
+    } else if (strncmp(address, LISTENER_TCP, strlen(LISTENER_TCP)) == 0) {
+        return listener_open_tcp(address + strlen(LISTENER_TCP));
+
+    } else {
+        return LISTENER_FAIL;
+    }
+}
+
+/*!
+ * Creates a listening Unix domain socket, a stale socket file from an earlier
+ * boot is removed first.
+ */
+static int listener_open_unix(const char *path)
+{
+    struct sockaddr_un address;
+    int fd;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return LISTENER_FAIL;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return LISTENER_FAIL;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    if ((bind(fd, (struct sockaddr*) &address, sizeof(address)) != 0) ||
+        (listen(fd, SOMAXCONN) != 0)) {
+        close(fd);
+        return LISTENER_FAIL;
+    }
+    return fd;
+}
+
+/*!
+ * Creates a listening TCP socket.
+ */
+static int listener_open_tcp(const char *address)
+{
+    struct addrinfo hints;
+    struct addrinfo *result;
+    struct addrinfo *info;
+    const char *port = strrchr(address, ':');
+    char *host;
+    int fd = LISTENER_FAIL;
+    int reuse = 1;
+
+    if (port == NULL) {
+        return LISTENER_FAIL;
+    }
+
+    /* Remove the brackets around an IPv6 address. */
+    if ((address[0] == '[') && (port > address) && (port[-1] == ']')) {
+        host = strndup(address + 1, port - address - 2);
+    } else {
+        host = strndup(address, port - address);
+    }
+    if (host == NULL) {
+        return LISTENER_FAIL;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    if (getaddrinfo((host[0] != '\0') ? host : NULL, port + 1, &hints,
+                    &result) == 0) {
+
+        for (info = result; (info != NULL) && (fd < 0); info = info->ai_next) {
+            fd = socket(info->ai_family, info->ai_socktype | SOCK_CLOEXEC,
+                        info->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            if ((bind(fd, info->ai_addr, info->ai_addrlen) != 0) ||
+                (listen(fd, SOMAXCONN) != 0)) {
+                close(fd);
+                fd = LISTENER_FAIL;
+            }
+        }
+        freeaddrinfo(result);
+    }
+    free(host);
+
+    return fd;
+}
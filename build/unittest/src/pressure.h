@@ -0,0 +1,89 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_PRESSURE_H_
+#define _SPEEDY_PRESSURE_H_
+
+#include <stdbool.h>
+#include <time.h>
+
+struct trace_t;
+
+/*! The operation was successfully executed. */
+#define PRESSURE_SUCCESS 0
+/*! It wasn't possible to read the pressure. */
+#define PRESSURE_FAIL -1
+/*! The admission isn't limited by the pressure. */
+#define PRESSURE_NO_LIMIT 0xFFFFFFFFu
+
+/*! The resources that the pressure is measured for. */
+typedef enum pressure_resource_t {
+    PRESSURE_CPU,
+    PRESSURE_IO,
+    PRESSURE_MEMORY,
+    PRESSURE_RESOURCES
+} pressure_resource_t;
+
+/*!
+ * The pressure of each resource in percent, it is the share of the time that
+ * some tasks were stalled waiting for the resource.
+ */
+typedef struct pressure_sample_t {
+    double pressure[PRESSURE_RESOURCES];
+} pressure_sample_t;
+
+/*!
+ * Keeps track of the system pressure and how many tasks that can be admitted
+ * because of it. The pressure is read from PSI if the kernel supports it,
+ * otherwise it is estimated from the load average and the available memory.
+ */
+typedef struct pressure_t {
+    /*! The directory with the PSI files, normally "/proc/pressure". */
+    const char *pressure_path;
+    /*! The load average file which is used if PSI isn't supported. */
+    const char *loadavg_path;
+    /*! The memory information file which is used if PSI isn't supported. */
+    const char *meminfo_path;
+    /*! The number of online CPUs, used for estimating the CPU pressure from
+     *  the load average. */
+    unsigned int cpus;
+    /*! The thresholds in percent for each resource, 0 if the resource isn't
+     *  used for throttling. */
+    double threshold[PRESSURE_RESOURCES];
+    /*! The minimum time in milliseconds between two samples. */
+    long interval;
+    /*! The time of the last sample. */
+    struct timespec last_sample;
+    /*! The number of tasks that can be running at the same time. */
+    unsigned int limit;
+    /*! The function which reads a sample, it can be replaced by another
+     *  pressure source. */
+    int (*read)(struct pressure_t *this_ptr, pressure_sample_t *sample);
+    /*! Records the changes of the limit, \c NULL if they aren't traced. */
+    struct trace_t *trace;
+} pressure_t;
+
+pressure_t *pressure_create(void);
+void pressure_init(pressure_t *this_ptr);
+
+int pressure_set_threshold(pressure_t *this_ptr, const char *resource,
+                           double threshold);
+int pressure_read(pressure_t *this_ptr, pressure_sample_t *sample);
+unsigned int pressure_get_limit(pressure_t *this_ptr, unsigned int running);
+
+void pressure_destroy(pressure_t *this_ptr);
+
+#endif /* _SPEEDY_PRESSURE_H_ */
@@ -0,0 +1,391 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "process.h"
+#include "shutdown.h"
+#include "task_graph.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*! How often in milliseconds the process groups without a pidfd are
+ *  polled. */
+#define SHUTDOWN_POLL_INTERVAL 100u
+
+static unsigned long shutdown_now(void);
+static bool shutdown_signal(shutdown_t *this_ptr, unsigned int node,
+                            unsigned long now);
+static bool shutdown_has_exited(shutdown_service_t *service,
+                                const struct pollfd *fd);
+static void shutdown_stopped(shutdown_t *this_ptr, unsigned int node,
+                             shutdown_result_t result);
+static int shutdown_poll_timeout(shutdown_t *this_ptr,
+                                 const unsigned int *running,
+                                 unsigned int running_size, unsigned long now);
+
+/*!
+ * Creates a shutdown of the services in a dependency graph. No service has a
+ * process until \c shutdown_set_process is called.
+ *
+ * \param graph - The dependency graph, it must not have any cycle.
+ *
+ * \return A pointer to the shutdown or \c NULL if it couldn't be created.
+ */
+shutdown_t *shutdown_create(task_graph_t *graph)
+{
+    shutdown_t *this_ptr = (shutdown_t*) malloc(sizeof(shutdown_t));
+    unsigned int i;
+
+    if (this_ptr != NULL) {
+        this_ptr->services = malloc(sizeof(shutdown_service_t) *
+                                    (graph->nodes_size + 1u));
+        if (this_ptr->services == NULL) {
+            free(this_ptr);
+            return NULL;
+        }
+        for (i = 0u; i < graph->nodes_size; i++) {
+            this_ptr->services[i].pid = 0;
+            this_ptr->services[i].pidfd = -1;
+            this_ptr->services[i].timeout = 0u;
+            this_ptr->services[i].pending = 0u;
+            this_ptr->services[i].deadline = 0ul;
+            this_ptr->services[i].killed = false;
+        }
+        this_ptr->graph = graph;
+        this_ptr->stopped = NULL;
+        this_ptr->context = NULL;
+        this_ptr->first = NULL;
+        this_ptr->index = NULL;
+        this_ptr->ready = NULL;
+        this_ptr->ready_size = 0u;
+    }
+    return this_ptr;
+}
+
+/*!
+ * Sets the running process of the service of a node.
+ *
+ * \param this_ptr - A pointer to the shutdown.
+ * \param node - The node.
+ * \param pid - The process id, 0 if the service isn't running. The process
+ *              leads the process group that the service was started in.
+ * \param timeout - The time in milliseconds that the processes get to exit
+ *                  after SIGTERM before they are killed.
+ */
+void shutdown_set_process(shutdown_t *this_ptr, unsigned int node, pid_t pid,
+                          unsigned int timeout)
+{
+    this_ptr->services[node].pid = pid;
+    this_ptr->services[node].timeout = timeout;
+}
+
+/*!
+ * Sets the function which is called when the service of a node has been
+ * stopped.
+ */
+void shutdown_set_callback(shutdown_t *this_ptr,
+                           void (*stopped)(void *context, unsigned int node,
+                                           shutdown_result_t result),
+                           void *context)
+{
+    this_ptr->stopped = stopped;
+    this_ptr->context = context;
+}
+
+/*!
+ * Stops all the services in reverse dependency order and waits until they
+ * are down. Every service whose dependents are all down gets SIGTERM in the
+ * same batch, a service which hasn't exited when its timeout expires gets
+ * SIGKILL. A service which isn't running counts as stopped at once.
+ *
+ * \param this_ptr - A pointer to the shutdown.
+ *
+ * \return \c SHUTDOWN_SUCCESS if all the services were stopped or killed,
+ *         \c SHUTDOWN_FAIL if any service was left running or the memory
+ *         couldn't be allocated.
+ */
+int shutdown_run(shutdown_t *this_ptr)
+{
+    task_graph_t *graph = this_ptr->graph;
+    shutdown_service_t *service;
+    unsigned int *running;
+    struct pollfd *fds;
+    unsigned int running_size = 0u;
+    unsigned int fds_size;
+    unsigned int i;
+    unsigned int j;
+    unsigned int node;
+    unsigned long now;
+    struct pollfd *fd;
+    int status = SHUTDOWN_SUCCESS;
+
+    running = malloc(sizeof(unsigned int) * (graph->nodes_size + 1u));
+    fds = malloc(sizeof(struct pollfd) * (graph->nodes_size + 1u));
+    this_ptr->ready = malloc(sizeof(unsigned int) * (graph->nodes_size + 1u));
+
+    if ((running == NULL) || (fds == NULL) || (this_ptr->ready == NULL) ||
+        (task_graph_index(graph, graph->from, &this_ptr->first,
+                          &this_ptr->index) != TASK_GRAPH_SUCCESS)) {
+        free(this_ptr->ready);
+        free(fds);
+        free(running);
+        this_ptr->ready = NULL;
+        return SHUTDOWN_FAIL;
+    }
+
+    /* A service can be stopped when every service that depends on it is. */
+    this_ptr->ready_size = 0u;
+    for (i = 0u; i < graph->edges_size; i++) {
+        if (!task_graph_is_removed(graph, i)) {
+            this_ptr->services[graph->to[i]].pending++;
+        }
+    }
+    for (i = 0u; i < graph->nodes_size; i++) {
+        if (this_ptr->services[i].pending == 0u) {
+            this_ptr->ready[this_ptr->ready_size] = i;
+            this_ptr->ready_size++;
+        }
+    }
+
+    while ((this_ptr->ready_size > 0u) || (running_size > 0u)) {
+        now = shutdown_now();
+
+        /* Signal all the services that can be stopped now in one batch, the
+         * ones that aren't running release their dependencies at once. */
+        while (this_ptr->ready_size > 0u) {
+            this_ptr->ready_size--;
+            node = this_ptr->ready[this_ptr->ready_size];
+
+            if (shutdown_signal(this_ptr, node, now)) {
+                running[running_size] = node;
+                running_size++;
+            }
+        }
+
+        if (running_size == 0u) {
+            break;
+        }
+
+        fds_size = 0u;
+        for (i = 0u; i < running_size; i++) {
+            service = &this_ptr->services[running[i]];
+            if (service->pidfd >= 0) {
+                fds[fds_size].fd = service->pidfd;
+                fds[fds_size].events = POLLIN;
+                fds[fds_size].revents = 0;
+                fds_size++;
+            }
+        }
+
+        if ((poll(fds, fds_size, shutdown_poll_timeout(this_ptr, running,
+                                                       running_size,
+                                                       now)) < 0) &&
+            (errno != EINTR)) {
+            status = SHUTDOWN_FAIL;
+            break;
+        }
+        now = shutdown_now();
+
+        /* The descriptors are in the same order as the running services. */
+        fds_size = 0u;
+        j = 0u;
+        for (i = 0u; i < running_size; i++) {
+            node = running[i];
+            service = &this_ptr->services[node];
+            fd = NULL;
+            if (service->pidfd >= 0) {
+                fd = &fds[fds_size];
+                fds_size++;
+            }
+
+            if (shutdown_has_exited(service, fd)) {
+                shutdown_stopped(this_ptr, node, service->killed ?
+                                 SHUTDOWN_KILLED : SHUTDOWN_STOPPED);
+
+            } else if (now < service->deadline) {
+                running[j] = node;
+                j++;
+
+            } else if (!service->killed) {
+                process_signal(service->pid, SIGKILL);
+                service->killed = true;
+                service->deadline = now + service->timeout;
+                running[j] = node;
+                j++;
+
+            } else {
+                status = SHUTDOWN_FAIL;
+                shutdown_stopped(this_ptr, node, SHUTDOWN_LEFT);
+            }
+        }
+        running_size = j;
+    }
+
+    for (i = 0u; i < running_size; i++) {
+        shutdown_stopped(this_ptr, running[i], SHUTDOWN_LEFT);
+    }
+
+    free(this_ptr->index);
+    free(this_ptr->first);
+    free(this_ptr->ready);
+    free(fds);
+    free(running);
+    this_ptr->index = NULL;
+    this_ptr->first = NULL;
+    this_ptr->ready = NULL;
+    return status;
+}
+
+/*!
+ * Destroys the shutdown, the processes are left as they are.
+ */
+void shutdown_destroy(shutdown_t *this_ptr)
+{
+    free(this_ptr->services);
+    free(this_ptr);
+}
+
+/*!
+ * Gets the monotonic time in milliseconds.
+ */
+static unsigned long shutdown_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long) now.tv_sec * 1000ul +
+           (unsigned long) now.tv_nsec / 1000000ul;
+}
+
+/*!
+ * Sends SIGTERM to the process group of a node. The pidfd of the group
+ * leader is opened before the signal is sent so that it refers to the
+ * signaled process even if it exits at once.
+ *
+ * \return \c true if the process has to be waited for, \c false if the node
+ *         has already been reported as stopped.
+ */
+static bool shutdown_signal(shutdown_t *this_ptr, unsigned int node,
+                            unsigned long now)
+{
+    shutdown_service_t *service = &this_ptr->services[node];
+
+    if (service->pid <= 0) {
+        shutdown_stopped(this_ptr, node, SHUTDOWN_NOT_RUNNING);
+        return false;
+    }
+
+    service->pidfd = process_pidfd_open(service->pid);
+    if (process_signal(service->pid, SIGTERM) != PROCESS_SUCCESS) {
+        shutdown_stopped(this_ptr, node, (errno == ESRCH) ?
+                         SHUTDOWN_NOT_RUNNING : SHUTDOWN_LEFT);
+        return false;
+    }
+
+    service->deadline = now + service->timeout;
+    return true;
+}
+
+/*!
+ * Checks if every process in the group of a service has exited. The pidfd
+ * only tells when the group leader exits, the processes that it started may
+ * still be running so the group is probed from then on. Exited processes
+ * that are children of this process are reaped, the group isn't empty as
+ * long as they are zombies.
+ */
+static bool shutdown_has_exited(shutdown_service_t *service,
+                                const struct pollfd *fd)
+{
+    if ((fd != NULL) && (fd->revents == 0)) {
+        return false;
+    }
+    if (service->pidfd >= 0) {
+        close(service->pidfd);
+        service->pidfd = -1;
+    }
+
+    while (waitpid(-service->pid, NULL, WNOHANG) > 0) {
+    }
+    return ((kill(-service->pid, 0) != 0) && (errno == ESRCH));
+}
+
+/*!
+ * Reports that the service of a node is down and makes the services that it
+ * depends on ready when all their other dependents are down too.
+ */
+static void shutdown_stopped(shutdown_t *this_ptr, unsigned int node,
+                             shutdown_result_t result)
+{
+    task_graph_t *graph = this_ptr->graph;
+    shutdown_service_t *service = &this_ptr->services[node];
+    unsigned int dependency;
+    unsigned int i;
+
+    if (service->pidfd >= 0) {
+        close(service->pidfd);
+        service->pidfd = -1;
+    }
+
+    if (this_ptr->stopped != NULL) {
+        this_ptr->stopped(this_ptr->context, node, result);
+    }
+
+    for (i = this_ptr->first[node]; i < this_ptr->first[node + 1u]; i++) {
+        if (task_graph_is_removed(graph, this_ptr->index[i])) {
+            continue;
+        }
+        dependency = graph->to[this_ptr->index[i]];
+        this_ptr->services[dependency].pending--;
+
+        if (this_ptr->services[dependency].pending == 0u) {
+            this_ptr->ready[this_ptr->ready_size] = dependency;
+            this_ptr->ready_size++;
+        }
+    }
+}
+
+/*!
+ * Calculates how long to wait for the running processes, until the next
+ * deadline or the next probe of a process without a pidfd.
+ */
+static int shutdown_poll_timeout(shutdown_t *this_ptr,
+                                 const unsigned int *running,
+                                 unsigned int running_size, unsigned long now)
+{
+    shutdown_service_t *service;
+    unsigned long timeout = ULONG_MAX;
+    unsigned int i;
+
+    for (i = 0u; i < running_size; i++) {
+        service = &this_ptr->services[running[i]];
+
+        if (service->deadline <= now) {
+            return 0;
+        }
+        if ((service->deadline - now) < timeout) {
+            timeout = service->deadline - now;
+        }
+        if ((service->pidfd < 0) && (timeout > SHUTDOWN_POLL_INTERVAL)) {
+            timeout = SHUTDOWN_POLL_INTERVAL;
+        }
+    }
+    return (timeout > (unsigned long) INT_MAX) ? INT_MAX : (int) timeout;
+}
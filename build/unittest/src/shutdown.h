@@ -0,0 +1,97 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#ifndef _SPEEDY_SHUTDOWN_H_
+#define _SPEEDY_SHUTDOWN_H_
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*! The operation was successfully executed. */
+#define SHUTDOWN_SUCCESS 0
+/*! General error which mostly likely happens during malloc. */
+#define SHUTDOWN_FAIL -1
+
+struct task_graph_t;
+
+/*!
+ * How a service was stopped.
+ */
+typedef enum shutdown_result_t {
+    SHUTDOWN_NOT_RUNNING, /*!< The service didn't have any process. */
+    SHUTDOWN_STOPPED, /*!< The processes exited after SIGTERM. */
+    SHUTDOWN_KILLED, /*!< The processes were killed after the timeout. */
+    SHUTDOWN_LEFT /*!< A process didn't exit even after SIGKILL. */
+} shutdown_result_t;
+
+/*!
+ * The process group of a node in the dependency graph.
+ */
+typedef struct shutdown_service_t {
+    /*! The process id of the group leader, which is also the process group
+     *  id, 0 if the service isn't running. */
+    pid_t pid;
+    /*! A file descriptor which refers to the group leader until it has
+     *  exited, -1 if the kernel doesn't support it or the leader is gone
+     *  and the group has to be polled instead. */
+    int pidfd;
+    /*! The time in milliseconds that the processes get to exit after
+     *  SIGTERM before they are killed. */
+    unsigned int timeout;
+    /*! The number of dependents that haven't been stopped yet. */
+    unsigned int pending;
+    /*! The time in milliseconds when the process is killed. */
+    unsigned long deadline;
+    bool killed; /*!< \c true if SIGKILL has been sent. */
+} shutdown_service_t;
+
+/*!
+ * Stops the processes of a dependency graph in reverse dependency order.
+ * A service is stopped as soon as all the services that depend on it are
+ * down, so independent branches are stopped in parallel. A service is down
+ * when every process in its process group has exited. All the services
+ * which become ready at the same time are signaled in one batch and a single
+ * thread waits for all of them.
+ */
+typedef struct shutdown_t {
+    struct task_graph_t *graph; /*!< The dependency graph, not owned. */
+    shutdown_service_t *services; /*!< The process of each node. */
+    /*! Called when the service of a node has been stopped, may be \c NULL. */
+    void (*stopped)(void *context, unsigned int node,
+                    shutdown_result_t result);
+    void *context; /*!< The argument to the stopped function. */
+    /*! The position in \c index of the first dependency edge of each node
+     *  while the services are stopped. */
+    unsigned int *first;
+    unsigned int *index; /*!< The edges in the order of their dependents. */
+    /*! The nodes whose dependents are all down but which haven't been
+     *  signaled yet. */
+    unsigned int *ready;
+    unsigned int ready_size; /*!< The number of ready nodes. */
+} shutdown_t;
+
+shutdown_t *shutdown_create(struct task_graph_t *graph);
+
+void shutdown_set_process(shutdown_t *this_ptr, unsigned int node, pid_t pid,
+                          unsigned int timeout);
+void shutdown_set_callback(shutdown_t *this_ptr,
+                           void (*stopped)(void *context, unsigned int node,
+                                           shutdown_result_t result),
+                           void *context);
+int shutdown_run(shutdown_t *this_ptr);
+
+void shutdown_destroy(shutdown_t *this_ptr);
+
+#endif /* _SPEEDY_SHUTDOWN_H_ */
@@ -0,0 +1,957 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "core_type.h"
+#include "observer.h"
+#include "queue.h"
+#include "subject.h"
+#include "hash.h"
+#include "hash_lookup.h"
+#include "listener.h"
+#include "process.h"
+#include "supervisor.h"
+#include "task_graph.h"
+#include "task_handler.h"
+#include "timer_wheel.h"
+#include "task.h"
+#include "stats.h"
+#include "thread_pool.h"
+#include "trace.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define NOT_USED(var) (void) var
+
+/*! The time in milliseconds that a command which has timed out gets to
+ *  terminate before it is killed. */
+#define TASK_KILL_TIMEOUT 5000u
+
+/*!
+ * A struct which keeps track of the depencies.
+ */
+typedef struct task_dependency_t {
+    unsigned int id; /*! Id of the dependency task. */
+    char * name; /*!< The name of the dependency. */
+    task_t *task; /*! The task which is a dependency. */
+    task_dependency_kind_t kind; /*!< The strength of the dependency. */
+    /*! \c true if the dependency is implied by other dependencies. */
+    bool removed;
+} task_dependency_t;
+
+/*!
+ * The message that is sent to all the dependent tasks when a task has
+ * finished. The dependent tasks which became ready are gathered in the
+ * message so that they can be added to the thread pool all at once.
+ */
+typedef struct task_notify_msg_t {
+    int status; /*!< The status from the finished task. */
+    task_t **ready; /*!< The dependent tasks which are ready to execute. */
+    unsigned int ready_size; /*!< The number of ready tasks. */
+    /*! The dependent tasks which have been skipped because the finished task
+     *  failed, their dependent tasks are notified afterwards. */
+    queue_t *skipped;
+    /*! The dependent targets which have been reached, their dependent tasks
+     *  are notified afterwards. */
+    queue_t *reached;
+} task_notify_msg_t;
+
+void task_notify(observer_t * observer, struct subject_t *from, void *msg);
+static void task_notify_any(task_t *this_ptr, task_notify_msg_t *msg);
+static void task_add_dependencies(task_t *this_ptr, char **names,
+                                  task_dependency_kind_t kind);
+static int task_run_process(task_t *this_ptr);
+static void task_finish(task_t *this_ptr, int status, bool admitted);
+static void task_set_skip_reason(task_t *this_ptr, const char *reason,
+                                 const char *dependency);
+static void task_set_skipped(task_t *this_ptr);
+static void task_set_reached(task_t *this_ptr);
+static void task_exited(void *task, int status);
+static unsigned long task_elapsed(const struct timespec *start);
+static void task_set_state(task_t *this_ptr, task_state_t state);
+static void task_arm_timeout(task_t *this_ptr, pid_t pid);
+static void task_timeout(timer_wheel_timer_t *timer);
+static task_t *task_find_dependency(task_dependency_t *dependency,
+                                    struct hash_lookup_t *lookup);
+
+/*!
+ * Creates a task which encapsulates a service.
+ * The reason for this is to make it possible to observe services and to track
+ * dependencies. A task can be both an observer and a subject since it uses
+ * C inheritance from the \c struct \c subject_t.
+ *
+ * \param service - A service that is going to be encapsulated into a task.
+ *
+ * \return A task which encapsulates a service.
+ */
+task_t * task_create(struct service_t *service, struct task_handler_t *handler)
+{
+    if (service->name != NULL) {
+        task_t * this_ptr = (task_t*) malloc(sizeof(task_t));
+
+        if (this_ptr != NULL) {
+            this_ptr->task_id = hash_generate(service->name);
+            this_ptr->dependency_queue = NULL;
+            this_ptr->service = service;
+            this_ptr->task_handler = handler;
+            this_ptr->counter = 0;
+            this_ptr->dependents = 0u;
+            this_ptr->group = NULL;
+            this_ptr->state = TASK_STATE_WAITING;
+            this_ptr->status = TASK_SUCCESS;
+            this_ptr->listen_fds = NULL;
+            this_ptr->listen_fds_size = 0u;
+            this_ptr->listening = false;
+            this_ptr->skip_reason = NULL;
+            this_ptr->pid = 0;
+            this_ptr->timed_out = false;
+            this_ptr->selected = false;
+            this_ptr->index = 0u;
+            this_ptr->any = false;
+            this_ptr->duration = 0u;
+            this_ptr->measured = false;
+            this_ptr->priority = 0u;
+            this_ptr->cost = 0u;
+            this_ptr->ready_time = 0u;
+            this_ptr->admit_time = 0u;
+            this_ptr->start_time = 0u;
+            this_ptr->end_time = 0u;
+            this_ptr->finished = false;
+            memset(&this_ptr->usage, 0, sizeof(process_usage_t));
+            this_ptr->reaped = false;
+            timer_wheel_timer_init(&this_ptr->timer, task_timeout, this_ptr);
+            subject_init((subject_t*) this_ptr);
+            observer_set_notify((observer_t*) this_ptr, task_notify);
+
+            /* Check if there is a provides string, if there isn't any provides
+             * string, use the task name instead for the generated id. */
+            if (service->provides != NULL) {
+                this_ptr->provides_id = hash_generate(service->provides);
+            } else {
+                this_ptr->provides_id = this_ptr->task_id;
+            }
+
+            task_add_dependencies(this_ptr, service->dependency,
+                                  TASK_DEPENDENCY_REQUIRES);
+            task_add_dependencies(this_ptr, service->wants,
+                                  TASK_DEPENDENCY_WANTS);
+            task_add_dependencies(this_ptr, service->after,
+                                  TASK_DEPENDENCY_AFTER);
+        }
+        return this_ptr;
+    }
+    return NULL;
+}
+
+/*!
+ * Adds a list of dependencies to a task.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param names - A \c NULL terminated list with the names of the
+ *                dependencies, it can be \c NULL.
+ * \param kind - The strength of the dependencies.
+ */
+static void task_add_dependencies(task_t *this_ptr, char **names,
+                                  task_dependency_kind_t kind)
+{
+    task_dependency_t *dependency;
+
+    if (names == NULL) {
+        return;
+    }
+    if (this_ptr->dependency_queue == NULL) {
+        this_ptr->dependency_queue = queue_create();
+    }
+
+    while (*names != NULL) {
+
+        printf("%s dep: %s\n", this_ptr->service->name, *names);
+        dependency = (task_dependency_t*) malloc(sizeof(task_dependency_t));
+
+        dependency->name = *names;
+        dependency->id = hash_generate(dependency->name);
+        dependency->task = NULL;
+        dependency->kind = kind;
+        dependency->removed = false;
+
+        queue_push(this_ptr->dependency_queue, dependency);
+
+        names++;
+    }
+}
+
+/*!
+ * Replaces the required dependencies of a task with a single required
+ * dependency, the other dependencies are kept.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param name - The name of the new dependency, it must be valid as long as
+ *               the task.
+ */
+void task_replace_requires(task_t *this_ptr, char *name)
+{
+    char *names[] = {name, NULL};
+    task_dependency_t *dependency;
+    queue_t kept;
+
+    queue_init(&kept);
+    if (this_ptr->dependency_queue != NULL) {
+        while ((dependency = queue_pop(this_ptr->dependency_queue)) != NULL) {
+            if (dependency->kind == TASK_DEPENDENCY_REQUIRES) {
+                free(dependency);
+            } else {
+                queue_push(&kept, dependency);
+            }
+        }
+        while ((dependency = queue_pop(&kept)) != NULL) {
+            queue_push(this_ptr->dependency_queue, dependency);
+        }
+    }
+    queue_deinit(&kept);
+
+    task_add_dependencies(this_ptr, names, TASK_DEPENDENCY_REQUIRES);
+}
+
+/*!
+ * Executes the action function from the service.
+ *
+ * \param task - A pointer to the task.
+ *
+ * \return TASK_SUCCESS if it was possible to execute the initialization
+ *         function or if it didn't exist. It returns a negative value if there
+ *         was an error detected during the execution of the initialization
+ *         function.
+ */
+int task_run_action(void *task)
+{
+    task_t *this_ptr = (task_t*) task;
+    service_t *service = this_ptr->service;
+    thread_pool_t *thread_pool;
+    process_class_t saved_class;
+    struct timespec start;
+    int status = TASK_SUCCESS;
+
+    this_ptr->start_time = task_handler_elapsed(this_ptr->task_handler);
+    stats_sample(STATS_READY_TO_DISPATCH,
+                 this_ptr->start_time - this_ptr->ready_time);
+    trace_record(this_ptr->task_handler->trace, TRACE_DISPATCHED,
+                 this_ptr->task_id);
+    printf("%s\n", this_ptr->service->name);
+    task_set_state(this_ptr, TASK_STATE_RUNNING);
+
+    if ((service->action != NULL) || (service->exec != NULL)) {
+        /* The worker does the work on behalf of the service, so it follows
+           the scheduling class of the service while doing it. */
+        process_class_enter(service, &saved_class);
+
+        /* The action is most likely waiting for a process or doing I/O, let
+           the thread pool start another thread in the meantime. */
+        thread_pool = this_ptr->task_handler->thread_pool_group->thread_pool;
+        thread_pool_block_begin(thread_pool);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (service->action != NULL) {
+            trace_record(this_ptr->task_handler->trace, TRACE_SPAWNED,
+                         this_ptr->task_id);
+            if (service->action() < 0) {
+                status = TASK_FAIL;
+            }
+        } else {
+            status = task_run_process(this_ptr);
+        }
+        thread_pool_block_end(thread_pool);
+
+        /* A service which is ready exits later, under the supervisor. */
+        if (task_get_state(this_ptr) != TASK_STATE_READY) {
+            trace_record(this_ptr->task_handler->trace, TRACE_EXITED,
+                         this_ptr->task_id);
+        }
+
+        /* Only the successful runs tell how long the service takes. */
+        if (status == TASK_SUCCESS) {
+            this_ptr->duration = task_elapsed(&start);
+            this_ptr->measured = true;
+        }
+
+        process_class_leave(&saved_class);
+    }
+
+    /* A task which is ready keeps running, the dependent tasks are released
+       anyway. */
+    this_ptr->status = status;
+    if (task_get_state(this_ptr) != TASK_STATE_READY) {
+        task_set_state(this_ptr, TASK_STATE_EXITED);
+    }
+
+    task_finish(this_ptr, status, true);
+
+    return status;
+}
+
+/*!
+ * Marks a task which can't be started, it should then be skipped with
+ * \c task_skip.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param reason - Describes why the task can't be started.
+ */
+void task_fail(task_t *this_ptr, const char *reason)
+{
+    task_set_skip_reason(this_ptr, "%s", reason);
+}
+
+/*!
+ * Skips a task which can't be started because a required dependency is
+ * missing, the tasks that require it are skipped as well.
+ *
+ * \param this_ptr - A pointer to the task.
+ */
+void task_skip(task_t *this_ptr)
+{
+    task_set_skipped(this_ptr);
+    task_finish(this_ptr, TASK_FAIL, false);
+}
+
+/*!
+ * Notifies the dependent tasks that a task has finished and starts the
+ * dependent tasks that are ready. If the task failed, all the tasks that
+ * require it are skipped at once, in a single pass over the part of the
+ * graph that can't be started. A skipped task is never given a thread or any
+ * resources.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param status - The status of the task.
+ * \param admitted - \c true if the task was admitted by the task handler and
+ *                   has resources that need to be released.
+ */
+static void task_finish(task_t *this_ptr, int status, bool admitted)
+{
+    task_handler_t *handler = this_ptr->task_handler;
+    task_notify_msg_t msg;
+    queue_t skipped;
+    queue_t reached;
+
+    queue_init(&skipped);
+    queue_init(&reached);
+    msg.skipped = &skipped;
+    msg.reached = &reached;
+
+    do {
+        msg.status = status;
+        msg.ready_size = 0u;
+        msg.ready = NULL;
+
+        if (this_ptr->dependents > 0u) {
+            msg.ready = (task_t**) malloc(sizeof(task_t*) *
+                                          this_ptr->dependents);
+        }
+        this_ptr->end_time = task_handler_elapsed(handler);
+        this_ptr->finished = true;
+        subject_notify((subject_t*) this_ptr, (void*) &msg);
+        trace_record(handler->trace, TRACE_NOTIFIED, this_ptr->task_id);
+
+        task_handler_run_finish(handler, admitted ? this_ptr : NULL,
+                                msg.ready, msg.ready_size);
+        free(msg.ready);
+
+        /* Continue with the dependent tasks that were skipped and then with
+           the targets that were reached. */
+        admitted = false;
+        status = TASK_FAIL;
+        this_ptr = queue_pop(&skipped);
+        if (this_ptr == NULL) {
+            status = TASK_SUCCESS;
+            this_ptr = queue_pop(&reached);
+            if (this_ptr != NULL) {
+                task_set_reached(this_ptr);
+            }
+        }
+    } while (this_ptr != NULL);
+}
+
+/*!
+ * Marks that a target has been reached.
+ */
+static void task_set_reached(task_t *this_ptr)
+{
+    printf("%s reached\n", this_ptr->service->name);
+    this_ptr->status = TASK_SUCCESS;
+    task_set_state(this_ptr, TASK_STATE_EXITED);
+}
+
+/*!
+ * Reaches a target which doesn't have any dependencies, a target never
+ * executes anything so it is done directly instead of in the thread pool.
+ *
+ * \param this_ptr - A pointer to the task.
+ */
+void task_reach(task_t *this_ptr)
+{
+    task_set_reached(this_ptr);
+    task_finish(this_ptr, TASK_SUCCESS, false);
+}
+
+/*!
+ * Checks if a task is a target.
+ *
+ * \param this_ptr - A pointer to the task.
+ *
+ * \return \c true if the task is a target, \c false otherwise.
+ */
+bool task_is_target(task_t *this_ptr)
+{
+    return this_ptr->service->type == SERVICE_TYPE_TARGET;
+}
+
+/*!
+ * Marks that a task can't be started, only the first reason is kept.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param reason - Describes why the task is skipped, "%s" is replaced with
+ *                 the name of the dependency.
+ * \param dependency - The name of the dependency.
+ */
+static void task_set_skip_reason(task_t *this_ptr, const char *reason,
+                                 const char *dependency)
+{
+    size_t length = strlen(reason) + strlen(dependency) + 1u;
+
+    this_ptr->status = TASK_FAIL;
+    if (this_ptr->skip_reason == NULL) {
+        this_ptr->skip_reason = malloc(length);
+        if (this_ptr->skip_reason != NULL) {
+            snprintf(this_ptr->skip_reason, length, reason, dependency);
+        }
+    }
+}
+
+/*!
+ * Marks a task as skipped.
+ *
+ * \param this_ptr - A pointer to the task.
+ */
+static void task_set_skipped(task_t *this_ptr)
+{
+    printf("%s skipped: %s\n", this_ptr->service->name,
+           (this_ptr->skip_reason != NULL) ? this_ptr->skip_reason : "");
+    task_set_state(this_ptr, TASK_STATE_SKIPPED);
+}
+
+/*!
+ * Executes the command of a service. A notify service is handed over to the
+ * supervisor as soon as it has reported that it is ready, otherwise the
+ * command is waited for until it exits. The command fails if it isn't ready
+ * or hasn't exited before its timeout.
+ *
+ * \param this_ptr - A pointer to the task.
+ *
+ * \return \c TASK_SUCCESS if the command is ready or exited successfully,
+ *         \c TASK_FAIL otherwise.
+ */
+static int task_run_process(task_t *this_ptr)
+{
+    timer_wheel_t *timer_wheel = this_ptr->task_handler->timer_wheel;
+    const char *run_dir = this_ptr->task_handler->run_dir;
+    int notify_fd = -1;
+    int ready = PROCESS_FAIL;
+    int status;
+    pid_t pid;
+
+    if (process_spawn(this_ptr->service, this_ptr->listen_fds,
+                      this_ptr->listen_fds_size, &pid, &notify_fd,
+                      &this_ptr->usage) != PROCESS_SUCCESS) {
+        return TASK_FAIL;
+    }
+    trace_record(this_ptr->task_handler->trace, TRACE_SPAWNED,
+                 this_ptr->task_id);
+    task_arm_timeout(this_ptr, pid);
+
+    if (notify_fd >= 0) {
+        ready = process_wait_ready(notify_fd);
+        close(notify_fd);
+    }
+
+    if (ready == PROCESS_READY) {
+        timer_wheel_cancel(timer_wheel, &this_ptr->timer);
+
+        if (this_ptr->timed_out) {
+            /* It is too late to be ready once the command is terminating. */
+            process_signal(pid, SIGKILL);
+        } else {
+            task_set_state(this_ptr, TASK_STATE_READY);
+            trace_record(this_ptr->task_handler->trace, TRACE_READINESS,
+                         this_ptr->task_id);
+
+            /* The pid file is written first so that it can't be written
+               after the process has exited and the file has been removed. */
+            if (run_dir != NULL) {
+                process_write_pid_file(run_dir, this_ptr->service->name, pid);
+            }
+            if (supervisor_add(this_ptr->task_handler->supervisor, pid,
+                               task_exited, this_ptr) == SUPERVISOR_SUCCESS) {
+                return TASK_SUCCESS;
+            }
+            if (run_dir != NULL) {
+                process_remove_pid_file(run_dir, this_ptr->service->name);
+            }
+        }
+    }
+
+    /* The process isn't reaped until the timer has been cancelled, otherwise
+       the timer could signal a reused process id. */
+    process_wait_exit(pid);
+    timer_wheel_cancel(timer_wheel, &this_ptr->timer);
+    if (this_ptr->timed_out) {
+        /* The shell may have died from the first signal while a process it
+           started ignores it, the group can't be reused until the shell has
+           been reaped. */
+        process_signal(pid, SIGKILL);
+    }
+
+    /* A notify service which didn't report that it is ready is treated as
+       being ready when it has exited. */
+    status = process_wait(pid, &this_ptr->usage);
+    this_ptr->reaped = true;
+    if ((status != PROCESS_SUCCESS) || this_ptr->timed_out) {
+        return TASK_FAIL;
+    }
+    return TASK_SUCCESS;
+}
+
+/*!
+ * Starts the timeout of a command, the timeout of the service is used if it
+ * is set and the default timeout of the task handler otherwise.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param pid - The process id of the command.
+ */
+static void task_arm_timeout(task_t *this_ptr, pid_t pid)
+{
+    task_handler_t *handler = this_ptr->task_handler;
+    unsigned int timeout = handler->timeout;
+
+    if (this_ptr->service->timeout != SERVICE_NOT_SET) {
+        timeout = (unsigned int) this_ptr->service->timeout;
+    }
+
+    if ((timeout > 0u) &&
+        (timer_wheel_start(handler->timer_wheel) == TIMER_WHEEL_SUCCESS)) {
+        this_ptr->pid = pid;
+        timer_wheel_add(handler->timer_wheel, &this_ptr->timer, timeout);
+    }
+}
+
+/*!
+ * Called by the timer wheel when a command has timed out. The command is
+ * first asked to terminate, and if it is still running after the kill
+ * timeout it is killed. The task fails when the command has exited, which
+ * skips the tasks that require it.
+ *
+ * \param timer - A pointer to the timer of the task.
+ */
+static void task_timeout(timer_wheel_timer_t *timer)
+{
+    task_t *this_ptr = (task_t*) timer->context;
+
+    if (!this_ptr->timed_out) {
+        printf("%s timed out\n", this_ptr->service->name);
+        this_ptr->timed_out = true;
+        process_signal(this_ptr->pid, SIGTERM);
+        timer_wheel_add(this_ptr->task_handler->timer_wheel, timer,
+                        TASK_KILL_TIMEOUT);
+    } else {
+        printf("%s killed after timeout\n", this_ptr->service->name);
+        process_signal(this_ptr->pid, SIGKILL);
+    }
+}
+
+/*!
+ * Gets the time in milliseconds since a point in time.
+ */
+static unsigned long task_elapsed(const struct timespec *start)
+{
+    struct timespec now;
+    long elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (long) (now.tv_sec - start->tv_sec) * 1000L +
+              (now.tv_nsec - start->tv_nsec) / 1000000L;
+    return (elapsed > 0) ? (unsigned long) elapsed : 0u;
+}
+
+/*!
+ * Called by the supervisor when a ready task has exited.
+ *
+ * \param task - A pointer to the task.
+ * \param status - The status from \c waitpid.
+ */
+static void task_exited(void *task, int status)
+{
+    task_t *this_ptr = (task_t*) task;
+
+    if (WIFSIGNALED(status)) {
+        printf("%s killed by signal %d\n", this_ptr->service->name,
+               WTERMSIG(status));
+    } else {
+        printf("%s exited with status %d\n", this_ptr->service->name,
+               WEXITSTATUS(status));
+    }
+    if (this_ptr->task_handler->run_dir != NULL) {
+        process_remove_pid_file(this_ptr->task_handler->run_dir,
+                                this_ptr->service->name);
+    }
+    trace_record(this_ptr->task_handler->trace, TRACE_EXITED,
+                 this_ptr->task_id);
+    task_set_state(this_ptr, TASK_STATE_EXITED);
+}
+
+/*!
+ * Sets the state of a task, the state can be read from other threads.
+ */
+static void task_set_state(task_t *this_ptr, task_state_t state)
+{
+    __atomic_store_n(&this_ptr->state, state, __ATOMIC_RELEASE);
+}
+
+/*!
+ * Gets the state of a task.
+ *
+ * \param this_ptr - A pointer to the task.
+ *
+ * \return The current state of the task.
+ */
+task_state_t task_get_state(task_t *this_ptr)
+{
+    return __atomic_load_n(&this_ptr->state, __ATOMIC_ACQUIRE);
+}
+
+/*!
+ * Gets the task id.
+ *
+ * \param this_ptr - A pointer to the task.
+ *
+ * \return The task id.
+ */
+unsigned int task_get_id(task_t *this_ptr)
+{
+    return this_ptr->task_id;
+}
+
+/*!
+ * Gets the task provides id.
+ *
+ * \param this_ptr - A pointer to the task.
+ *
+ * \return The task provides id.
+ */
+unsigned int task_get_provides_id(task_t *this_ptr)
+{
+    return this_ptr->provides_id;
+}
+
+/*!
+ * Creates the listening sockets of the task, this is done before any task is
+ * started so that the sockets are available for the dependent tasks.
+ *
+ * \param this_ptr - A pointer to the task.
+ *
+ * \return The number of listening sockets.
+ */
+int task_open_listeners(task_t *this_ptr)
+{
+    char **address = this_ptr->service->listen;
+    unsigned int size = 0u;
+    int fd;
+
+    if (address == NULL) {
+        return 0;
+    }
+
+    while (address[size] != NULL) {
+        size++;
+    }
+    this_ptr->listen_fds = (int*) malloc(sizeof(int) * size);
+    if (this_ptr->listen_fds == NULL) {
+        return 0;
+    }
+
+    for (; *address != NULL; address++) {
+        fd = listener_open(*address);
+        if (fd != LISTENER_FAIL) {
+            this_ptr->listen_fds[this_ptr->listen_fds_size] = fd;
+            this_ptr->listen_fds_size++;
+        } else {
+            printf("%s: Unable to listen on %s.\n", this_ptr->service->name,
+                   *address);
+        }
+    }
+    this_ptr->listening = (this_ptr->listen_fds_size > 0u);
+    return (int) this_ptr->listen_fds_size;
+}
+
+/*!
+ * Builds the dependency by using the observer pattern. All the dependencies are
+ * observed.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param lookup - A lookup table which contains all the tasks..
+ *
+ * \return The number of dependencies that the task needs to wait for, the
+ *         task is ready to execute when it is zero. If a required dependency
+ *         is missing, the status of the task is \c TASK_FAIL and it should
+ *         be skipped with \c task_skip.
+ */
+int task_build_dependency(task_t *this_ptr, struct hash_lookup_t *lookup)
+{
+    if (this_ptr->dependency_queue != NULL) {
+        task_dependency_t *dependency;
+        task_t *task;
+
+        queue_first(this_ptr->dependency_queue);
+        while ((dependency = queue_get_current(this_ptr->dependency_queue)) !=
+                NULL) {
+
+            task = task_find_dependency(dependency, lookup);
+
+            if ((task != NULL) && !dependency->removed) {
+                dependency->task = task;
+                this_ptr->counter++;
+                task->dependents++;
+                subject_attach((subject_t*) task, (observer_t*) this_ptr);
+
+            } else if ((task == NULL) &&
+                       (hash_lookup_find(lookup, dependency->id) == NULL) &&
+                       (dependency->kind == TASK_DEPENDENCY_REQUIRES)) {
+                task_set_skip_reason(this_ptr,
+                                     "required dependency %s is missing",
+                                     dependency->name);
+            }
+            queue_next(this_ptr->dependency_queue);
+        }
+    }
+
+    return this_ptr->counter;
+}
+
+/*!
+ * Adds the dependencies of a task to a dependency graph, in the same order
+ * as \c task_remove_graph_edges checks them.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param graph - The graph, the nodes are the indexes of the tasks.
+ * \param lookup - A lookup table with all the tasks.
+ */
+void task_add_graph_edges(task_t *this_ptr, struct task_graph_t *graph,
+                          struct hash_lookup_t *lookup)
+{
+    task_dependency_t *dependency;
+    task_t *task;
+
+    queue_first(this_ptr->dependency_queue);
+    while ((dependency = queue_get_current(this_ptr->dependency_queue)) !=
+           NULL) {
+        task = task_find_dependency(dependency, lookup);
+        if (task != NULL) {
+            task_graph_add_edge(graph, this_ptr->index, task->index,
+                               dependency->kind == TASK_DEPENDENCY_REQUIRES);
+        }
+        queue_next(this_ptr->dependency_queue);
+    }
+}
+
+/*!
+ * Removes the dependencies of a task that have been removed from a
+ * dependency graph, they are then never built.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param graph - The graph that the dependencies were added to.
+ * \param lookup - A lookup table with all the tasks.
+ * \param edge - The number of the first edge of the task in the graph.
+ *
+ * \return The number of the first edge of the next task.
+ */
+unsigned int task_remove_graph_edges(task_t *this_ptr,
+                                     struct task_graph_t *graph,
+                                     struct hash_lookup_t *lookup,
+                                     unsigned int edge)
+{
+    task_dependency_t *dependency;
+
+    queue_first(this_ptr->dependency_queue);
+    while ((dependency = queue_get_current(this_ptr->dependency_queue)) !=
+           NULL) {
+        if (task_find_dependency(dependency, lookup) != NULL) {
+            dependency->removed = task_graph_is_removed(graph, edge);
+            edge++;
+        }
+        queue_next(this_ptr->dependency_queue);
+    }
+    return edge;
+}
+
+/*!
+ * Finds the task of a dependency that has to be waited for.
+ *
+ * \return The task, \c NULL if the dependency is missing or if there isn't
+ *         any need to wait for it.
+ */
+static task_t *task_find_dependency(task_dependency_t *dependency,
+                                    struct hash_lookup_t *lookup)
+{
+    task_t *task = hash_lookup_find(lookup, dependency->id);
+
+    /* The sockets of a task are already listening, so there is no need to
+       wait for the task itself. */
+    if ((task != NULL) && task->listening) {
+        return NULL;
+    }
+    return task;
+}
+
+/*!
+ * Frees all the memory that was allocated during the creation and
+ * deinitializes the task.
+ *
+ * \param this_ptr - A pointer to the task.
+ */
+void task_destroy(task_t *this_ptr)
+{
+    unsigned int i;
+
+    if (this_ptr != NULL) {
+        for (i = 0u; i < this_ptr->listen_fds_size; i++) {
+            close(this_ptr->listen_fds[i]);
+        }
+        free(this_ptr->listen_fds);
+        free(this_ptr->skip_reason);
+
+        if (this_ptr->dependency_queue != NULL) {
+            task_dependency_t *dependency;
+
+            while ((dependency = queue_pop(this_ptr->dependency_queue)) !=
+                    NULL) {
+
+                free(dependency);
+            }
+            queue_destroy(this_ptr->dependency_queue);
+        }
+
+
+        subject_deinit((subject_t*) this_ptr);
+        free(this_ptr);
+    }
+}
+
+/*!
+ * Notifies the task that something has happened in one of the dependencies.
+ *
+ * \param observer - A pointer to the task when it acts as an observer.
+ * \param from - The subject that sends the notify message.
+ * \param msg - The actually message.
+ */
+void task_notify(observer_t * observer, struct subject_t *from, void *msg)
+{
+    task_t *this_ptr = (task_t*) observer;
+    task_notify_msg_t *notify_msg = (task_notify_msg_t*) msg;
+    task_dependency_t *dependency;
+
+    if (this_ptr->any) {
+        task_notify_any(this_ptr, notify_msg);
+        return;
+    }
+
+    /* The task is skipped at once if a required dependency has failed, the
+       other dependencies are only used for ordering. */
+    if ((notify_msg->status == TASK_FAIL) &&
+        (task_get_state(this_ptr) != TASK_STATE_SKIPPED)) {
+
+        queue_first(this_ptr->dependency_queue);
+        while ((dependency = queue_get_current(this_ptr->dependency_queue)) !=
+                NULL) {
+
+            if ((dependency->task == (task_t*) from) &&
+                (dependency->kind == TASK_DEPENDENCY_REQUIRES)) {
+
+                /* A target never fails by itself, so the reason from the
+                   target is more useful. */
+                if (task_is_target((task_t*) from) &&
+                    (((task_t*) from)->skip_reason != NULL)) {
+                    task_set_skip_reason(this_ptr, "%s",
+                                         ((task_t*) from)->skip_reason);
+                } else {
+                    task_set_skip_reason(this_ptr,
+                                         "required dependency %s failed",
+                                         ((task_t*) from)->service->name);
+                }
+                task_set_skipped(this_ptr);
+                queue_push(notify_msg->skipped, this_ptr);
+                break;
+            }
+            queue_next(this_ptr->dependency_queue);
+        }
+    }
+
+    this_ptr->counter--;
+
+    /* A skipped task is never started and a target is reached without being
+       started. */
+    if ((this_ptr->counter == 0) &&
+        (task_get_state(this_ptr) != TASK_STATE_SKIPPED)) {
+        if (task_is_target(this_ptr)) {
+            queue_push(notify_msg->reached, this_ptr);
+        } else if (notify_msg->ready != NULL) {
+            /* Let the finished task add all the ready tasks at once. */
+            notify_msg->ready[notify_msg->ready_size] = this_ptr;
+            notify_msg->ready_size++;
+        } else {
+            task_handler_run_add_task(this_ptr->task_handler, this_ptr);
+        }
+    }
+}
+
+/*!
+ * Handles a finished dependency of a task which is reached by the first
+ * dependency that is ready. The task is only skipped when all of its
+ * dependencies have failed.
+ *
+ * \param this_ptr - A pointer to the task.
+ * \param msg - The message from the finished dependency.
+ */
+static void task_notify_any(task_t *this_ptr, task_notify_msg_t *msg)
+{
+    this_ptr->counter--;
+
+    if (task_get_state(this_ptr) != TASK_STATE_WAITING) {
+        return;
+    }
+
+    if (msg->status == TASK_SUCCESS) {
+        /* The state keeps the later dependencies from reaching the task
+           again before it has been reached. */
+        task_set_state(this_ptr, TASK_STATE_RUNNING);
+        queue_push(msg->reached, this_ptr);
+
+    } else if (this_ptr->counter == 0) {
+        task_set_skip_reason(this_ptr, "no provider of %s is ready",
+                             this_ptr->service->name);
+        task_set_skipped(this_ptr);
+        queue_push(msg->skipped, this_ptr);
+    }
+}
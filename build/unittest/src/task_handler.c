@@ -0,0 +1,2059 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "task_handler.h"
+#include "hash.h"
+#include "hash_lookup.h"
+#include "core_type.h"
+#include "observer.h"
+#include "pressure.h"
+#include "process.h"
+#include "queue.h"
+#include "shutdown.h"
+#include "subject.h"
+#include "supervisor.h"
+#include "task_graph.h"
+#include "timer_wheel.h"
+#include "task.h"
+#include "thread_pool.h"
+#include "timing_db.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*! The resolution of the timeouts in milliseconds. */
+#define TASK_HANDLER_TIMER_RESOLUTION 10u
+/*! The maximum length of the name of a target created when collapsing. */
+#define TASK_HANDLER_COLLAPSE_NAME 32
+/*! The default time in milliseconds that a service gets to exit when it is
+ *  stopped before it is killed. */
+#define TASK_HANDLER_STOP_TIMEOUT 5000u
+
+/*!
+ * The tasks which require exactly the same set of tasks.
+ */
+typedef struct task_handler_collapse_t {
+    unsigned int key; /*!< The hash of the ids. */
+    /*! The sorted ids of the required tasks. */
+    unsigned int *ids;
+    unsigned int ids_size; /*!< The number of required tasks. */
+    /*! The names of the required tasks, from the first task in the set. */
+    char **names;
+    queue_t tasks; /*!< The tasks which require the set. */
+    unsigned int tasks_size; /*!< The number of tasks. */
+} task_handler_collapse_t;
+
+static task_handler_group_t *task_handler_find_group(task_handler_t *this_ptr,
+                                                     const char *name);
+static unsigned int task_handler_add_providers(task_handler_t *this_ptr,
+                                               queue_t *providers,
+                                               unsigned int tasks_size);
+static unsigned int task_handler_elect_provider(task_handler_t *this_ptr,
+                                                service_t *service,
+                                                unsigned int tasks_size);
+static void task_handler_drop_task(task_handler_t *this_ptr, task_t *task,
+                                   unsigned int tasks_size);
+static char **task_handler_add_name(char **names, char *name);
+static bool task_handler_get_estimate(task_handler_t *this_ptr, task_t *task,
+                                      unsigned long *estimate);
+static void task_handler_prioritize(task_handler_t *this_ptr,
+                                    task_graph_t *graph, task_t **tasks);
+static void task_handler_record_timings(task_handler_t *this_ptr);
+static void task_handler_dispatch(task_handler_t *this_ptr, task_t **tasks,
+                                  unsigned int tasks_size);
+static unsigned int task_handler_get_io(task_handler_t *this_ptr,
+                                        task_t *task);
+static unsigned long task_handler_get_mem(task_handler_t *this_ptr,
+                                          task_t *task);
+static unsigned int task_handler_select_targets(task_handler_t *this_ptr,
+                                                unsigned int tasks_size);
+static void task_handler_select(task_handler_t *this_ptr, char **names,
+                                task_t **stack, unsigned int *stack_size);
+static unsigned int task_handler_collapse(task_handler_t *this_ptr,
+                                          unsigned int tasks_size);
+static unsigned int *task_handler_get_requires(task_t *task,
+                                               unsigned int *size);
+static bool task_handler_add_collapsed(task_handler_t *this_ptr,
+                                       task_handler_collapse_t *set);
+static void task_handler_check_graph(task_handler_t *this_ptr,
+                                     unsigned int tasks_size);
+static void task_handler_break_cycles(task_handler_t *this_ptr,
+                                      task_graph_t *graph, task_t **tasks);
+static unsigned int task_handler_find_cycles(task_graph_t *graph,
+                                             task_t **tasks,
+                                             unsigned int *component,
+                                             unsigned int *cycle);
+static void task_handler_print_task(task_t *task);
+static void task_handler_conflict(task_t *task, task_t *other,
+                                  const char *conflict);
+static task_t **task_handler_query(task_handler_t *this_ptr,
+                                   const char *name, bool dependents);
+static task_graph_closure_t *task_handler_get_closure(
+        task_handler_t *this_ptr);
+static void task_handler_stopped(void *context, unsigned int node,
+                                 shutdown_result_t result);
+
+task_handler_t * task_handler_create(thread_pool_t *thread_pool)
+{
+    task_handler_t *this_ptr = (task_handler_t*) malloc(sizeof(task_handler_t));
+
+    if (this_ptr != NULL) {
+        if (task_handler_init(this_ptr, thread_pool) != TASK_HANDLER_SUCCESS) {
+            free(this_ptr);
+            this_ptr = NULL;
+        }
+    }
+    return this_ptr;
+}
+
+int task_handler_init(task_handler_t * this_ptr, thread_pool_t *thread_pool)
+{
+    this_ptr->task_lookup = hash_lookup_create(64);
+    this_ptr->tasks = queue_create();
+    this_ptr->thread_pool_group = thread_pool_group_create(thread_pool,
+                                                           task_run_action);
+    this_ptr->groups = queue_create();
+    this_ptr->pending = queue_create();
+    this_ptr->admission_control = false;
+    this_ptr->pending_size = 0u;
+    this_ptr->io_budget = 0u;
+    this_ptr->io_used = 0u;
+    this_ptr->mem_budget = 0u;
+    this_ptr->mem_used = 0u;
+    this_ptr->pressure = NULL;
+    this_ptr->running = 0u;
+    this_ptr->supervisor = supervisor_create();
+    this_ptr->timer_wheel = timer_wheel_create(TASK_HANDLER_TIMER_RESOLUTION);
+    this_ptr->timeout = 0u;
+    this_ptr->targets = NULL;
+    this_ptr->collapse = false;
+    this_ptr->reduce = false;
+    this_ptr->cycle = TASK_HANDLER_CYCLE_WEAK;
+    this_ptr->dry_run = false;
+    this_ptr->simulate = false;
+    this_ptr->graph = NULL;
+    this_ptr->nodes = NULL;
+    this_ptr->closure = NULL;
+    this_ptr->run_dir = NULL;
+    this_ptr->stop_timeout = TASK_HANDLER_STOP_TIMEOUT;
+    this_ptr->timing_db = NULL;
+    this_ptr->fastest_provider = false;
+    this_ptr->trace = NULL;
+    this_ptr->trace_path = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &this_ptr->start);
+    this_ptr->collapsed = queue_create();
+    this_ptr->providers = queue_create();
+    pthread_mutex_init(&this_ptr->mutex, NULL);
+
+    if ((this_ptr->task_lookup == NULL) || (this_ptr->tasks == NULL) ||
+        (this_ptr->thread_pool_group == NULL) || (this_ptr->groups == NULL) ||
+        (this_ptr->pending == NULL) || (this_ptr->supervisor == NULL) ||
+        (this_ptr->timer_wheel == NULL) || (this_ptr->collapsed == NULL) ||
+        (this_ptr->providers == NULL)) {
+        task_handler_deinit(this_ptr);
+        return TASK_HANDLER_FAIL;
+    }
+
+    return TASK_HANDLER_SUCCESS;
+}
+
+/*!
+ * Limits the number of tasks in a concurrency group that are running at the
+ * same time.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param group - The name of the group.
+ * \param limit - The maximum number of running tasks, must be at least 1.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the limit was set,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_set_group_limit(task_handler_t *this_ptr, const char *group,
+                                 unsigned int limit)
+{
+    task_handler_group_t *handler_group;
+    int status = TASK_HANDLER_SUCCESS;
+
+    if (limit == 0u) {
+        return TASK_HANDLER_FAIL;
+    }
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    handler_group = task_handler_find_group(this_ptr, group);
+
+    if (handler_group == NULL) {
+        handler_group = malloc(sizeof(task_handler_group_t));
+
+        if (handler_group != NULL) {
+            handler_group->id = hash_generate(group);
+            handler_group->running = 0u;
+            queue_push(this_ptr->groups, handler_group);
+        } else {
+            status = TASK_HANDLER_FAIL;
+        }
+    }
+
+    if (handler_group != NULL) {
+        handler_group->limit = limit;
+        this_ptr->admission_control = true;
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    return status;
+}
+
+/*!
+ * Sets the number of I/O tokens that the running tasks can use together.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param io - The number of I/O tokens, 0 if it is unlimited.
+ */
+void task_handler_set_io_budget(task_handler_t *this_ptr, unsigned int io)
+{
+    pthread_mutex_lock(&this_ptr->mutex);
+    this_ptr->io_budget = io;
+    this_ptr->admission_control = this_ptr->admission_control || (io > 0u);
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Sets the amount of memory that the running tasks can use together.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param mem - The memory in kilobytes, 0 if it is unlimited.
+ */
+void task_handler_set_mem_budget(task_handler_t *this_ptr, unsigned long mem)
+{
+    pthread_mutex_lock(&this_ptr->mutex);
+    this_ptr->mem_budget = mem;
+    this_ptr->admission_control = this_ptr->admission_control || (mem > 0u);
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Sets the timeout of the services which don't have their own timeout.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param timeout - The timeout in milliseconds, 0 if there isn't any
+ *                  timeout.
+ */
+void task_handler_set_timeout(task_handler_t *this_ptr, unsigned int timeout)
+{
+    this_ptr->timeout = timeout;
+}
+
+/*!
+ * Adds a target, only the targets and the tasks that they require or want
+ * are started. All the tasks are started if there aren't any targets.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param name - The name of the target task.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the target was added,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_add_target(task_handler_t *this_ptr, const char *name)
+{
+    char *target;
+
+    if (this_ptr->targets == NULL) {
+        this_ptr->targets = queue_create();
+        if (this_ptr->targets == NULL) {
+            return TASK_HANDLER_FAIL;
+        }
+    }
+
+    target = strdup(name);
+    if ((target == NULL) ||
+        (queue_push(this_ptr->targets, target) != QUEUE_SUCESS)) {
+        free(target);
+        return TASK_HANDLER_FAIL;
+    }
+    return TASK_HANDLER_SUCCESS;
+}
+
+/*!
+ * Enables or disables the collapsing of dependencies. When it is enabled,
+ * tasks which require the same set of tasks are instead made to require a
+ * target which requires the set. N tasks which require the same M tasks then
+ * need N + M dependencies instead of N * M.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param collapse - \c true if the dependencies should be collapsed.
+ */
+void task_handler_set_collapse(task_handler_t *this_ptr, bool collapse)
+{
+    this_ptr->collapse = collapse;
+}
+
+/*!
+ * Enables or disables the removal of the dependencies which are implied by
+ * other dependencies, only the necessary dependencies are then built.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param reduce - \c true if the implied dependencies should be removed.
+ */
+void task_handler_set_reduce(task_handler_t *this_ptr, bool reduce)
+{
+    this_ptr->reduce = reduce;
+}
+
+/*!
+ * Sets how the dependency cycles are broken. A task in a cycle would
+ * otherwise wait for itself forever.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param cycle - The policy for breaking the cycles.
+ */
+void task_handler_set_cycle(task_handler_t *this_ptr,
+                            task_handler_cycle_t cycle)
+{
+    this_ptr->cycle = cycle;
+}
+
+/*!
+ * Enables or disables the dry run. During a dry run the dependencies are
+ * only calculated and checked, so that the dependency graph can be queried,
+ * but no task is started and no socket is opened.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param dry_run - \c true if nothing should be started.
+ */
+void task_handler_set_dry_run(task_handler_t *this_ptr, bool dry_run)
+{
+    this_ptr->dry_run = dry_run;
+}
+
+/*!
+ * Enables or disables the calculation of the dependencies for a simulated
+ * boot. A real boot doesn't wait for a task whose sockets are listening,
+ * during a dry run no socket is opened so the tasks with sockets are
+ * assumed to be listening instead. Otherwise the simulated boot would wait
+ * for them. The dependency graph of a dry run that stops the services or
+ * is queried keeps those dependencies.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param simulate - \c true if the dependencies are for a simulated boot.
+ */
+void task_handler_set_simulate(task_handler_t *this_ptr, bool simulate)
+{
+    this_ptr->simulate = simulate;
+}
+
+/*!
+ * Sets the directory where the process ids of the running services are
+ * written, "speedy stop" reads them from there.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param run_dir - The directory.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the directory was set,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_set_run_dir(task_handler_t *this_ptr, const char *run_dir)
+{
+    char *copy = strdup(run_dir);
+
+    if (copy == NULL) {
+        return TASK_HANDLER_FAIL;
+    }
+    free(this_ptr->run_dir);
+    this_ptr->run_dir = copy;
+    return TASK_HANDLER_SUCCESS;
+}
+
+/*!
+ * Sets the default time that a service gets to exit after SIGTERM when it is
+ * stopped, it is killed if it is still running after that.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param timeout - The time in milliseconds.
+ */
+void task_handler_set_stop_timeout(task_handler_t *this_ptr,
+                                   unsigned int timeout)
+{
+    this_ptr->stop_timeout = timeout;
+}
+
+/*!
+ * Sets the file where the durations of the tasks are kept between the
+ * boots. The durations from the earlier boots decide which tasks are started
+ * first, and the durations of this boot are written when all the tasks have
+ * finished.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param path - The file of the timing database.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the database was opened,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_set_timing_db(task_handler_t *this_ptr, const char *path)
+{
+    timing_db_t *timing_db = timing_db_create(path);
+
+    if (timing_db == NULL) {
+        return TASK_HANDLER_FAIL;
+    }
+    if (this_ptr->timing_db != NULL) {
+        timing_db_destroy(this_ptr->timing_db);
+    }
+    this_ptr->timing_db = timing_db;
+    return TASK_HANDLER_SUCCESS;
+}
+
+/*!
+ * Sets the file where the state transitions of the tasks are written as a
+ * Chrome trace when all the tasks have finished. The transitions are
+ * recorded from now on, so it is set before the configuration is read. The
+ * changes of the pressure limit are recorded in the same trace.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param path - The file of the trace.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the trace was started,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_set_trace(task_handler_t *this_ptr, const char *path)
+{
+    char *trace_path = strdup(path);
+    trace_t *trace = trace_create(TRACE_BUFFER_SIZE);
+
+    if ((trace_path == NULL) || (trace == NULL)) {
+        free(trace_path);
+        trace_destroy(trace);
+        return TASK_HANDLER_FAIL;
+    }
+    free(this_ptr->trace_path);
+    trace_destroy(this_ptr->trace);
+    this_ptr->trace_path = trace_path;
+    this_ptr->trace = trace;
+    if (this_ptr->pressure != NULL) {
+        this_ptr->pressure->trace = trace;
+    }
+    return TASK_HANDLER_SUCCESS;
+}
+
+/*!
+ * Sets if only the provider which is expected to be ready first is started
+ * when several tasks provide the same name. The expectation comes from the
+ * timing database, all the providers are started until each of them has a
+ * recorded duration.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param fastest - \c true if only the fastest provider should be started.
+ */
+void task_handler_set_fastest_provider(task_handler_t *this_ptr,
+                                       bool fastest)
+{
+    this_ptr->fastest_provider = fastest;
+}
+
+/*!
+ * Sets the pressure threshold of a resource, fewer tasks are admitted while
+ * the pressure of the resource is above the threshold.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param resource - The name of the resource, "cpu", "io" or "memory".
+ * \param threshold - The threshold in percent.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the threshold was set,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_set_pressure_threshold(task_handler_t *this_ptr,
+                                        const char *resource,
+                                        double threshold)
+{
+    int status = TASK_HANDLER_FAIL;
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    if (this_ptr->pressure == NULL) {
+        this_ptr->pressure = pressure_create();
+        if (this_ptr->pressure != NULL) {
+            this_ptr->pressure->trace = this_ptr->trace;
+        }
+    }
+    if ((this_ptr->pressure != NULL) &&
+        (pressure_set_threshold(this_ptr->pressure, resource,
+                                threshold) == PRESSURE_SUCCESS)) {
+
+        this_ptr->admission_control = true;
+        status = TASK_HANDLER_SUCCESS;
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    return status;
+}
+
+int task_handler_add_task(task_handler_t * this_ptr,struct service_t *service)
+{
+    task_t *task = task_create(service, this_ptr);
+
+    if (task != NULL) {
+        if (queue_push(this_ptr->tasks, task) != QUEUE_ERROR) {
+            trace_record(this_ptr->trace, TRACE_PARSED, task_get_id(task));
+        } else {
+            task_destroy(task);
+            return TASK_HANDLER_FAIL;
+        }
+    }
+    return TASK_HANDLER_SUCCESS;
+}
+
+int task_handler_add_tasks(task_handler_t * this_ptr,
+        struct service_t *services, unsigned int services_size)
+{
+    task_t *task = NULL;
+    unsigned int tasks = 0;
+    unsigned int i;
+
+    for (i = 0; i < services_size; i++) {
+        task = task_create(&services[i], this_ptr);
+
+        if (task != NULL) {
+            if (queue_push(this_ptr->tasks, task) != QUEUE_ERROR) {
+                tasks++;
+            } else {
+                task_destroy(task);
+            }
+        }
+    }
+    if (tasks != services_size) {
+        return TASK_HANDLER_FAIL;
+    }
+    return TASK_HANDLER_SUCCESS;
+}
+
+int task_handler_calculate_dependency(task_handler_t * this_ptr)
+{
+    unsigned int provides_id;
+    unsigned int task_id;
+    unsigned int tasks_size = 0u;
+    unsigned int ready_size = 0u;
+    unsigned int targets_size = 0u;
+    task_t **ready;
+    task_t *task;
+    task_t *other;
+    queue_t providers;
+    unsigned int i;
+    int status;
+
+    clock_gettime(CLOCK_MONOTONIC, &this_ptr->start);
+
+    /* Build up the task lookup table. The names of the tasks are added
+       before the provided names so that a clash between them is found
+       whatever order the tasks are declared in. */
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        task_id = task_get_id(task);
+
+        if (hash_lookup_insert(this_ptr->task_lookup, task_id, task) ==
+            HASH_LOOKUP_MULTIPLE_KEY_ERROR) {
+            task_handler_conflict(task, hash_lookup_find(this_ptr->task_lookup,
+                                                         task_id),
+                                  "has the same name as");
+        }
+        tasks_size++;
+        queue_next(this_ptr->tasks);
+    }
+
+    /* The tasks which provide a name that another task already provides are
+       gathered. */
+    queue_init(&providers);
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        provides_id = task_get_provides_id(task);
+
+        if (provides_id != task_get_id(task)) {
+            other = hash_lookup_find(this_ptr->task_lookup, provides_id);
+            if ((other != NULL) && (task_get_id(other) == provides_id)) {
+                task_handler_conflict(task, other, "provides the name of");
+            } else if (hash_lookup_insert(this_ptr->task_lookup, provides_id,
+                                          task) ==
+                       HASH_LOOKUP_MULTIPLE_KEY_ERROR) {
+                queue_push(&providers, task);
+            }
+        }
+        queue_next(this_ptr->tasks);
+    }
+    tasks_size = task_handler_add_providers(this_ptr, &providers, tasks_size);
+    queue_deinit(&providers);
+
+    if (this_ptr->targets != NULL) {
+        tasks_size = task_handler_select_targets(this_ptr, tasks_size);
+    }
+    if (this_ptr->collapse) {
+        tasks_size = task_handler_collapse(this_ptr, tasks_size);
+    }
+
+    /* Resolve the groups and create all the listening sockets before any task
+       is started. */
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        if (task->service->group != NULL) {
+            task->group = task_handler_find_group(this_ptr,
+                                                  task->service->group);
+        }
+        if (!this_ptr->dry_run) {
+            task_open_listeners(task);
+        } else if (this_ptr->simulate) {
+            task->listening = (task->service->listen != NULL);
+        }
+        queue_next(this_ptr->tasks);
+    }
+
+    task_handler_check_graph(this_ptr, tasks_size);
+    if (this_ptr->dry_run) {
+        return TASK_HANDLER_SUCCESS;
+    }
+
+    ready = (task_t**) malloc(sizeof(task_t*) * (tasks_size + 1u));
+    if (ready == NULL) {
+        return TASK_HANDLER_FAIL;
+    }
+
+    /* Use the lookup table to connect all the dependencies for the tasks. The
+       tasks without dependencies are not started until the whole dependency
+       tree has been built. */
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        status = task_build_dependency(task, this_ptr->task_lookup);
+        trace_record(this_ptr->trace, TRACE_WIRED, task_get_id(task));
+        if ((status == 0) && (task->status == TASK_SUCCESS)) {
+            /* The targets are gathered from the end of the array. */
+            if (task_is_target(task)) {
+                targets_size++;
+                ready[tasks_size - targets_size] = task;
+            } else {
+                ready[ready_size] = task;
+                ready_size++;
+            }
+        }
+        queue_next(this_ptr->tasks);
+    }
+
+    /* Skip the tasks with missing required dependencies and everything that
+       requires them before anything is started. */
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        if ((task->status == TASK_FAIL) &&
+            (task_get_state(task) != TASK_STATE_SKIPPED)) {
+            task_skip(task);
+        }
+        queue_next(this_ptr->tasks);
+    }
+
+    /* The targets without dependencies are reached at once. */
+    for (i = tasks_size - targets_size; i < tasks_size; i++) {
+        task_reach(ready[i]);
+    }
+
+    task_handler_run_add_tasks(this_ptr, ready, ready_size);
+    free(ready);
+
+    return TASK_HANDLER_SUCCESS;
+}
+
+int task_handler_wait(task_handler_t * this_ptr)
+{
+    thread_pool_group_wait(this_ptr->thread_pool_group);
+
+    if (this_ptr->timing_db != NULL) {
+        task_handler_record_timings(this_ptr);
+    }
+    if ((this_ptr->trace != NULL) &&
+        (trace_write(this_ptr->trace, this_ptr->trace_path, this_ptr->graph,
+                     this_ptr->nodes) != TRACE_SUCCESS)) {
+        printf("Could not write the trace %s\n", this_ptr->trace_path);
+    }
+    return 0;
+}
+
+/*!
+ * Reports the tasks which failed and the tasks which were skipped.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ *
+ * \return The number of failed and skipped tasks.
+ */
+unsigned int task_handler_report(task_handler_t *this_ptr)
+{
+    unsigned int failed = 0u;
+    task_t *task;
+
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        if (task_get_state(task) == TASK_STATE_SKIPPED) {
+            printf("Skipped: %s (%s)\n", task->service->name,
+                   (task->skip_reason != NULL) ? task->skip_reason : "");
+            failed++;
+
+        } else if (task->status == TASK_FAIL) {
+            printf("Failed: %s%s\n", task->service->name,
+                   task->timed_out ? " (timed out)" : "");
+            failed++;
+        }
+        queue_next(this_ptr->tasks);
+    }
+    return failed;
+}
+
+/*!
+ * Waits until all the tasks which kept running after they became ready have
+ * exited.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ */
+void task_handler_supervise(task_handler_t *this_ptr)
+{
+    supervisor_wait(this_ptr->supervisor);
+}
+
+/*!
+ * Stops the running services in reverse dependency order, a service is
+ * stopped as soon as all the services that depend on it are down. The
+ * dependencies must have been calculated during a dry run, the process ids
+ * of the services are read from the pid files in the run directory.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if all the services were stopped,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_handler_stop(task_handler_t *this_ptr)
+{
+    shutdown_t *shutdown;
+    service_t *service;
+    unsigned int timeout;
+    unsigned int i;
+    int status;
+
+    if (this_ptr->run_dir == NULL) {
+        printf("No rundir is set, the running services are unknown\n");
+        return TASK_HANDLER_FAIL;
+    }
+    if ((this_ptr->graph == NULL) ||
+        ((shutdown = shutdown_create(this_ptr->graph)) == NULL)) {
+        return TASK_HANDLER_FAIL;
+    }
+
+    for (i = 0u; i < this_ptr->graph->nodes_size; i++) {
+        service = this_ptr->nodes[i]->service;
+        timeout = this_ptr->stop_timeout;
+
+        if (service->stop_timeout != SERVICE_NOT_SET) {
+            timeout = (unsigned int) service->stop_timeout;
+        }
+        shutdown_set_process(shutdown, i,
+                             process_read_pid_file(this_ptr->run_dir,
+                                                   service->name),
+                             timeout);
+    }
+
+    shutdown_set_callback(shutdown, task_handler_stopped, this_ptr);
+    status = shutdown_run(shutdown);
+    shutdown_destroy(shutdown);
+
+    return (status == SHUTDOWN_SUCCESS) ? TASK_HANDLER_SUCCESS :
+                                          TASK_HANDLER_FAIL;
+}
+
+/*!
+ * Gets the time since the tasks were started.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ *
+ * \return The time in microseconds since the dependencies were calculated.
+ */
+unsigned long task_handler_elapsed(task_handler_t *this_ptr)
+{
+    struct timespec now;
+    long elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (long) (now.tv_sec - this_ptr->start.tv_sec) * 1000000L +
+              (now.tv_nsec - this_ptr->start.tv_nsec) / 1000L;
+    return (elapsed > 0) ? (unsigned long) elapsed : 0u;
+}
+
+void task_handler_run_add_task(task_handler_t *this_ptr, task_t *task)
+{
+    task_handler_run_add_tasks(this_ptr, &task, 1u);
+}
+
+/*!
+ * Starts tasks which are ready to execute. A task which doesn't fit within
+ * the limit of its group or within the resource budgets is kept pending until
+ * a running task has finished.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param tasks - The tasks which are ready, they are sorted by priority.
+ * \param tasks_size - The number of ready tasks.
+ */
+void task_handler_run_add_tasks(task_handler_t *this_ptr, task_t **tasks,
+                                unsigned int tasks_size)
+{
+    task_handler_run_finish(this_ptr, NULL, tasks, tasks_size);
+}
+
+/*!
+ * Releases the group and the resource tokens of a finished task and starts
+ * the pending tasks and the new ready tasks that fit. The tasks are
+ * considered in priority order, and a pending task goes before a new task
+ * with the same priority since it has been waiting longer. A task that
+ * doesn't fit doesn't stop the tasks behind it. The pending tasks are kept
+ * in priority order. The admitted tasks are handed to the thread pool in one
+ * batch, or one at a time if there isn't any memory for the batch.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param task - The finished task, \c NULL if no task has finished.
+ * \param ready - The tasks which became ready, they are sorted by priority.
+ * \param ready_size - The number of ready tasks.
+ */
+void task_handler_run_finish(task_handler_t *this_ptr, task_t *task,
+                             task_t **ready, unsigned int ready_size)
+{
+    unsigned int admitted_size = 0u;
+    unsigned int remaining;
+    task_t **admitted;
+    task_t *next;
+    bool pending;
+    unsigned int i;
+
+    for (i = 0u; i < ready_size; i++) {
+        ready[i]->ready_time = task_handler_elapsed(this_ptr);
+        trace_record(this_ptr->trace, TRACE_READY, task_get_id(ready[i]));
+    }
+    i = 0u;
+
+    if (ready_size > 1u) {
+        qsort(ready, ready_size, sizeof(task_t*),
+              task_handler_compare_priority);
+    }
+
+    if (!this_ptr->admission_control) {
+        if (ready_size > 0u) {
+            task_handler_dispatch(this_ptr, ready, ready_size);
+        }
+        return;
+    }
+
+    /* A task is either pending or ready at most once, so the batch can't hold
+       more than all the tasks in the graph. */
+    admitted = NULL;
+    if (this_ptr->graph != NULL) {
+        admitted = (task_t**) malloc(sizeof(task_t*) *
+                                     (this_ptr->graph->nodes_size + 1u));
+    }
+
+    pthread_mutex_lock(&this_ptr->mutex);
+
+    if (task != NULL) {
+        task_handler_release(this_ptr, task);
+    }
+
+    /* Merge the pending tasks with the ready tasks. Every pending task is
+       popped once, so the tasks that still don't fit end up at the back of
+       the queue in the merged order. */
+    remaining = this_ptr->pending_size;
+    while ((remaining > 0u) || (i < ready_size)) {
+        next = NULL;
+        if (remaining > 0u) {
+            queue_first(this_ptr->pending);
+            next = queue_get_current(this_ptr->pending);
+        }
+        pending = (next != NULL) &&
+                  ((i == ready_size) || (ready[i]->priority <= next->priority));
+
+        if (pending) {
+            queue_pop(this_ptr->pending);
+            remaining--;
+            this_ptr->pending_size--;
+        } else if (i < ready_size) {
+            next = ready[i];
+            i++;
+        } else {
+            break;
+        }
+
+        if (!task_handler_admit(this_ptr, next)) {
+            queue_push(this_ptr->pending, next);
+            this_ptr->pending_size++;
+        } else if (admitted != NULL) {
+            admitted[admitted_size] = next;
+            admitted_size++;
+        } else {
+            /* The thread pool never calls the task handler while it holds
+               its own lock, so the task can be handed over here. */
+            task_handler_dispatch(this_ptr, &next, 1u);
+        }
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    if (admitted_size > 0u) {
+        task_handler_dispatch(this_ptr, admitted, admitted_size);
+    }
+    free(admitted);
+}
+
+/*!
+ * Hands the admitted tasks to the thread pool.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param tasks - The admitted tasks in the order that they should start.
+ * \param tasks_size - The number of admitted tasks.
+ */
+static void task_handler_dispatch(task_handler_t *this_ptr, task_t **tasks,
+                                  unsigned int tasks_size)
+{
+    unsigned long now = task_handler_elapsed(this_ptr);
+    unsigned int i;
+
+    for (i = 0u; i < tasks_size; i++) {
+        tasks[i]->admit_time = now;
+    }
+    thread_pool_group_add_tasks(this_ptr->thread_pool_group, (void**) tasks,
+                                tasks_size);
+}
+
+/*!
+ * Keeps the targets and the tasks that they require or want, transitively,
+ * and destroys the other tasks before any dependency is built. The graph is
+ * walked once through the task lookup, so it is linear in the number of
+ * tasks and dependencies. The tasks which a kept task is only ordered after
+ * aren't kept.
+ *
+ * The closure of the dependency graph isn't used since the graph doesn't
+ * exist yet, and building it for every task only to destroy most of them
+ * would cost more than the walk.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param tasks_size - The number of tasks.
+ *
+ * \return The number of kept tasks.
+ */
+static unsigned int task_handler_select_targets(task_handler_t *this_ptr,
+                                                unsigned int tasks_size)
+{
+    unsigned int stack_size = 0u;
+    unsigned int selected = 0u;
+    unsigned int provides_id;
+    task_t **stack;
+    task_t *task;
+    char *target;
+    unsigned int i;
+
+    /* Each task is pushed at most once since it is marked when it is pushed.
+       All the tasks are kept if the walk can't be done. */
+    stack = (task_t**) malloc(sizeof(task_t*) * (tasks_size + 1u));
+    if (stack == NULL) {
+        return tasks_size;
+    }
+
+    queue_first(this_ptr->targets);
+    while ((target = queue_get_current(this_ptr->targets)) != NULL) {
+        task = hash_lookup_find(this_ptr->task_lookup, hash_generate(target));
+        if (task == NULL) {
+            printf("Missing target: %s\n", target);
+        } else if (!task->selected) {
+            task->selected = true;
+            stack[stack_size] = task;
+            stack_size++;
+        }
+        queue_next(this_ptr->targets);
+    }
+
+    while (stack_size > 0u) {
+        stack_size--;
+        task = stack[stack_size];
+        task_handler_select(this_ptr, task->service->dependency, stack,
+                            &stack_size);
+        task_handler_select(this_ptr, task->service->wants, stack,
+                            &stack_size);
+    }
+    free(stack);
+
+    /* Rotate the queue once and keep the selected tasks in their order. */
+    for (i = 0u; i < tasks_size; i++) {
+        task = queue_pop(this_ptr->tasks);
+
+        if (task->selected) {
+            queue_push(this_ptr->tasks, task);
+            selected++;
+        } else {
+            provides_id = task_get_provides_id(task);
+            hash_lookup_remove(this_ptr->task_lookup, task_get_id(task));
+            if (hash_lookup_find(this_ptr->task_lookup, provides_id) == task) {
+                hash_lookup_remove(this_ptr->task_lookup, provides_id);
+            }
+            task_destroy(task);
+        }
+    }
+    return selected;
+}
+
+/*!
+ * Creates a target for each name which is provided by several tasks. The
+ * target is reached as soon as any of the tasks is ready, so the tasks which
+ * depend on the name can start as soon as possible. The name then refers to
+ * the target instead of the first task. Only the fastest provider is kept
+ * if that is enabled and known.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param providers - The tasks which provide a name that an earlier task
+ *                    already provides.
+ * \param tasks_size - The number of tasks.
+ *
+ * \return The number of tasks with the created targets.
+ */
+static unsigned int task_handler_add_providers(task_handler_t *this_ptr,
+                                               queue_t *providers,
+                                               unsigned int tasks_size)
+{
+    hash_lookup_t *lookup;
+    service_t *service;
+    task_t *first;
+    task_t *task;
+    char **name;
+    queue_t services;
+
+    if (queue_first(providers) != QUEUE_SUCESS) {
+        return tasks_size;
+    }
+    lookup = hash_lookup_create(64);
+    if (lookup == NULL) {
+        return tasks_size;
+    }
+    queue_init(&services);
+
+    while ((task = queue_pop(providers)) != NULL) {
+        service = hash_lookup_find(lookup, task->provides_id);
+        first = hash_lookup_find(this_ptr->task_lookup, task->provides_id);
+
+        if (service == NULL) {
+            service = malloc(sizeof(service_t));
+            if (service != NULL) {
+                service_init(service);
+                service->name = task->service->provides;
+                service->wants = task_handler_add_name(NULL,
+                                                       first->service->name);
+                service->type = SERVICE_TYPE_TARGET;
+                hash_lookup_insert(lookup, task->provides_id, service);
+                queue_push(&services, service);
+            }
+        }
+        if (service != NULL) {
+            service->wants = task_handler_add_name(service->wants,
+                                                   task->service->name);
+        }
+    }
+
+    while ((service = queue_pop(&services)) != NULL) {
+        task = NULL;
+        if (service->wants != NULL) {
+            if (this_ptr->fastest_provider) {
+                tasks_size = task_handler_elect_provider(this_ptr, service,
+                                                         tasks_size);
+            }
+            task = task_create(service, this_ptr);
+        }
+        if (task == NULL) {
+            free(service->wants);
+            free(service);
+            continue;
+        }
+        task->any = true;
+        hash_lookup_remove(this_ptr->task_lookup, task_get_id(task));
+        hash_lookup_insert(this_ptr->task_lookup, task_get_id(task), task);
+        queue_push(this_ptr->tasks, task);
+        queue_push(this_ptr->providers, service);
+        tasks_size++;
+
+        printf("Providers of %s:", service->name);
+        for (name = service->wants; *name != NULL; name++) {
+            printf(" %s", *name);
+        }
+        printf("\n");
+    }
+    hash_lookup_destroy(lookup);
+
+    return tasks_size;
+}
+
+/*!
+ * Keeps only the provider with the shortest estimated duration in a provider
+ * set, the other providers are destroyed before any dependency is built. A
+ * task that depends on a dropped provider by its own name sees it as
+ * missing. Nothing is dropped unless every provider has an estimate, so each
+ * provider gets to run until its duration is known.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param service - The target of the provider set.
+ * \param tasks_size - The number of tasks.
+ *
+ * \return The number of tasks that are left.
+ */
+static unsigned int task_handler_elect_provider(task_handler_t *this_ptr,
+                                                service_t *service,
+                                                unsigned int tasks_size)
+{
+    unsigned long fastest_estimate = 0u;
+    unsigned long estimate;
+    task_t *fastest = NULL;
+    task_t *task;
+    char **name;
+
+    for (name = service->wants; *name != NULL; name++) {
+        task = hash_lookup_find(this_ptr->task_lookup, hash_generate(*name));
+        if ((task == NULL) ||
+            !task_handler_get_estimate(this_ptr, task, &estimate)) {
+            return tasks_size;
+        }
+        if ((fastest == NULL) || (estimate < fastest_estimate)) {
+            fastest = task;
+            fastest_estimate = estimate;
+        }
+    }
+
+    for (name = service->wants; *name != NULL; name++) {
+        task = hash_lookup_find(this_ptr->task_lookup, hash_generate(*name));
+        if (task != fastest) {
+            task_handler_drop_task(this_ptr, task, tasks_size);
+            tasks_size--;
+        }
+    }
+    service->wants[0] = fastest->service->name;
+    service->wants[1] = NULL;
+
+    printf("Fastest provider of %s: %s (%lu ms)\n", service->name,
+           fastest->service->name, fastest_estimate);
+    return tasks_size;
+}
+
+/*!
+ * Removes a task from the tasks and the lookup table and destroys it, it must
+ * be done before any dependency is built.
+ */
+static void task_handler_drop_task(task_handler_t *this_ptr, task_t *task,
+                                   unsigned int tasks_size)
+{
+    task_t *current;
+    unsigned int i;
+
+    /* Rotate the queue once and keep the other tasks in their order. */
+    for (i = 0u; i < tasks_size; i++) {
+        current = queue_pop(this_ptr->tasks);
+        if (current != task) {
+            queue_push(this_ptr->tasks, current);
+        }
+    }
+    if (hash_lookup_find(this_ptr->task_lookup, task_get_id(task)) == task) {
+        hash_lookup_remove(this_ptr->task_lookup, task_get_id(task));
+    }
+    task_destroy(task);
+}
+
+/*!
+ * Adds a name to a \c NULL terminated list of names, the name isn't copied.
+ *
+ * \return The list with the new name, \c NULL if the memory couldn't be
+ *         allocated.
+ */
+static char **task_handler_add_name(char **names, char *name)
+{
+    char **new_names;
+    size_t size = 0u;
+
+    if (names != NULL) {
+        while (names[size] != NULL) {
+            size++;
+        }
+    }
+
+    new_names = realloc(names, sizeof(char*) * (size + 2u));
+    if (new_names == NULL) {
+        free(names);
+        return NULL;
+    }
+    new_names[size] = name;
+    new_names[size + 1u] = NULL;
+    return new_names;
+}
+
+/*!
+ * Marks the tasks with the given names as selected and pushes the tasks that
+ * weren't selected before on the stack.
+ */
+static void task_handler_select(task_handler_t *this_ptr, char **names,
+                                task_t **stack, unsigned int *stack_size)
+{
+    task_t *task;
+
+    if (names == NULL) {
+        return;
+    }
+
+    while (*names != NULL) {
+        task = hash_lookup_find(this_ptr->task_lookup, hash_generate(*names));
+        if ((task != NULL) && !task->selected) {
+            task->selected = true;
+            stack[*stack_size] = task;
+            (*stack_size)++;
+        }
+        names++;
+    }
+}
+
+/*!
+ * Finds the tasks which require exactly the same set of tasks and makes them
+ * require a new target which requires the set instead, when that saves
+ * dependencies. The sets are found through a hash of the sorted ids of the
+ * required tasks.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param tasks_size - The number of tasks.
+ *
+ * \return The number of tasks including the new targets.
+ */
+static unsigned int task_handler_collapse(task_handler_t *this_ptr,
+                                          unsigned int tasks_size)
+{
+    task_handler_collapse_t *set;
+    hash_lookup_t *lookup;
+    queue_t sets;
+    unsigned int *ids;
+    unsigned int size;
+    unsigned int key;
+    unsigned int i;
+    task_t *task;
+
+    lookup = hash_lookup_create(64);
+    if (lookup == NULL) {
+        return tasks_size;
+    }
+    queue_init(&sets);
+
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        ids = NULL;
+        if (!task_is_target(task)) {
+            ids = task_handler_get_requires(task, &size);
+        }
+
+        if (ids != NULL) {
+            key = 0u;
+            for (i = 0u; i < size; i++) {
+                key = (key * 31u) + ids[i];
+            }
+
+            set = hash_lookup_find(lookup, key);
+            if (set == NULL) {
+                set = malloc(sizeof(task_handler_collapse_t));
+                if (set != NULL) {
+                    /* The set takes over the ids. */
+                    set->key = key;
+                    set->ids = ids;
+                    set->ids_size = size;
+                    set->names = task->service->dependency;
+                    set->tasks_size = 0u;
+                    queue_init(&set->tasks);
+                    hash_lookup_insert(lookup, key, set);
+                    queue_push(&sets, set);
+                    ids = NULL;
+                }
+            } else if ((set->ids_size != size) ||
+                       (memcmp(set->ids, ids, sizeof(unsigned int) * size) !=
+                        0)) {
+                /* Different sets with the same hash aren't collapsed. */
+                set = NULL;
+            }
+
+            if (set != NULL) {
+                queue_push(&set->tasks, task);
+                set->tasks_size++;
+            }
+            free(ids);
+        }
+        queue_next(this_ptr->tasks);
+    }
+
+    while ((set = queue_pop(&sets)) != NULL) {
+        if (((set->ids_size * set->tasks_size) >
+             (set->ids_size + set->tasks_size)) &&
+            task_handler_add_collapsed(this_ptr, set)) {
+            tasks_size++;
+        }
+        queue_deinit(&set->tasks);
+        free(set->ids);
+        free(set);
+    }
+    hash_lookup_destroy(lookup);
+
+    return tasks_size;
+}
+
+/*!
+ * Gets the sorted ids of the tasks that a task requires.
+ *
+ * \param task - A pointer to the task.
+ * \param size - Set to the number of ids.
+ *
+ * \return The ids, \c NULL if the task requires less than two tasks.
+ */
+static unsigned int *task_handler_get_requires(task_t *task,
+                                               unsigned int *size)
+{
+    char **names = task->service->dependency;
+    unsigned int *ids;
+    unsigned int id;
+    unsigned int i;
+    unsigned int j;
+
+    *size = 0u;
+    if (names == NULL) {
+        return NULL;
+    }
+    while (names[*size] != NULL) {
+        (*size)++;
+    }
+    if (*size < 2u) {
+        return NULL;
+    }
+
+    ids = malloc(sizeof(unsigned int) * (*size));
+    if (ids == NULL) {
+        return NULL;
+    }
+
+    /* The lists are short, so an insertion sort is enough. */
+    for (i = 0u; i < *size; i++) {
+        id = hash_generate(names[i]);
+        for (j = i; (j > 0u) && (ids[j - 1u] > id); j--) {
+            ids[j] = ids[j - 1u];
+        }
+        ids[j] = id;
+    }
+    return ids;
+}
+
+/*!
+ * Creates a target which requires a set of tasks and makes the tasks in the
+ * set require the target instead.
+ *
+ * \return \c true if the target was created, \c false otherwise.
+ */
+static bool task_handler_add_collapsed(task_handler_t *this_ptr,
+                                       task_handler_collapse_t *set)
+{
+    service_t *service = malloc(sizeof(service_t));
+    task_t *task = NULL;
+
+    if (service != NULL) {
+        service_init(service);
+        service->name = malloc(TASK_HANDLER_COLLAPSE_NAME);
+        service->dependency = set->names;
+        service->type = SERVICE_TYPE_TARGET;
+    }
+    if ((service != NULL) && (service->name != NULL)) {
+        snprintf(service->name, TASK_HANDLER_COLLAPSE_NAME, "collapsed-%08x",
+                 set->key);
+        task = task_create(service, this_ptr);
+    }
+    if ((task == NULL) ||
+        (hash_lookup_insert(this_ptr->task_lookup, task_get_id(task), task) !=
+         HASH_LOOKUP_SUCESS)) {
+        task_destroy(task);
+        if (service != NULL) {
+            free(service->name);
+        }
+        free(service);
+        return false;
+    }
+
+    printf("Collapsed %u x %u dependencies into %s\n", set->tasks_size,
+           set->ids_size, service->name);
+    queue_push(this_ptr->tasks, task);
+    queue_push(this_ptr->collapsed, service);
+
+    while ((task = queue_pop(&set->tasks)) != NULL) {
+        task_replace_requires(task, service->name);
+    }
+    return true;
+}
+
+/*!
+ * Checks the dependency graph before the dependencies are built. The
+ * dependency cycles are broken, and the duplicate dependencies and the
+ * dependencies which are implied by other dependencies are removed if that
+ * is enabled. The graph is kept for the queries.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param tasks_size - The number of tasks.
+ */
+static void task_handler_check_graph(task_handler_t *this_ptr,
+                                     unsigned int tasks_size)
+{
+    task_graph_t *graph = task_graph_create(tasks_size);
+    task_t **tasks = (task_t**) malloc(sizeof(task_t*) * (tasks_size + 1u));
+    unsigned int removed;
+    unsigned int index = 0u;
+    unsigned int edge = 0u;
+    task_t *task;
+
+    if ((graph == NULL) || (tasks == NULL)) {
+        task_graph_destroy(graph);
+        free(tasks);
+        return;
+    }
+
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        task->index = index;
+        tasks[index] = task;
+        index++;
+        queue_next(this_ptr->tasks);
+    }
+
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        task_add_graph_edges(task, graph, this_ptr->task_lookup);
+        queue_next(this_ptr->tasks);
+    }
+
+    task_handler_break_cycles(this_ptr, graph, tasks);
+
+    if (this_ptr->reduce &&
+        (task_graph_reduce(graph, &removed) == TASK_GRAPH_SUCCESS)) {
+        printf("Removed %u of %u dependencies\n", removed,
+               graph->edges_size);
+    }
+
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        edge = task_remove_graph_edges(task, graph, this_ptr->task_lookup,
+                                       edge);
+        queue_next(this_ptr->tasks);
+    }
+
+    task_handler_prioritize(this_ptr, graph, tasks);
+    this_ptr->graph = graph;
+    this_ptr->nodes = tasks;
+}
+
+/*!
+ * Sets the cost of each task to its estimated duration and the priority to
+ * the estimated duration of the longest chain of tasks that waits for it. A
+ * task without an estimate is assumed to take as long as the average task
+ * with one, and every task counts as one millisecond if nothing has been
+ * recorded. The targets don't take any time.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param graph - The checked dependency graph.
+ * \param tasks - The task of each node.
+ */
+static void task_handler_prioritize(task_handler_t *this_ptr,
+                                    task_graph_t *graph, task_t **tasks)
+{
+    unsigned long *cost;
+    unsigned long *length;
+    unsigned long estimate;
+    unsigned long total = 0u;
+    unsigned long average = 1u;
+    unsigned int known = 0u;
+    bool *has_estimate;
+    unsigned int i;
+
+    cost = malloc(sizeof(unsigned long) * (graph->nodes_size + 1u));
+    length = malloc(sizeof(unsigned long) * (graph->nodes_size + 1u));
+    has_estimate = malloc(sizeof(bool) * (graph->nodes_size + 1u));
+
+    if ((cost != NULL) && (length != NULL) && (has_estimate != NULL)) {
+        for (i = 0u; i < graph->nodes_size; i++) {
+            has_estimate[i] = task_handler_get_estimate(this_ptr, tasks[i],
+                                                        &estimate);
+            cost[i] = has_estimate[i] ? estimate : 0u;
+            if (has_estimate[i]) {
+                total += estimate;
+                known++;
+            }
+        }
+        if ((known > 0u) && (total >= known)) {
+            average = total / known;
+        }
+        for (i = 0u; i < graph->nodes_size; i++) {
+            if (!has_estimate[i] && !task_is_target(tasks[i])) {
+                cost[i] = average;
+            }
+            tasks[i]->cost = cost[i];
+        }
+
+        if (task_graph_longest_paths(graph, cost, length) ==
+            TASK_GRAPH_SUCCESS) {
+            for (i = 0u; i < graph->nodes_size; i++) {
+                tasks[i]->priority = length[i];
+            }
+        }
+    }
+
+    free(has_estimate);
+    free(length);
+    free(cost);
+}
+
+/*!
+ * Reports the dependency cycles and breaks them according to the cycle
+ * policy. The tasks in a cycle would never be started, and nothing would
+ * report them. The dependencies within the cycles that remain are removed
+ * and the tasks in them are marked to be skipped.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param graph - The dependency graph.
+ * \param tasks - The task of each node in the graph.
+ */
+static void task_handler_break_cycles(task_handler_t *this_ptr,
+                                      task_graph_t *graph, task_t **tasks)
+{
+    size_t size = sizeof(unsigned int) * (graph->nodes_size + 1u);
+    unsigned int *component = malloc(size);
+    unsigned int *cycle = malloc(size);
+    unsigned int components_size;
+    unsigned int cycles = 0u;
+    unsigned int dropped = 0u;
+    unsigned int edge;
+
+    if ((component != NULL) && (cycle != NULL)) {
+        cycles = task_handler_find_cycles(graph, tasks, component, cycle);
+    }
+
+    /* An edge within a component is always part of a cycle. */
+    if ((cycles > 0u) && (this_ptr->cycle == TASK_HANDLER_CYCLE_WEAK)) {
+        for (edge = 0u; edge < graph->edges_size; edge++) {
+            if (!graph->removed[edge] && !graph->strong[edge] &&
+                (component[graph->from[edge]] ==
+                 component[graph->to[edge]])) {
+                task_graph_remove_edge(graph, edge);
+                dropped++;
+            }
+        }
+        /* The components only get smaller, so the old components are
+           still usable if the new ones can't be found. */
+        if (dropped > 0u) {
+            printf("Dropped %u wants and after dependencies in cycles\n",
+                   dropped);
+            (void) task_graph_components(graph, component, &components_size);
+        }
+    }
+
+    if (cycles > 0u) {
+        for (edge = 0u; edge < graph->edges_size; edge++) {
+            if (!graph->removed[edge] &&
+                (component[graph->from[edge]] ==
+                 component[graph->to[edge]])) {
+                task_graph_remove_edge(graph, edge);
+                task_fail(tasks[graph->from[edge]], "in a dependency cycle");
+                task_fail(tasks[graph->to[edge]], "in a dependency cycle");
+            }
+        }
+    }
+
+    free(cycle);
+    free(component);
+}
+
+/*!
+ * Finds and reports the dependency cycles, one cycle is reported for each
+ * set of tasks which depend on each other. The file and line where each
+ * task is declared are reported when they are known.
+ *
+ * \param graph - The dependency graph.
+ * \param tasks - The task of each node in the graph.
+ * \param component - Set to the strongly connected component of each node.
+ * \param cycle - Set to the edge that leaves each node in a cycle.
+ *
+ * \return The number of cycles, 0 if the graph doesn't have any cycle or if
+ *         the memory couldn't be allocated.
+ */
+static unsigned int task_handler_find_cycles(task_graph_t *graph,
+                                             task_t **tasks,
+                                             unsigned int *component,
+                                             unsigned int *cycle)
+{
+    unsigned int cycles = 0u;
+    unsigned int components_size;
+    unsigned int start;
+    unsigned int node;
+    unsigned int edge;
+    bool *reported;
+
+    reported = calloc(graph->nodes_size + 1u, sizeof(bool));
+    if ((reported == NULL) ||
+        (task_graph_components(graph, component, &components_size) !=
+         TASK_GRAPH_SUCCESS) ||
+        (task_graph_find_cycles(graph, component, cycle) !=
+         TASK_GRAPH_SUCCESS)) {
+        free(reported);
+        return 0u;
+    }
+
+    for (start = 0u; start < graph->nodes_size; start++) {
+        if ((cycle[start] == TASK_GRAPH_NONE) ||
+            reported[component[start]]) {
+            continue;
+        }
+        reported[component[start]] = true;
+        cycles++;
+
+        printf("Dependency cycle: ");
+        task_handler_print_task(tasks[start]);
+        node = start;
+        do {
+            edge = cycle[node];
+            node = graph->to[edge];
+            printf(graph->strong[edge] ? " requires " : " is after ");
+            task_handler_print_task(tasks[node]);
+        } while (node != start);
+        printf("\n");
+    }
+
+    free(reported);
+    return cycles;
+}
+
+/*!
+ * Gets all the tasks that a task depends on, directly or through other
+ * tasks. The tasks that it is only ordered after count as well. The
+ * dependencies must have been calculated, and the queries must not be made
+ * from several threads at the same time.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param name - The name of the task.
+ *
+ * \return A \c NULL terminated list of the tasks which has to be freed by
+ *         the caller, \c NULL if the task is unknown.
+ */
+task_t **task_handler_get_dependencies(task_handler_t *this_ptr,
+                                       const char *name)
+{
+    return task_handler_query(this_ptr, name, false);
+}
+
+/*!
+ * Gets all the tasks that depend on a task, directly or through other
+ * tasks. These are the tasks which are affected if the task is restarted.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param name - The name of the task.
+ *
+ * \return A \c NULL terminated list of the tasks which has to be freed by
+ *         the caller, \c NULL if the task is unknown.
+ */
+task_t **task_handler_get_dependents(task_handler_t *this_ptr,
+                                     const char *name)
+{
+    return task_handler_query(this_ptr, name, true);
+}
+
+/*!
+ * Checks if a task depends on another task, directly or through other
+ * tasks.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param name - The name of the dependent task.
+ * \param dependency - The name of the dependency task.
+ *
+ * \return \c true if the task depends on the other task, \c false
+ *         otherwise.
+ */
+bool task_handler_depends_on(task_handler_t *this_ptr, const char *name,
+                             const char *dependency)
+{
+    task_graph_closure_t *closure = task_handler_get_closure(this_ptr);
+    task_t *task = hash_lookup_find(this_ptr->task_lookup,
+                                    hash_generate(name));
+    task_t *other = hash_lookup_find(this_ptr->task_lookup,
+                                     hash_generate(dependency));
+
+    return (closure != NULL) && (task != NULL) && (other != NULL) &&
+           task_graph_closure_depends(closure, task->index, other->index);
+}
+
+/*!
+ * Gets the dependencies or the dependents of a task from the closure.
+ */
+static task_t **task_handler_query(task_handler_t *this_ptr,
+                                   const char *name, bool dependents)
+{
+    task_graph_closure_t *closure = task_handler_get_closure(this_ptr);
+    task_t *task = hash_lookup_find(this_ptr->task_lookup,
+                                    hash_generate(name));
+    unsigned int *nodes;
+    unsigned int size;
+    unsigned int i;
+    task_t **tasks = NULL;
+
+    if ((closure == NULL) || (task == NULL)) {
+        return NULL;
+    }
+
+    nodes = malloc(sizeof(unsigned int) * (closure->nodes_size + 1u));
+    if (nodes != NULL) {
+        size = dependents ?
+               task_graph_closure_dependents(closure, task->index, nodes) :
+               task_graph_closure_dependencies(closure, task->index, nodes);
+
+        tasks = malloc(sizeof(task_t*) * (size + 1u));
+        if (tasks != NULL) {
+            for (i = 0u; i < size; i++) {
+                tasks[i] = this_ptr->nodes[nodes[i]];
+            }
+            tasks[size] = NULL;
+        }
+        free(nodes);
+    }
+    return tasks;
+}
+
+/*!
+ * Gets the transitive closure of the dependency graph, it is created the
+ * first time that it is needed.
+ *
+ * \return A pointer to the closure, \c NULL if the dependencies haven't
+ *         been calculated or if the closure couldn't be created.
+ */
+static task_graph_closure_t *task_handler_get_closure(
+        task_handler_t *this_ptr)
+{
+    if ((this_ptr->closure == NULL) && (this_ptr->graph != NULL)) {
+        this_ptr->closure = task_graph_closure_create(this_ptr->graph);
+    }
+    return this_ptr->closure;
+}
+
+/*!
+ * Gets the estimated duration of a task, the duration of the service is used
+ * if it is set and the timing database otherwise.
+ *
+ * \return \c true if there is an estimate, \c false otherwise.
+ */
+static bool task_handler_get_estimate(task_handler_t *this_ptr, task_t *task,
+                                      unsigned long *estimate)
+{
+    if (task_is_target(task)) {
+        return false;
+    }
+    if (task->service->duration != SERVICE_NOT_SET) {
+        *estimate = (unsigned long) task->service->duration;
+        return true;
+    }
+    if (this_ptr->timing_db == NULL) {
+        return false;
+    }
+    return timing_db_get(this_ptr->timing_db, task_get_id(task),
+                         timing_db_config_id(task->service), estimate);
+}
+
+/*!
+ * Records the durations of the tasks which have run successfully and writes
+ * the timing database, it is done when all the tasks have finished.
+ */
+static void task_handler_record_timings(task_handler_t *this_ptr)
+{
+    task_t *task;
+
+    queue_first(this_ptr->tasks);
+    while ((task = queue_get_current(this_ptr->tasks)) != NULL) {
+        if (task->measured && !task_is_target(task)) {
+            timing_db_update(this_ptr->timing_db, task_get_id(task),
+                             timing_db_config_id(task->service),
+                             task->duration);
+        }
+        queue_next(this_ptr->tasks);
+    }
+
+    if (timing_db_save(this_ptr->timing_db) != TIMING_DB_SUCCESS) {
+        printf("Could not write the timing database %s\n",
+               this_ptr->timing_db->path);
+    }
+}
+
+/*!
+ * Orders the tasks by priority for \c qsort, the highest priority first. The
+ * tasks with the same priority keep the order of the dependency graph.
+ *
+ * \param first - A pointer to a pointer to a task.
+ * \param second - A pointer to a pointer to another task.
+ *
+ * \return A negative value if the first task goes first, a positive value if
+ *         the second task goes first and 0 if they are the same task.
+ */
+int task_handler_compare_priority(const void *first, const void *second)
+{
+    const task_t *task = *(task_t* const*) first;
+    const task_t *other = *(task_t* const*) second;
+
+    if (task->priority != other->priority) {
+        return (task->priority > other->priority) ? -1 : 1;
+    }
+    if (task->index != other->index) {
+        return (task->index < other->index) ? -1 : 1;
+    }
+    return 0;
+}
+
+/*!
+ * Called by the shutdown when a service is down, the pid file is removed
+ * unless the process is still running.
+ */
+static void task_handler_stopped(void *context, unsigned int node,
+                                 shutdown_result_t result)
+{
+    task_handler_t *this_ptr = (task_handler_t*) context;
+    service_t *service = this_ptr->nodes[node]->service;
+
+    switch (result) {
+        case SHUTDOWN_STOPPED:
+            printf("%s stopped\n", service->name);
+            break;
+
+        case SHUTDOWN_KILLED:
+            printf("%s killed after stop timeout\n", service->name);
+            break;
+
+        case SHUTDOWN_LEFT:
+            printf("%s could not be stopped\n", service->name);
+            return;
+
+        case SHUTDOWN_NOT_RUNNING:
+        default:
+            break;
+    }
+    process_remove_pid_file(this_ptr->run_dir, service->name);
+}
+
+/*!
+ * Reports a configuration error where the name of a task is already taken
+ * by another task. The task fails since it can't be found by that name.
+ *
+ * \param task - The task which is ignored in the task lookup table.
+ * \param other - The task which has the name in the task lookup table.
+ * \param conflict - Describes how the names clash.
+ */
+static void task_handler_conflict(task_t *task, task_t *other,
+                                  const char *conflict)
+{
+    printf("Name conflict: ");
+    task_handler_print_task(task);
+    printf(" %s ", conflict);
+    task_handler_print_task(other);
+    printf("\n");
+
+    task_fail(task, "name conflict");
+}
+
+/*!
+ * Prints the name of a task and where it is declared.
+ */
+static void task_handler_print_task(task_t *task)
+{
+    if ((task->service->file != NULL) && (task->service->line > 0)) {
+        printf("%s (%s:%d)", task->service->name, task->service->file,
+               task->service->line);
+    } else if (task->service->file != NULL) {
+        printf("%s (%s)", task->service->name, task->service->file);
+    } else {
+        printf("%s", task->service->name);
+    }
+}
+
+void task_handler_deinit(task_handler_t * this_ptr)
+{
+    task_handler_group_t *handler_group;
+    service_t *service;
+    task_t *task;
+    char *target;
+
+    /* The supervisor and the timers refer to the tasks, so they are destroyed
+       first. */
+    supervisor_destroy(this_ptr->supervisor);
+    timer_wheel_destroy(this_ptr->timer_wheel);
+
+    if (this_ptr->tasks != NULL) {
+        while((task = queue_pop(this_ptr->tasks)) != NULL) {
+            task_destroy(task);
+        }
+        queue_destroy(this_ptr->tasks);
+    }
+    if (this_ptr->groups != NULL) {
+        while((handler_group = queue_pop(this_ptr->groups)) != NULL) {
+            free(handler_group);
+        }
+        queue_destroy(this_ptr->groups);
+    }
+    if (this_ptr->targets != NULL) {
+        while((target = queue_pop(this_ptr->targets)) != NULL) {
+            free(target);
+        }
+        queue_destroy(this_ptr->targets);
+    }
+    if (this_ptr->collapsed != NULL) {
+        while((service = queue_pop(this_ptr->collapsed)) != NULL) {
+            free(service->name);
+            free(service);
+        }
+        queue_destroy(this_ptr->collapsed);
+    }
+    if (this_ptr->providers != NULL) {
+        while((service = queue_pop(this_ptr->providers)) != NULL) {
+            free(service->wants);
+            free(service);
+        }
+        queue_destroy(this_ptr->providers);
+    }
+    task_graph_closure_destroy(this_ptr->closure);
+    task_graph_destroy(this_ptr->graph);
+    free(this_ptr->nodes);
+    free(this_ptr->run_dir);
+    if (this_ptr->timing_db != NULL) {
+        timing_db_destroy(this_ptr->timing_db);
+    }
+    queue_destroy(this_ptr->pending);
+    pressure_destroy(this_ptr->pressure);
+    pthread_mutex_destroy(&this_ptr->mutex);
+    thread_pool_group_destroy(this_ptr->thread_pool_group);
+    hash_lookup_destroy(this_ptr->task_lookup);
+    trace_destroy(this_ptr->trace);
+    free(this_ptr->trace_path);
+}
+
+void task_handler_destroy(task_handler_t * this_ptr)
+{
+    task_handler_deinit(this_ptr);
+    free(this_ptr);
+}
+
+/*!
+ * Finds a concurrency group by its name.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param name - The name of the group.
+ *
+ * \return The group or \c NULL if the group doesn't have any limit.
+ */
+static task_handler_group_t *task_handler_find_group(task_handler_t *this_ptr,
+                                                     const char *name)
+{
+    task_handler_group_t *handler_group;
+    unsigned int id = hash_generate(name);
+
+    queue_first(this_ptr->groups);
+    while ((handler_group = queue_get_current(this_ptr->groups)) != NULL) {
+        if (handler_group->id == id) {
+            return handler_group;
+        }
+        queue_next(this_ptr->groups);
+    }
+    return NULL;
+}
+
+/*!
+ * Gets the number of I/O tokens that a task needs. A task never needs more
+ * than the whole budget, otherwise it would never be able to start.
+ */
+static unsigned int task_handler_get_io(task_handler_t *this_ptr, task_t *task)
+{
+    unsigned int io = task->service->io;
+
+    if (this_ptr->io_budget == 0u) {
+        return 0u;
+    }
+    return (io < this_ptr->io_budget) ? io : this_ptr->io_budget;
+}
+
+/*!
+ * Gets the amount of memory that a task needs. A task never needs more than
+ * the whole budget, otherwise it would never be able to start.
+ */
+static unsigned long task_handler_get_mem(task_handler_t *this_ptr,
+                                          task_t *task)
+{
+    unsigned long mem = task->service->mem;
+
+    if (this_ptr->mem_budget == 0u) {
+        return 0u;
+    }
+    return (mem < this_ptr->mem_budget) ? mem : this_ptr->mem_budget;
+}
+
+/*!
+ * Checks if a task fits within the pressure limit, the limit of its group
+ * and the resource budgets. The group and the resources are reserved for the task
+ * if it fits. The mutex must be locked by the caller.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param task - The task which is ready.
+ *
+ * \return \c true if the task can be started.
+ */
+bool task_handler_admit(task_handler_t *this_ptr, task_t *task)
+{
+    unsigned int io = task_handler_get_io(this_ptr, task);
+    unsigned long mem = task_handler_get_mem(this_ptr, task);
+
+    if ((this_ptr->pressure != NULL) && (this_ptr->running >=
+        pressure_get_limit(this_ptr->pressure, this_ptr->running))) {
+        return false;
+    }
+    if ((task->group != NULL) &&
+        (task->group->running >= task->group->limit)) {
+        return false;
+    }
+    if (this_ptr->io_used + io > this_ptr->io_budget) {
+        if (this_ptr->io_budget > 0u) {
+            return false;
+        }
+    }
+    if (this_ptr->mem_used + mem > this_ptr->mem_budget) {
+        if (this_ptr->mem_budget > 0u) {
+            return false;
+        }
+    }
+
+    if (task->group != NULL) {
+        task->group->running++;
+    }
+    this_ptr->running++;
+    this_ptr->io_used += io;
+    this_ptr->mem_used += mem;
+    return true;
+}
+
+/*!
+ * Releases the group and the resources of a finished task. The mutex must be
+ * locked by the caller.
+ *
+ * \param this_ptr - A pointer to the task handler.
+ * \param task - The finished task.
+ */
+void task_handler_release(task_handler_t *this_ptr, task_t *task)
+{
+    if (task->group != NULL) {
+        task->group->running--;
+    }
+    this_ptr->running--;
+    this_ptr->io_used -= task_handler_get_io(this_ptr, task);
+    this_ptr->mem_used -= task_handler_get_mem(this_ptr, task);
+}
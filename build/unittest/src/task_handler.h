@@ -0,0 +1,204 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_TASK_HANDLER_H_
+#define _SPEEDY_TASK_HANDLER_H_
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#define TASK_HANDLER_SUCCESS 0
+#define TASK_HANDLER_FAIL -1
+
+struct queue_t;
+struct thread_pool_t;
+struct thread_pool_group_t;
+struct hash_lookup_t;
+struct service_t;
+struct task_t;
+struct pressure_t;
+struct supervisor_t;
+struct timer_wheel_t;
+struct task_graph_t;
+struct task_graph_closure_t;
+struct timing_db_t;
+struct trace_t;
+
+/*! How the dependency cycles are broken. */
+typedef enum task_handler_cycle_t {
+    /*! The wants and after dependencies within a cycle are dropped first,
+     *  the tasks in the cycles that remain are skipped. */
+    TASK_HANDLER_CYCLE_WEAK,
+    /*! All the tasks in a cycle are skipped. */
+    TASK_HANDLER_CYCLE_SKIP
+} task_handler_cycle_t;
+
+/*!
+ * A named concurrency group, at most \c limit tasks in the group are running
+ * at the same time.
+ */
+typedef struct task_handler_group_t {
+    unsigned int id; /*!< The hashed name of the group. */
+    unsigned int limit; /*!< The maximum number of running tasks. */
+    unsigned int running; /*!< The number of running tasks. */
+} task_handler_group_t;
+
+typedef struct task_handler_t {
+    struct hash_lookup_t *task_lookup;
+    struct queue_t *tasks; /*!< Queue with all the tasks. */
+    /*! The group in the shared thread pool which executes the tasks. */
+    struct thread_pool_group_t *thread_pool_group;
+    /*! The concurrency groups which have a limit. */
+    struct queue_t *groups;
+    /*! \c true if any group limit or budget has been set, otherwise the
+     *  ready tasks are started directly. */
+    bool admission_control;
+    /*! Protects the admission state below. */
+    pthread_mutex_t mutex;
+    /*! Ready tasks which are waiting for their group or for resource
+     *  tokens, in the order that they became ready. */
+    struct queue_t *pending;
+    unsigned int pending_size; /*!< The number of pending tasks. */
+    unsigned int io_budget; /*!< The I/O tokens, 0 if unlimited. */
+    unsigned int io_used; /*!< The I/O tokens used by running tasks. */
+    unsigned long mem_budget; /*!< Memory in kilobytes, 0 if unlimited. */
+    unsigned long mem_used; /*!< The memory used by running tasks. */
+    /*! Limits the admission when the system is under pressure, \c NULL if
+     *  there aren't any pressure thresholds. */
+    struct pressure_t *pressure;
+    unsigned int running; /*!< The number of admitted running tasks. */
+    /*! Supervises the tasks which keep running after they are ready. */
+    struct supervisor_t *supervisor;
+    /*! Drives the timeouts of the running commands. */
+    struct timer_wheel_t *timer_wheel;
+    /*! The timeout in milliseconds of the services which don't have their
+     *  own timeout, 0 if there isn't any default timeout. */
+    unsigned int timeout;
+    /*! The names of the tasks that should be started together with their
+     *  dependencies, \c NULL if all the tasks should be started. */
+    struct queue_t *targets;
+    /*! \c true if tasks which require the same set of tasks should be
+     *  ordered after a common target instead. */
+    bool collapse;
+    /*! The services of the targets that have been created when collapsing
+     *  the dependencies. */
+    struct queue_t *collapsed;
+    /*! The services of the targets that have been created for the names
+     *  which are provided by several tasks. */
+    struct queue_t *providers;
+    /*! \c true if the dependencies which are implied by other dependencies
+     *  should be removed. */
+    bool reduce;
+    /*! How the dependency cycles are broken. */
+    task_handler_cycle_t cycle;
+    /*! \c true if the dependencies should only be calculated, no task is
+     *  started and no socket is opened. */
+    bool dry_run;
+    /*! \c true if the dry run is for a simulated boot, the dependencies are
+     *  then calculated as if every socket could be opened. */
+    bool simulate;
+    /*! The dependency graph which has been checked, \c NULL before the
+     *  dependencies have been calculated. */
+    struct task_graph_t *graph;
+    /*! The task of each node in the dependency graph. */
+    struct task_t **nodes;
+    /*! The transitive closure of the dependency graph, it is created by the
+     *  first query. */
+    struct task_graph_closure_t *closure;
+    /*! The directory where the process ids of the running services are
+     *  written, \c NULL if they aren't written. */
+    char *run_dir;
+    /*! The default time in milliseconds that a service gets to exit after
+     *  SIGTERM when it is stopped before it is killed. */
+    unsigned int stop_timeout;
+    /*! The durations of the tasks from the earlier boots, \c NULL if they
+     *  aren't recorded. */
+    struct timing_db_t *timing_db;
+    /*! \c true if only the provider which is expected to be ready first is
+     *  started when several tasks provide the same name. */
+    bool fastest_provider;
+    /*! Records the state transitions of the tasks, \c NULL if they aren't
+     *  traced. */
+    struct trace_t *trace;
+    /*! The file where the trace is written, \c NULL if there isn't any
+     *  trace. */
+    char *trace_path;
+    /*! The time when the dependencies were calculated, the times of the
+     *  tasks are counted from it. */
+    struct timespec start;
+} task_handler_t;
+
+task_handler_t * task_handler_create(struct thread_pool_t *thread_pool);
+int task_handler_init(task_handler_t *this_ptr,
+                      struct thread_pool_t *thread_pool);
+
+int task_handler_set_group_limit(task_handler_t *this_ptr, const char *group,
+                                 unsigned int limit);
+void task_handler_set_io_budget(task_handler_t *this_ptr, unsigned int io);
+void task_handler_set_mem_budget(task_handler_t *this_ptr, unsigned long mem);
+int task_handler_set_pressure_threshold(task_handler_t *this_ptr,
+                                        const char *resource,
+                                        double threshold);
+void task_handler_set_timeout(task_handler_t *this_ptr, unsigned int timeout);
+int task_handler_add_target(task_handler_t *this_ptr, const char *name);
+void task_handler_set_collapse(task_handler_t *this_ptr, bool collapse);
+void task_handler_set_reduce(task_handler_t *this_ptr, bool reduce);
+void task_handler_set_cycle(task_handler_t *this_ptr,
+                            task_handler_cycle_t cycle);
+void task_handler_set_dry_run(task_handler_t *this_ptr, bool dry_run);
+void task_handler_set_simulate(task_handler_t *this_ptr, bool simulate);
+int task_handler_set_run_dir(task_handler_t *this_ptr, const char *run_dir);
+void task_handler_set_stop_timeout(task_handler_t *this_ptr,
+                                   unsigned int timeout);
+int task_handler_set_timing_db(task_handler_t *this_ptr, const char *path);
+void task_handler_set_fastest_provider(task_handler_t *this_ptr,
+                                       bool fastest);
+int task_handler_set_trace(task_handler_t *this_ptr, const char *path);
+
+int task_handler_add_task(task_handler_t * this_ptr,struct service_t *service);
+int task_handler_add_tasks(task_handler_t *this_ptr,
+                        struct service_t *services, unsigned int services_size);
+int task_handler_calculate_dependency(task_handler_t * this_ptr);
+int task_handler_wait(task_handler_t * this_ptr);
+unsigned int task_handler_report(task_handler_t *this_ptr);
+void task_handler_supervise(task_handler_t *this_ptr);
+int task_handler_stop(task_handler_t *this_ptr);
+
+struct task_t **task_handler_get_dependencies(task_handler_t *this_ptr,
+                                              const char *name);
+struct task_t **task_handler_get_dependents(task_handler_t *this_ptr,
+                                            const char *name);
+bool task_handler_depends_on(task_handler_t *this_ptr, const char *name,
+                             const char *dependency);
+
+unsigned long task_handler_elapsed(task_handler_t *this_ptr);
+
+struct task_t *task_handler_thread_pool_pop(task_handler_t *this_ptr);
+void task_handler_run_add_task(task_handler_t *this_ptr, struct task_t *task);
+void task_handler_run_add_tasks(task_handler_t *this_ptr, struct task_t **tasks,
+                                unsigned int tasks_size);
+bool task_handler_admit(task_handler_t *this_ptr, struct task_t *task);
+void task_handler_release(task_handler_t *this_ptr, struct task_t *task);
+int task_handler_compare_priority(const void *first, const void *second);
+void task_handler_run_finish(task_handler_t *this_ptr, struct task_t *task,
+                             struct task_t **ready, unsigned int ready_size);
+
+void task_handler_deinit(task_handler_t * this_ptr);
+void task_handler_destroy(task_handler_t * this_ptr);
+
+
+#endif /* _SPEEDY_TASK_HANDLER_H_ */
@@ -0,0 +1,1629 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "core_type.h"
+#include "task_parser.h"
+#include "config_parser.h"
+#include "task_handler.h"
+#include "thread_pool.h"
+#include "queue.h"
+#include "hash.h"
+#include "hash_lookup.h"
+#include "stats.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+
+/*! Successful return  code for thread pool callback function. */
+#define TASK_PARSER_EXEC_SUCCESS 0
+/*! The prefix of the namespaces which declare targets. */
+#define TASK_PARSER_TARGET_PREFIX "target:"
+
+typedef enum namespace_t {
+    NAMESPACE_OPTIONS,
+    NAMESPACE_CONFIG
+} namespace_t;
+
+typedef enum config_options_t {
+    CONFIG_OPTIONS_DEPENDENCY,
+    CONFIG_OPTIONS_PATH,
+    CONFIG_OPTIONS_GROUP,
+    CONFIG_OPTIONS_IO,
+    CONFIG_OPTIONS_MEM,
+    CONFIG_OPTIONS_PRESSURE,
+    CONFIG_OPTIONS_TIMEOUT,
+    CONFIG_OPTIONS_COLLAPSE,
+    CONFIG_OPTIONS_REDUCE,
+    CONFIG_OPTIONS_CYCLE,
+    CONFIG_OPTIONS_RUNDIR,
+    CONFIG_OPTIONS_STOP_TIMEOUT,
+    CONFIG_OPTIONS_TIMINGDB,
+    CONFIG_OPTIONS_PROVIDERS,
+    CONFIG_OPTIONS_UNKOWN
+} config_options_t;
+
+typedef enum task_options_t {
+    TASK_OPTIONS_NAME,
+    TASK_OPTIONS_PROVIDES,
+    TASK_OPTIONS_DEPENDENCY,
+    TASK_OPTIONS_WANTS,
+    TASK_OPTIONS_AFTER,
+    TASK_OPTIONS_EXEC,
+    TASK_OPTIONS_TYPE,
+    TASK_OPTIONS_LISTEN,
+    TASK_OPTIONS_NICE,
+    TASK_OPTIONS_SCHED,
+    TASK_OPTIONS_IOCLASS,
+    TASK_OPTIONS_CPUS,
+    TASK_OPTIONS_GROUP,
+    TASK_OPTIONS_IO,
+    TASK_OPTIONS_MEM,
+    TASK_OPTIONS_TIMEOUT,
+    TASK_OPTIONS_STOP_TIMEOUT,
+    TASK_OPTIONS_DURATION,
+    TASK_OPTIONS_UNKOWN
+} task_options_t;
+
+/*!
+ * A simpler structure for tasks which doesn't have dependencies.
+ */
+typedef struct task_parser_simple_task_t {
+    /*!< A pointer to the task parser handle. */
+    task_parser_t *task_parser;
+    /*! A pointer to the functional call for the task. */
+    void (*task_exec)(void *argument);
+} task_parser_simple_task_t;
+
+/*!
+ * A simple structure for tasks which parse a single file.
+ */
+typedef struct task_parser_file_reader_t {
+    /*! C inheritance of a simple task.*/
+    task_parser_simple_task_t task;
+    /*! Filename for the configuration file. */
+    char *filename;
+    /*! The directory of the configuration file, relative paths in the
+     *  configuration file are relative to this directory. */
+    char *directory;
+    /*! Default namespace for the configuration file. */
+    char *default_namespace;
+    /*! Extracted value for the current namespace. */
+    namespace_t current_namespace_value;
+    /*! The current command when the current namespace is the options. */
+    config_options_t current_config_option;
+    /*! The current command when the current namespace is a task. */
+    task_options_t current_task_option;
+
+    service_t *current_task;
+
+    queue_t paths;
+
+    queue_t tasks;
+} task_parser_file_reader_t;
+
+/*!
+ * A simple structure for tasks which scans directory.
+ */
+typedef struct task_parser_dir_t {
+    /*! C inheritance of a simple task.*/
+    task_parser_simple_task_t task;
+    /*! A path to where the directory scanner should scan. */
+    char * path;
+
+    queue_t tasks;
+} task_parser_dir_t;
+
+
+static int task_parser_exec(void *task);
+
+static void task_parser_add_task(task_parser_t* this_ptr, service_t* task);
+
+static service_t* task_parser_create_task(void);
+static void task_parser_destroy_task(service_t *task);
+
+static char* task_parser_join_path(const char *path, const char *filename);
+static char** task_parser_add_argument(char **arguments,
+                                       const char *argument);
+static void task_parser_destroy_arguments(char **arguments);
+static void task_parser_request(task_parser_t *this_ptr, const char *name);
+static void task_parser_request_list(task_parser_t *this_ptr, char **names);
+static void task_parser_request_targets(task_parser_t *this_ptr,
+                                        queue_t *paths);
+
+static void task_parser_file_exec(void *argument);
+static void task_parser_file_destroy(task_parser_file_reader_t *read_file);
+static task_parser_file_reader_t* task_parser_file_create(
+        task_parser_t *this_ptr, char *filename, char *default_namespace);
+
+static char* task_parser_file_check_dependency(
+        task_parser_file_reader_t *read_file);
+static void task_parser_file_add_task(task_parser_file_reader_t *read_file);
+
+static void task_parser_file_start(void *handler);
+static void task_parser_file_end(void *handler);
+static void task_parser_file_namespace(void *handler, const char *name,
+                                       int line);
+static void task_parser_file_command(void *handler, const char *command);
+static void task_parser_file_argument(void *handler, const char *argument);
+static void task_parser_file_error(void *handler, const char* filename,
+                                   int line, const char *error_msg);
+
+static void task_parser_file_handle_options(
+        task_parser_file_reader_t *read_file, const char *argument);
+static void task_parser_file_handle_task_namespace(
+        task_parser_file_reader_t *read_file, const char *name, int line);
+static void task_parser_file_handle_task(task_parser_file_reader_t *read_file,
+                                         const char *argument);
+
+static namespace_t task_parser_get_namespace_value(const char *str_namespace);
+static config_options_t task_parser_get_config_options(const char* str_command);
+static task_options_t task_parser_get_task_options(const char* str_command);
+static service_type_t task_parser_get_type(const char *str_type);
+static int task_parser_get_nice(const char *str_nice);
+static service_sched_t task_parser_get_sched(const char *str_sched);
+static service_io_class_t task_parser_get_io_class(const char *str_io_class);
+static unsigned long task_parser_get_mem(const char *str_mem);
+static int task_parser_get_timeout(const char *str_timeout);
+static void task_parser_set_group_limit(task_parser_t *this_ptr,
+                                        const char *argument);
+static void task_parser_set_pressure(task_parser_t *this_ptr,
+                                     const char *argument);
+
+static void task_parser_dir_exec(void *arg);
+static void task_parser_dir_destroy(task_parser_dir_t *scan_dir);
+static task_parser_dir_t* task_parser_dir_create(task_parser_t *this_ptr,
+        queue_t *file_queue, const char *path);
+
+static char* task_parser_dir_find_file(task_parser_dir_t *scan_dir,
+                                       char *filename);
+static void task_parser_dir_read_file(task_parser_dir_t *scan_dir,
+                                      char *task);
+
+/*!
+ * Creates a task parser handle.
+ *
+ * \param handler - A pointer to the task handler where all the tasks should
+ *                  be registered.
+ * \param thread_pool - A pointer to the thread pool which executes the
+ *                      parser tasks.
+ *
+ * \return A pointer to the task parser handle if it was successfully created,
+ *         \c NULL otherwise.
+ */
+task_parser_t* task_parser_create(task_handler_t *handler,
+                                  thread_pool_t *thread_pool)
+{
+    task_parser_t *task_parser = malloc(sizeof(task_parser_t));
+
+    if (task_parser != NULL) {
+        task_parser->handler = handler;
+        task_parser->thread_pool_group = thread_pool_group_create(
+                                          thread_pool, task_parser_exec);
+
+        task_parser->mutex = malloc(sizeof(pthread_mutex_t));
+        pthread_mutex_init(task_parser->mutex, NULL);
+        task_parser->targets = NULL;
+        task_parser->paths = NULL;
+        task_parser->requested = NULL;
+
+        if (task_parser->thread_pool_group == NULL) {
+            pthread_mutex_destroy(task_parser->mutex);
+            free(task_parser->mutex);
+            free(task_parser);
+            task_parser = NULL;
+        }
+    }
+    return task_parser;
+}
+
+/*!
+ * Adds a target, when there are targets only the targets and the tasks that
+ * they require or want are read from the configuration and started. The
+ * targets must be added before the configuration is read.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ * \param name - The name of the target task.
+ *
+ * \return \c TASK_HANDLER_SUCCESS if the target was added,
+ *         \c TASK_HANDLER_FAIL otherwise.
+ */
+int task_parser_add_target(task_parser_t *this_ptr, const char *name)
+{
+    char *target;
+
+    if (this_ptr->targets == NULL) {
+        this_ptr->targets = queue_create();
+        this_ptr->paths = queue_create();
+        this_ptr->requested = hash_lookup_create(64);
+    }
+
+    target = strdup(name);
+    if ((this_ptr->targets == NULL) || (this_ptr->paths == NULL) ||
+        (this_ptr->requested == NULL) || (target == NULL) ||
+        (queue_push(this_ptr->targets, target) != QUEUE_SUCESS)) {
+        free(target);
+        return TASK_HANDLER_FAIL;
+    }
+    return task_handler_add_target(this_ptr->handler, name);
+}
+
+/*!
+ * Creates a task which reads a config file.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ * \param filename - The config file.
+ */
+void task_parser_read(task_parser_t *this_ptr, const char * filename)
+{
+    task_parser_file_reader_t *read_file;
+    read_file = task_parser_file_create(this_ptr, strdup(filename),
+                                          strdup("default"));
+    if (read_file != NULL) {
+        thread_pool_group_add_task(this_ptr->thread_pool_group, read_file);
+    }
+}
+
+/*!
+ * Waits until the thread pool has executed all the parser tasks.
+ *
+ * \param this_ptr - A pointer to the task parser.
+ */
+void task_parser_wait(task_parser_t* this_ptr)
+{
+    thread_pool_group_wait(this_ptr->thread_pool_group);
+}
+
+/*!
+ * Destroys and deallocates a task parser handle.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ */
+void task_parser_destroy(task_parser_t *task_parser)
+{
+    char *name;
+
+    thread_pool_group_destroy(task_parser->thread_pool_group);
+    if (task_parser->targets != NULL) {
+        while ((name = queue_pop(task_parser->targets)) != NULL) {
+            free(name);
+        }
+        queue_destroy(task_parser->targets);
+    }
+    if (task_parser->paths != NULL) {
+        while ((name = queue_pop(task_parser->paths)) != NULL) {
+            free(name);
+        }
+        queue_destroy(task_parser->paths);
+    }
+    if (task_parser->requested != NULL) {
+        hash_lookup_destroy(task_parser->requested);
+    }
+    pthread_mutex_destroy(task_parser->mutex);
+    free(task_parser->mutex);
+    free(task_parser);
+}
+
+/*!
+ * This is callback from the thread pool which sends the next task that should
+ * be executed as an argument.
+ *
+ * \param task - A pointer to \c task_parser_simple_task_t struct.
+ *
+ * \return \c TASK_PARSER_EXEC_SUCCESS if the task executed successfully.
+ */
+static int task_parser_exec(void *task)
+{
+    task_parser_simple_task_t *simple_task = (task_parser_simple_task_t*) task;
+    simple_task->task_exec(simple_task);
+
+    return TASK_PARSER_EXEC_SUCCESS;
+}
+
+static void task_parser_add_task(task_parser_t* this_ptr, service_t* task)
+{
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_TASK_PARSER, this_ptr->mutex);
+    task_handler_add_task(this_ptr->handler, task);
+    stats_unlock(STATS_LOCK_TASK_PARSER, this_ptr->mutex, locked);
+}
+
+/*!
+ * Creates a path to a file in a directory.
+ *
+ * \param path - The directory.
+ * \param filename - The name of the file in the directory.
+ *
+ * \return The path to the file, it needs to be deallocated by the caller.
+ */
+static char* task_parser_join_path(const char *path, const char *filename)
+{
+    char *full_path;
+    char *next;
+
+    full_path = malloc(strlen(path) + strlen(filename) + 2u);
+    if (full_path != NULL) {
+        full_path[0] = '\0';
+        next = strcat(full_path, path);
+        next = strcat(next, "/");
+        (void) strcat(next, filename);
+    }
+    return full_path;
+}
+
+/*!
+ * Adds an argument to a \c NULL terminated argument list.
+ *
+ * \param arguments - The argument list, \c NULL if it is empty.
+ * \param argument - The argument that is added to the list.
+ *
+ * \return The argument list with the new argument.
+ */
+static char** task_parser_add_argument(char **arguments, const char *argument)
+{
+    char **new_arguments;
+    size_t size = 0u;
+
+    if (arguments != NULL) {
+        while (arguments[size] != NULL) {
+            size++;
+        }
+    }
+
+    new_arguments = realloc(arguments, sizeof(char*) * (size + 2u));
+    if (new_arguments != NULL) {
+        new_arguments[size] = strdup(argument);
+        new_arguments[size + 1u] = NULL;
+        return new_arguments;
+    }
+    return arguments;
+}
+
+/*!
+ * Deallocates a \c NULL terminated argument list.
+ *
+ * \param arguments - The argument list.
+ */
+static void task_parser_destroy_arguments(char **arguments)
+{
+    char **argument = arguments;
+
+    if (arguments != NULL) {
+        while (*argument != NULL) {
+            free(*argument);
+            argument++;
+        }
+        free(arguments);
+    }
+}
+
+/*!
+ * Reads the file of a task when there are targets, unless the task already
+ * has been looked for. The file is looked for in the paths from the
+ * configuration in order, and the first file that is found is read.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ * \param name - The name of the task.
+ */
+static void task_parser_request(task_parser_t *this_ptr, const char *name)
+{
+    task_parser_file_reader_t *read_file;
+    unsigned int id = hash_generate(name);
+    bool found = false;
+    char *filename;
+    char *path;
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_TASK_PARSER, this_ptr->mutex);
+    if (hash_lookup_find(this_ptr->requested, id) != NULL) {
+        stats_unlock(STATS_LOCK_TASK_PARSER, this_ptr->mutex, locked);
+        return;
+    }
+    hash_lookup_insert(this_ptr->requested, id, this_ptr);
+
+    queue_first(this_ptr->paths);
+    while (!found && ((path = queue_get_current(this_ptr->paths)) != NULL)) {
+        filename = task_parser_join_path(path, name);
+
+        if ((filename != NULL) && (access(filename, R_OK) == 0)) {
+            found = true;
+            read_file = task_parser_file_create(this_ptr, filename,
+                                                strdup(name));
+            if (read_file != NULL) {
+                queue_push(&read_file->tasks, strdup(name));
+                thread_pool_group_add_task(this_ptr->thread_pool_group,
+                                           read_file);
+            }
+        } else {
+            free(filename);
+        }
+        queue_next(this_ptr->paths);
+    }
+    stats_unlock(STATS_LOCK_TASK_PARSER, this_ptr->mutex, locked);
+
+    if (!found) {
+        printf("Missing task: %s\n", name);
+    }
+}
+
+/*!
+ * Reads the files of a \c NULL terminated list of tasks.
+ */
+static void task_parser_request_list(task_parser_t *this_ptr, char **names)
+{
+    if (names != NULL) {
+        while (*names != NULL) {
+            task_parser_request(this_ptr, *names);
+            names++;
+        }
+    }
+}
+
+/*!
+ * Adds the paths from the configuration to the paths where the task files
+ * are looked for and reads the files of the targets.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ * \param paths - The paths from the configuration, they are moved.
+ */
+static void task_parser_request_targets(task_parser_t *this_ptr,
+                                        queue_t *paths)
+{
+    char *target;
+    char *path;
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_TASK_PARSER, this_ptr->mutex);
+    while ((path = queue_pop(paths)) != NULL) {
+        queue_push(this_ptr->paths, path);
+    }
+    stats_unlock(STATS_LOCK_TASK_PARSER, this_ptr->mutex, locked);
+
+    /* The targets don't change while the configuration is read. */
+    queue_first(this_ptr->targets);
+    while ((target = queue_get_current(this_ptr->targets)) != NULL) {
+        task_parser_request(this_ptr, target);
+        queue_next(this_ptr->targets);
+    }
+}
+
+/*****************************************************************************/
+/* Functions to parse a configuration file.                                  */
+/*****************************************************************************/
+
+/*!
+ * This is a task which reads a config file.
+ *
+ * \param arg - A pointer to the arguments that the task needs.
+ */
+static void task_parser_file_exec(void *arg)
+{
+    task_parser_file_reader_t *read_file = arg;
+    config_handler_t handler;
+
+    handler.handler = read_file;
+    handler.func_start_config = task_parser_file_start;
+    handler.func_end_config = task_parser_file_end;
+    handler.func_namespace = task_parser_file_namespace;
+    handler.func_command = task_parser_file_command;
+    handler.func_argument = task_parser_file_argument;
+    handler.func_error = task_parser_file_error;
+
+    printf("Scanning: %s\n", read_file->filename);
+
+    if (config_parser_read_file(read_file->filename, &handler) ==
+        PARSER_MISSING_FILE) {
+
+        printf("Missing file: %s\n", read_file->filename);
+    }
+
+    task_parser_file_destroy(read_file);
+}
+
+/*!
+ * Creates a simple task which will parse a file.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ * \param filename - Filename of the file that needs to be parsed.
+ * \param default_namespace - The namespace that is used until the first
+ *                            namespace in the file.
+ *
+ * \return A simple task which will read a file.
+ */
+static task_parser_file_reader_t* task_parser_file_create(
+                                       task_parser_t *this_ptr,
+                                       char *filename,
+                                       char *default_namespace)
+{
+    task_parser_file_reader_t *read_file;
+    char *separator;
+
+    read_file = malloc(sizeof(task_parser_file_reader_t));
+
+    if (read_file != NULL) {
+        read_file->task.task_parser = this_ptr;
+        read_file->filename = filename;
+        read_file->task.task_exec = task_parser_file_exec;
+        read_file->default_namespace = default_namespace;
+        read_file->current_namespace_value = NAMESPACE_CONFIG;
+        read_file->current_config_option = CONFIG_OPTIONS_UNKOWN;
+        read_file->current_task_option = TASK_OPTIONS_UNKOWN;
+
+        separator = strrchr(filename, '/');
+        if (separator != NULL) {
+            read_file->directory = strndup(filename, separator - filename);
+        } else {
+            read_file->directory = strdup(".");
+        }
+
+        queue_init(&read_file->tasks);
+        queue_init(&read_file->paths);
+
+        read_file->current_task = NULL;
+
+    } else {
+        free(filename);
+        free(default_namespace);
+    }
+
+    return read_file;
+}
+
+/*!
+ * Destroys and deallocates a read file task.
+ * If there were any paths detected in the configuration file it will now
+ * start up a task which will search for files in a directory.
+ *
+ * \param read_file - A pointer to the read file task.
+ */
+static void task_parser_file_destroy(task_parser_file_reader_t *read_file)
+{
+    char* path;
+    char* task;
+
+    if (read_file->current_task != NULL) {
+        task_parser_file_add_task(read_file);
+    }
+
+    /* With targets the task files are looked for in the paths when they are
+       needed instead of scanning for the tasks in the configuration. */
+    if ((read_file->task.task_parser->targets != NULL) &&
+        (queue_first(&read_file->paths) == QUEUE_SUCESS)) {
+        task_parser_request_targets(read_file->task.task_parser,
+                                    &read_file->paths);
+    }
+
+    /* Free all the option paths. */
+    while((path = queue_pop(&read_file->paths)) != NULL) {
+
+        task_parser_dir_t *scan_dir;
+        scan_dir = task_parser_dir_create(read_file->task.task_parser,
+                                                 &read_file->tasks,
+                                                 path);
+        if (scan_dir != NULL) {
+            thread_pool_group_add_task(
+                    read_file->task.task_parser->thread_pool_group, scan_dir);
+        }
+        free(path);
+    }
+    queue_deinit(&read_file->paths);
+
+    /* Free all the remaining tasks, the tasks have been copied to the
+       directory scanners which report the tasks that are missing. */
+    while((task = queue_pop(&read_file->tasks)) != NULL) {
+        free(task);
+    }
+    queue_deinit(&read_file->tasks);
+
+    free(read_file->default_namespace);
+    free(read_file->directory);
+    free(read_file->filename);
+    free(read_file);
+}
+
+
+static char* task_parser_file_check_dependency(
+        task_parser_file_reader_t *read_file)
+{
+    char* current_task;
+
+    queue_first(&read_file->tasks);
+    while ((current_task = queue_get_current(&read_file->tasks)) != NULL) {
+        if (strcmp(read_file->current_task->name, current_task) == 0) {
+            queue_remove_current(&read_file->tasks);
+            return current_task;
+        }
+        queue_next(&read_file->tasks);
+    }
+    return NULL;
+}
+
+/*!
+ * Adds the current task to the task handler if it is one of the tasks that
+ * the file is expected to contain, otherwise the task is discarded.
+ *
+ * \param read_file - Contains the local settings for the current
+ *                    parser task.
+ */
+static void task_parser_file_add_task(task_parser_file_reader_t *read_file)
+{
+    char* dependency = task_parser_file_check_dependency(read_file);
+
+    if (dependency != NULL) {
+        /* Read the tasks that the task needs when there are targets, the
+           tasks that it is only ordered after aren't read. */
+        if (read_file->task.task_parser->targets != NULL) {
+            task_parser_request_list(read_file->task.task_parser,
+                                     read_file->current_task->dependency);
+            task_parser_request_list(read_file->task.task_parser,
+                                     read_file->current_task->wants);
+        }
+
+        /* Add task. */
+        task_parser_add_task(read_file->task.task_parser,
+                             read_file->current_task);
+        free(dependency);
+    } else {
+        task_parser_destroy_task(read_file->current_task);
+    }
+    read_file->current_task = NULL;
+}
+
+/*!
+ * Create a new task and initialize it.
+ */
+static service_t* task_parser_create_task(void)
+{
+    service_t *task = malloc(sizeof(service_t));
+
+    if (task != NULL) {
+        service_init(task);
+    }
+    return task;
+}
+
+static void task_parser_destroy_task(service_t *task)
+{
+    if (task != NULL) {
+        free(task->name);
+        task_parser_destroy_arguments(task->dependency);
+        task_parser_destroy_arguments(task->wants);
+        task_parser_destroy_arguments(task->after);
+        free(task->provides);
+        free(task->exec);
+        task_parser_destroy_arguments(task->listen);
+        free(task->cpus);
+        free(task->group);
+        free(task->file);
+        free(task);
+    }
+}
+
+/*!
+ * Callback from the config parser when it starts to parse a file.
+ *
+ * \param handler - A pointer to the read file task.
+ */
+static void task_parser_file_start(void *handler)
+{
+    task_parser_file_reader_t *read_file = handler;
+
+    /* Everything before the first namespace belongs to the default
+       namespace, which isn't declared on any line. */
+    task_parser_file_namespace(read_file, read_file->default_namespace, 0);
+}
+
+/*!
+ * Callback from the config parser when the whole file has been parsed.
+ *
+ * \param handler - A pointer to the read file task.
+ */
+static void task_parser_file_end(void *handler)
+{
+    (void) handler;
+}
+
+/*!
+ * Callback from the config parser when a namespace has been parsed.
+ *
+ * \param handler - A pointer to the read file task.
+ * \param name - The name of the namespace.
+ * \param line - The line where the namespace is declared.
+ */
+static void task_parser_file_namespace(void *handler, const char *name,
+                                       int line)
+{
+    task_parser_file_reader_t *read_file = handler;
+
+    read_file->current_namespace_value = task_parser_get_namespace_value(name);
+    read_file->current_config_option = CONFIG_OPTIONS_UNKOWN;
+    read_file->current_task_option = TASK_OPTIONS_UNKOWN;
+
+    if (read_file->current_namespace_value == NAMESPACE_CONFIG) {
+        task_parser_file_handle_task_namespace(read_file, name, line);
+    }
+}
+
+/*!
+ * Callback from the config parser when a command has been parsed.
+ *
+ * \param handler - A pointer to the read file task.
+ * \param command - The command.
+ */
+static void task_parser_file_command(void *handler, const char *command)
+{
+    task_parser_file_reader_t *read_file = handler;
+
+    switch (read_file->current_namespace_value) {
+        case NAMESPACE_OPTIONS:
+            read_file->current_config_option =
+                    task_parser_get_config_options(command);
+            break;
+
+        case NAMESPACE_CONFIG:
+            read_file->current_task_option =
+                    task_parser_get_task_options(command);
+
+            /* A new command replaces the value from a previous one. */
+            if (read_file->current_task_option == TASK_OPTIONS_DEPENDENCY) {
+                task_parser_destroy_arguments(
+                        read_file->current_task->dependency);
+                read_file->current_task->dependency = NULL;
+
+            } else if (read_file->current_task_option ==
+                       TASK_OPTIONS_WANTS) {
+                task_parser_destroy_arguments(
+                        read_file->current_task->wants);
+                read_file->current_task->wants = NULL;
+
+            } else if (read_file->current_task_option ==
+                       TASK_OPTIONS_AFTER) {
+                task_parser_destroy_arguments(
+                        read_file->current_task->after);
+                read_file->current_task->after = NULL;
+
+            } else if (read_file->current_task_option ==
+                       TASK_OPTIONS_LISTEN) {
+                task_parser_destroy_arguments(
+                        read_file->current_task->listen);
+                read_file->current_task->listen = NULL;
+
+            } else if (read_file->current_task_option == TASK_OPTIONS_EXEC) {
+                free(read_file->current_task->exec);
+                read_file->current_task->exec = NULL;
+
+            } else if (read_file->current_task_option ==
+                       TASK_OPTIONS_IOCLASS) {
+                read_file->current_task->io_class = SERVICE_IO_CLASS_NOT_SET;
+                read_file->current_task->io_priority = SERVICE_NOT_SET;
+            }
+            break;
+
+        default:
+            /* Do nothing. */
+            break;
+    }
+}
+
+/*!
+ * Callback from the config parser when an argument has been parsed.
+ *
+ * \param handler - A pointer to the read file task.
+ * \param argument - The argument.
+ */
+static void task_parser_file_argument(void *handler, const char *argument)
+{
+    task_parser_file_reader_t *read_file = handler;
+
+    switch (read_file->current_namespace_value) {
+        case NAMESPACE_OPTIONS:
+            task_parser_file_handle_options(read_file, argument);
+            break;
+
+        case NAMESPACE_CONFIG:
+            task_parser_file_handle_task(read_file, argument);
+            break;
+
+        default:
+            /* Do nothing. */
+            break;
+    }
+}
+
+/*!
+ * Callback from the config parser when an error has been detected.
+ *
+ * \param handler - A pointer to the read file task.
+ * \param filename - The file where the error was detected.
+ * \param line - The line where the error was detected.
+ * \param error_msg - A description of the error.
+ */
+static void task_parser_file_error(void *handler, const char* filename,
+                                   int line, const char *error_msg)
+{
+    (void) handler;
+    printf("Error: %s:%d: %s\n", filename, line, error_msg);
+}
+
+/*!
+ * Handles any options which has been parsed from the configuration.
+ *
+ * \param read_file - Contains the local settings for the current
+ *                    parser task.
+ * \param argument - The argument for the current option.
+ */
+static void task_parser_file_handle_options(
+        task_parser_file_reader_t *read_file, const char *argument)
+{
+    int timeout;
+
+    switch (read_file->current_config_option) {
+        case CONFIG_OPTIONS_DEPENDENCY:
+            queue_push(&read_file->tasks, strdup(argument));
+            break;
+
+        case CONFIG_OPTIONS_PATH:
+            /* Relative paths are relative to the configuration file. */
+            if (argument[0] == '/') {
+                queue_push(&read_file->paths, strdup(argument));
+            } else {
+                queue_push(&read_file->paths, task_parser_join_path(
+                           read_file->directory, argument));
+            }
+            break;
+
+        case CONFIG_OPTIONS_GROUP:
+            task_parser_set_group_limit(read_file->task.task_parser, argument);
+            break;
+
+        case CONFIG_OPTIONS_IO:
+            task_handler_set_io_budget(read_file->task.task_parser->handler,
+                                       (unsigned int) atoi(argument));
+            break;
+
+        case CONFIG_OPTIONS_MEM:
+            task_handler_set_mem_budget(read_file->task.task_parser->handler,
+                                        task_parser_get_mem(argument));
+            break;
+
+        case CONFIG_OPTIONS_PRESSURE:
+            task_parser_set_pressure(read_file->task.task_parser, argument);
+            break;
+
+        case CONFIG_OPTIONS_TIMEOUT:
+            timeout = task_parser_get_timeout(argument);
+            if (timeout != SERVICE_NOT_SET) {
+                task_handler_set_timeout(read_file->task.task_parser->handler,
+                                         (unsigned int) timeout);
+            }
+            break;
+
+        case CONFIG_OPTIONS_COLLAPSE:
+            task_handler_set_collapse(read_file->task.task_parser->handler,
+                                      strcmp(argument, "yes") == 0);
+            break;
+
+        case CONFIG_OPTIONS_REDUCE:
+            task_handler_set_reduce(read_file->task.task_parser->handler,
+                                    strcmp(argument, "yes") == 0);
+            break;
+
+        case CONFIG_OPTIONS_CYCLE:
+            /* The wants and after dependencies are dropped first unless all
+               the tasks in a cycle should be skipped. */
+            task_handler_set_cycle(read_file->task.task_parser->handler,
+                                   (strcmp(argument, "skip") == 0) ?
+                                   TASK_HANDLER_CYCLE_SKIP :
+                                   TASK_HANDLER_CYCLE_WEAK);
+            break;
+
+        case CONFIG_OPTIONS_RUNDIR:
+            task_handler_set_run_dir(read_file->task.task_parser->handler,
+                                     argument);
+            break;
+
+        case CONFIG_OPTIONS_STOP_TIMEOUT:
+            timeout = task_parser_get_timeout(argument);
+            if (timeout != SERVICE_NOT_SET) {
+                task_handler_set_stop_timeout(
+                    read_file->task.task_parser->handler,
+                    (unsigned int) timeout);
+            }
+            break;
+
+        case CONFIG_OPTIONS_TIMINGDB:
+            if (task_handler_set_timing_db(read_file->task.task_parser->handler,
+                                           argument) != TASK_HANDLER_SUCCESS) {
+                printf("Could not open the timing database %s\n", argument);
+            }
+            break;
+
+        case CONFIG_OPTIONS_PROVIDERS:
+            /* All the providers are started unless only the fastest one
+               should be. */
+            task_handler_set_fastest_provider(
+                read_file->task.task_parser->handler,
+                strcmp(argument, "fastest") == 0);
+            break;
+
+        case CONFIG_OPTIONS_UNKOWN:
+        default:
+            break;
+    }
+}
+
+/*!
+ * Handles a new task namespace which has been parsed from the configuration.
+ *
+ * \param read_file - Contains the local settings for the current
+ *                 parser task.
+ * \param name - The name of the namespace which is the name of the task.
+ * \param line - The line where the namespace is declared.
+ */
+static void task_parser_file_handle_task_namespace(
+        task_parser_file_reader_t *read_file, const char *name, int line)
+{
+    bool target = false;
+
+    /* A target namespace is named "target:name", the target is referred to
+       by the name only. */
+    if (strncmp(name, TASK_PARSER_TARGET_PREFIX,
+                strlen(TASK_PARSER_TARGET_PREFIX)) == 0) {
+        name += strlen(TASK_PARSER_TARGET_PREFIX);
+        target = true;
+    }
+
+    if ((read_file->current_task != NULL) &&
+        (strcmp(name, read_file->current_task->name) != 0)) {
+
+        /* Add the current task object. */
+        task_parser_file_add_task(read_file);
+    }
+
+    if (read_file->current_task == NULL) {
+        /* Create a new task object and name it according to the
+           new namespace. */
+        read_file->current_task = task_parser_create_task();
+        read_file->current_task->name = strdup(name);
+        read_file->current_task->file = strdup(read_file->filename);
+    }
+    /* The task is declared where its namespace first appears in the file. */
+    if (read_file->current_task->line == 0) {
+        read_file->current_task->line = line;
+    }
+    if (target) {
+        read_file->current_task->type = SERVICE_TYPE_TARGET;
+    }
+}
+
+/*!
+ * Handles a task which has been parsed from the configuration.
+ *
+ * \param read_file - Contains the local settings for the current
+ *                 parser task.
+ * \param argument - The argument for the current task command.
+ */
+static void task_parser_file_handle_task(task_parser_file_reader_t *read_file,
+                                         const char *argument)
+{
+    service_t *task = read_file->current_task;
+    size_t length;
+
+    switch (read_file->current_task_option) {
+        case TASK_OPTIONS_DEPENDENCY:
+            task->dependency = task_parser_add_argument(task->dependency,
+                                                        argument);
+            break;
+
+        case TASK_OPTIONS_WANTS:
+            task->wants = task_parser_add_argument(task->wants, argument);
+            break;
+
+        case TASK_OPTIONS_AFTER:
+            task->after = task_parser_add_argument(task->after, argument);
+            break;
+
+        case TASK_OPTIONS_PROVIDES:
+            if (task->provides == NULL) {
+                task->provides = strdup(argument);
+            } else {
+                printf("%s: Only one provides is supported.\n", task->name);
+            }
+            break;
+
+        case TASK_OPTIONS_EXEC:
+            /* The arguments are joined into a single shell command. */
+            if (task->exec == NULL) {
+                task->exec = strdup(argument);
+            } else {
+                length = strlen(task->exec);
+                task->exec = realloc(task->exec,
+                                     length + strlen(argument) + 2);
+                task->exec[length] = ' ';
+                strcpy(&task->exec[length + 1], argument);
+            }
+            break;
+
+        case TASK_OPTIONS_TYPE:
+            task->type = task_parser_get_type(argument);
+            break;
+
+        case TASK_OPTIONS_LISTEN:
+            task->listen = task_parser_add_argument(task->listen, argument);
+            break;
+
+        case TASK_OPTIONS_NICE:
+            task->nice = task_parser_get_nice(argument);
+            if (task->nice == SERVICE_NOT_SET) {
+                printf("%s: Invalid nice value %s.\n", task->name, argument);
+            }
+            break;
+
+        case TASK_OPTIONS_SCHED:
+            task->sched = task_parser_get_sched(argument);
+            if (task->sched == SERVICE_SCHED_NOT_SET) {
+                printf("%s: Invalid sched %s.\n", task->name, argument);
+            }
+            break;
+
+        case TASK_OPTIONS_IOCLASS:
+            /* The first argument is the class and the optional second
+               argument is the priority within the class. */
+            if (task->io_class == SERVICE_IO_CLASS_NOT_SET) {
+                task->io_class = task_parser_get_io_class(argument);
+                if (task->io_class == SERVICE_IO_CLASS_NOT_SET) {
+                    printf("%s: Invalid ioclass %s.\n", task->name,
+                           argument);
+                }
+            } else {
+                task->io_priority = atoi(argument);
+            }
+            break;
+
+        case TASK_OPTIONS_CPUS:
+            free(task->cpus);
+            task->cpus = strdup(argument);
+            break;
+
+        case TASK_OPTIONS_GROUP:
+            free(task->group);
+            task->group = strdup(argument);
+            break;
+
+        case TASK_OPTIONS_IO:
+            task->io = (unsigned int) atoi(argument);
+            break;
+
+        case TASK_OPTIONS_MEM:
+            task->mem = task_parser_get_mem(argument);
+            break;
+
+        case TASK_OPTIONS_TIMEOUT:
+            task->timeout = task_parser_get_timeout(argument);
+            break;
+
+        case TASK_OPTIONS_STOP_TIMEOUT:
+            task->stop_timeout = task_parser_get_timeout(argument);
+            break;
+
+        case TASK_OPTIONS_DURATION:
+            task->duration = task_parser_get_timeout(argument);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*!
+ * Gets the config namespace value from a string.
+ * \note This is separated here for readability.
+ *
+ * \param str_namespace - A string which needs to be transformed into an
+ *                        integer value.
+ *
+ * \return The string value represented as an integer value.
+ */
+static namespace_t task_parser_get_namespace_value(const char *str_namespace)
+{
+    if (strcmp(str_namespace, "options") == 0) {
+        return NAMESPACE_OPTIONS;
+
+    } else {
+        return NAMESPACE_CONFIG;
+    }
+}
+
+/*!
+ * Gets the config option value from a string.
+ * \note This is separated here for readability.
+ *
+ * \param str_command - A string which needs to be transformed into an
+ *                      integer value.
+ *
+ * \return The string value represented as an integer value.
+ */
+static config_options_t task_parser_get_config_options(const char* command)
+{
+    if (strcmp(command, "dependency") == 0) {
+        return CONFIG_OPTIONS_DEPENDENCY;
+
+    } else if (strcmp(command, "path") == 0) {
+        return CONFIG_OPTIONS_PATH;
+
+    } else if (strcmp(command, "group") == 0) {
+        return CONFIG_OPTIONS_GROUP;
+
+    } else if (strcmp(command, "io") == 0) {
+        return CONFIG_OPTIONS_IO;
+
+    } else if (strcmp(command, "mem") == 0) {
+        return CONFIG_OPTIONS_MEM;
+
+    } else if (strcmp(command, "pressure") == 0) {
+        return CONFIG_OPTIONS_PRESSURE;
+
+    } else if (strcmp(command, "timeout") == 0) {
+        return CONFIG_OPTIONS_TIMEOUT;
+
+    } else if (strcmp(command, "collapse") == 0) {
+        return CONFIG_OPTIONS_COLLAPSE;
+
+    } else if (strcmp(command, "reduce") == 0) {
+        return CONFIG_OPTIONS_REDUCE;
+
+    } else if (strcmp(command, "cycle") == 0) {
+        return CONFIG_OPTIONS_CYCLE;
+
+    } else if (strcmp(command, "rundir") == 0) {
+        return CONFIG_OPTIONS_RUNDIR;
+
+    } else if (strcmp(command, "stop_timeout") == 0) {
+        return CONFIG_OPTIONS_STOP_TIMEOUT;
+
+    } else if (strcmp(command, "timingdb") == 0) {
+        return CONFIG_OPTIONS_TIMINGDB;
+
+    } else if (strcmp(command, "providers") == 0) {
+        return CONFIG_OPTIONS_PROVIDERS;
+
+    } else {
+        return CONFIG_OPTIONS_UNKOWN;
+    }
+}
+
+/*!
+ * Gets the config option value from a string.
+ * \note This is separated here for readability.
+ *
+ * \param str_command - A string which needs to be transformed into an
+ *                      integer value.
+ *
+ * \return The string value represented as an integer value.
+ */
+static task_options_t task_parser_get_task_options(const char* command)
+{
+    /* The dependency command is an alias for requires. */
+    if ((strcmp(command, "requires") == 0) ||
+        (strcmp(command, "dependency") == 0)) {
+        return TASK_OPTIONS_DEPENDENCY;
+
+    } else if (strcmp(command, "wants") == 0) {
+        return TASK_OPTIONS_WANTS;
+
+    } else if (strcmp(command, "after") == 0) {
+        return TASK_OPTIONS_AFTER;
+
+    } else if (strcmp(command, "provides") == 0) {
+        return TASK_OPTIONS_PROVIDES;
+
+    } else if (strcmp(command, "exec") == 0) {
+        return TASK_OPTIONS_EXEC;
+
+    } else if (strcmp(command, "type") == 0) {
+        return TASK_OPTIONS_TYPE;
+
+    } else if (strcmp(command, "listen") == 0) {
+        return TASK_OPTIONS_LISTEN;
+
+    } else if (strcmp(command, "nice") == 0) {
+        return TASK_OPTIONS_NICE;
+
+    } else if (strcmp(command, "sched") == 0) {
+        return TASK_OPTIONS_SCHED;
+
+    } else if (strcmp(command, "ioclass") == 0) {
+        return TASK_OPTIONS_IOCLASS;
+
+    } else if (strcmp(command, "cpus") == 0) {
+        return TASK_OPTIONS_CPUS;
+
+    } else if (strcmp(command, "group") == 0) {
+        return TASK_OPTIONS_GROUP;
+
+    } else if (strcmp(command, "io") == 0) {
+        return TASK_OPTIONS_IO;
+
+    } else if (strcmp(command, "mem") == 0) {
+        return TASK_OPTIONS_MEM;
+
+    } else if (strcmp(command, "timeout") == 0) {
+        return TASK_OPTIONS_TIMEOUT;
+
+    } else if (strcmp(command, "stop_timeout") == 0) {
+        return TASK_OPTIONS_STOP_TIMEOUT;
+
+    } else if (strcmp(command, "duration") == 0) {
+        return TASK_OPTIONS_DURATION;
+
+    } else {
+        return TASK_OPTIONS_UNKOWN;
+    }
+}
+
+/*!
+ * Gets the service type from a string.
+ *
+ * \param str_type - A string which needs to be transformed into an
+ *                   integer value.
+ *
+ * \return The string value represented as an integer value.
+ */
+static service_type_t task_parser_get_type(const char *str_type)
+{
+    if (strcmp(str_type, "notify") == 0) {
+        return SERVICE_TYPE_NOTIFY;
+
+    } else if (strcmp(str_type, "target") == 0) {
+        return SERVICE_TYPE_TARGET;
+
+    } else {
+        return SERVICE_TYPE_ONESHOT;
+    }
+}
+
+/*!
+ * Gets the nice value from a string.
+ *
+ * \param str_nice - A nice value between -20 and 19.
+ *
+ * \return The nice value or \c SERVICE_NOT_SET if it isn't valid.
+ */
+static int task_parser_get_nice(const char *str_nice)
+{
+    char *end;
+    long nice = strtol(str_nice, &end, 10);
+
+    if ((end == str_nice) || (*end != '\0') || (nice < -20) || (nice > 19)) {
+        return SERVICE_NOT_SET;
+    }
+    return (int) nice;
+}
+
+/*!
+ * Gets the CPU scheduling policy from a string.
+ *
+ * \param str_sched - A string which needs to be transformed into an
+ *                    integer value.
+ *
+ * \return The string value represented as an integer value.
+ */
+static service_sched_t task_parser_get_sched(const char *str_sched)
+{
+    if (strcmp(str_sched, "idle") == 0) {
+        return SERVICE_SCHED_IDLE;
+
+    } else if (strcmp(str_sched, "batch") == 0) {
+        return SERVICE_SCHED_BATCH;
+
+    } else if (strcmp(str_sched, "other") == 0) {
+        return SERVICE_SCHED_OTHER;
+
+    } else {
+        return SERVICE_SCHED_NOT_SET;
+    }
+}
+
+/*!
+ * Gets the I/O scheduling class from a string.
+ *
+ * \param str_io_class - A string which needs to be transformed into an
+ *                       integer value.
+ *
+ * \return The string value represented as an integer value.
+ */
+static service_io_class_t task_parser_get_io_class(const char *str_io_class)
+{
+    if (strcmp(str_io_class, "idle") == 0) {
+        return SERVICE_IO_CLASS_IDLE;
+
+    } else if (strcmp(str_io_class, "best-effort") == 0) {
+        return SERVICE_IO_CLASS_BEST_EFFORT;
+
+    } else if (strcmp(str_io_class, "realtime") == 0) {
+        return SERVICE_IO_CLASS_REALTIME;
+
+    } else {
+        return SERVICE_IO_CLASS_NOT_SET;
+    }
+}
+
+/*!
+ * Gets an amount of memory from a string, the number can be followed by one
+ * of the suffixes K, M or G.
+ *
+ * \param str_mem - The amount of memory, for example "512M".
+ *
+ * \return The amount of memory in kilobytes, 0 if it isn't valid.
+ */
+static unsigned long task_parser_get_mem(const char *str_mem)
+{
+    char *end;
+    unsigned long mem = strtoul(str_mem, &end, 10);
+
+    if (end == str_mem) {
+        return 0u;
+    }
+
+    switch (*end) {
+        case 'G':
+        case 'g':
+            mem *= 1024u;
+            /* Fall through. */
+        case 'M':
+        case 'm':
+            mem *= 1024u;
+            /* Fall through. */
+        case 'K':
+        case 'k':
+            end++;
+            break;
+
+        default:
+            /* Bytes, round up to whole kilobytes. */
+            mem = (mem + 1023u) / 1024u;
+            break;
+    }
+
+    if (*end != '\0') {
+        return 0u;
+    }
+    return mem;
+}
+
+/*!
+ * Gets a timeout from a string, the number is in seconds unless it is
+ * followed by the suffix ms. A timeout of 0 disables the timeout.
+ *
+ * \param str_timeout - The timeout, for example "30" or "500ms".
+ *
+ * \return The timeout in milliseconds, \c SERVICE_NOT_SET if it isn't
+ *         valid.
+ */
+static int task_parser_get_timeout(const char *str_timeout)
+{
+    char *end;
+    unsigned long timeout = strtoul(str_timeout, &end, 10);
+
+    if ((end == str_timeout) || (str_timeout[0] == '-')) {
+        return SERVICE_NOT_SET;
+    }
+
+    if (strcmp(end, "ms") != 0) {
+        if ((strcmp(end, "s") != 0) && (*end != '\0')) {
+            return SERVICE_NOT_SET;
+        }
+        timeout *= 1000u;
+    }
+
+    if (timeout > (unsigned long) INT_MAX) {
+        timeout = (unsigned long) INT_MAX;
+    }
+    return (int) timeout;
+}
+
+/*!
+ * Sets the limit of a concurrency group from an argument in the format
+ * "name:limit", for example "disk-heavy:2".
+ *
+ * \param this_ptr - A pointer to the task parser.
+ * \param argument - The argument.
+ */
+static void task_parser_set_group_limit(task_parser_t *this_ptr,
+                                        const char *argument)
+{
+    char *separator = strrchr(argument, ':');
+    char *group;
+    int limit;
+
+    if (separator != NULL) {
+        limit = atoi(separator + 1);
+        group = strndup(argument, separator - argument);
+
+        if ((group != NULL) && (limit > 0)) {
+            task_handler_set_group_limit(this_ptr->handler, group,
+                                         (unsigned int) limit);
+        } else {
+            printf("Invalid group limit %s.\n", argument);
+        }
+        free(group);
+    } else {
+        printf("Missing limit for group %s.\n", argument);
+    }
+}
+
+/*!
+ * Sets a pressure threshold from an argument in the format
+ * "resource:threshold", for example "cpu:40".
+ *
+ * \param this_ptr - A pointer to the task parser.
+ * \param argument - The argument.
+ */
+static void task_parser_set_pressure(task_parser_t *this_ptr,
+                                     const char *argument)
+{
+    char *separator = strrchr(argument, ':');
+    char *resource;
+    double threshold;
+
+    if (separator != NULL) {
+        threshold = atof(separator + 1);
+        resource = strndup(argument, separator - argument);
+
+        if ((resource == NULL) || (threshold <= 0.0) ||
+            (task_handler_set_pressure_threshold(this_ptr->handler, resource,
+                                     threshold) != TASK_HANDLER_SUCCESS)) {
+
+            printf("Invalid pressure threshold %s.\n", argument);
+        }
+        free(resource);
+    } else {
+        printf("Missing threshold for pressure %s.\n", argument);
+    }
+}
+
+/*****************************************************************************/
+/* Functions to scan a directory for configuration files.                    */
+/*****************************************************************************/
+
+/*!
+ * This is a task which scans a directory for configuration files.
+ *
+ * \param arg - A pointer to the arguments that the task needs.
+ */
+static void task_parser_dir_exec(void *arg)
+{
+    task_parser_dir_t *scan_dir = arg;
+    struct dirent *content;
+    char *task;
+    DIR *dir;
+
+    printf("Path: %s\n",scan_dir->path);
+
+    dir = opendir(scan_dir->path);
+    if (dir) {
+        while ((content = readdir(dir)) != NULL) {
+
+            task = task_parser_dir_find_file(scan_dir, content->d_name);
+
+            if (task != NULL) {
+                task_parser_dir_read_file(scan_dir, task);
+            }
+            free(task);
+        }
+        closedir(dir);
+    }
+    task_parser_dir_destroy(scan_dir);
+}
+
+/*!
+ * Creates a simple task which will scan a directory for configuration files.
+ *
+ * \param this_ptr - A pointer to the task parser handle.
+ * \param tasks - The names of the configuration files to look for.
+ * \param path - The directory that should be scanned.
+ *
+ * \return A simple task which will scan a directory.
+ */
+static task_parser_dir_t* task_parser_dir_create(
+                                       task_parser_t *this_ptr,
+                                       queue_t *tasks,
+                                       const char *path)
+{
+    char *task;
+    char *task_dup;
+    task_parser_dir_t *scan_dir;
+    scan_dir = malloc(sizeof(task_parser_dir_t));
+
+    if (scan_dir != NULL) {
+        scan_dir->task.task_parser = this_ptr;
+        scan_dir->path = strdup(path);
+        scan_dir->task.task_exec = task_parser_dir_exec;
+
+        queue_init(&scan_dir->tasks);
+
+        /* Copy the task list just to know the expected name of the
+           configuration files. */
+        queue_first(tasks);
+        while((task = queue_get_current(tasks)) != NULL) {
+            task_dup = strdup(task);
+            queue_push(&scan_dir->tasks, task_dup);
+            queue_next(tasks);
+        }
+    }
+
+    return scan_dir;
+}
+
+/*!
+ * Destroys and deallocates a directory scan task.
+ *
+ * \param config - A pointer to the directory scan task.
+ */
+static void task_parser_dir_destroy(task_parser_dir_t *scan_dir)
+{
+    char* task;
+
+    while((task = queue_pop(&scan_dir->tasks)) != NULL) {
+        printf("Missing task: %s\n",task);
+        free(task);
+    }
+
+    queue_deinit(&scan_dir->tasks);
+
+    free(scan_dir->path);
+    free(scan_dir);
+}
+
+
+static char* task_parser_dir_find_file(task_parser_dir_t *scan_dir,
+                                       char *filename)
+{
+    char *task;
+
+    queue_first(&scan_dir->tasks);
+    while ((task = queue_get_current(&scan_dir->tasks)) != NULL) {
+
+        if (strcmp(task, filename) == 0) {
+            queue_remove_current(&scan_dir->tasks);
+            return task;
+        }
+        queue_next(&scan_dir->tasks);
+    }
+    return NULL;
+}
+
+
+static void task_parser_dir_read_file(task_parser_dir_t *scan_dir,
+                                            char *task)
+{
+    task_parser_file_reader_t *read_file;
+
+    read_file = task_parser_file_create(scan_dir->task.task_parser,
+                                        task_parser_join_path(scan_dir->path,
+                                                              task),
+                                        strdup(task));
+
+    if (read_file != NULL) {
+        queue_push(&read_file->tasks, strdup(task));
+        thread_pool_group_add_task(
+                scan_dir->task.task_parser->thread_pool_group, read_file);
+    }
+}
@@ -0,0 +1,688 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/* Needed for syscall() which is used for the futex calls. */
+#define _GNU_SOURCE
+
+#include "queue.h"
+#include "stats.h"
+#include "thread_pool.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/*! The number of times an idle thread checks for new tasks before it parks
+ *  itself, spinning is only done when there is more than one CPU. */
+#define THREAD_POOL_SPIN_COUNT 4000u
+/*! The maximum number of threads for each CPU when threads are blocked. */
+#define THREAD_POOL_MAX_THREADS_PER_CPU 4
+/*! The time in milliseconds before an extra idle thread exits. */
+#define THREAD_POOL_IDLE_TIMEOUT 2000
+
+void *thread_pool_run_thread(void *arg);
+static void *thread_pool_pop(thread_pool_t *this_ptr,
+                             thread_pool_group_t **group);
+static void thread_pool_exec(thread_pool_group_t *group, void *task);
+static bool thread_pool_spin(thread_pool_t *this_ptr);
+static bool thread_pool_park(thread_pool_worker_t *worker);
+static bool thread_pool_retire(thread_pool_worker_t *worker);
+static void thread_pool_grow(thread_pool_t *this_ptr);
+static thread_pool_worker_t *thread_pool_unpark(thread_pool_t *this_ptr,
+                                                unsigned int tasks_size);
+static void thread_pool_wake(thread_pool_worker_t *worker);
+
+/*!
+ * Creates a thread pool. The threads are created once and are kept until the
+ * thread pool is destroyed, they are shared by all the groups that are
+ * created for the thread pool.
+ *
+ * \param threads - The number of threads that executes tasks, including the
+ *                  thread which waits for a group.
+ *
+ * \return A pointer to the thread pool if it was created, \c NULL otherwise.
+ */
+thread_pool_t *thread_pool_create(unsigned int threads)
+{
+    thread_pool_t *this_ptr = (thread_pool_t*) malloc(sizeof(thread_pool_t));
+    int i;
+    unsigned long locked;
+
+    if (this_ptr != NULL) {
+        if (threads > 0) {
+            this_ptr->thread_size = threads - 1;
+        } else {
+            this_ptr->thread_size = 0;
+        }
+        this_ptr->cpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        if (this_ptr->cpus < 1) {
+            this_ptr->cpus = 1;
+        }
+        this_ptr->thread_max = this_ptr->cpus * THREAD_POOL_MAX_THREADS_PER_CPU;
+        if (this_ptr->thread_max < this_ptr->thread_size) {
+            this_ptr->thread_max = this_ptr->thread_size;
+        }
+
+        this_ptr->workers = (thread_pool_worker_t*) malloc(
+                sizeof(thread_pool_worker_t) * this_ptr->thread_max);
+        this_ptr->mutex = (pthread_mutex_t*) malloc(sizeof(pthread_mutex_t));
+
+        if ((this_ptr->workers != NULL) && (this_ptr->mutex != NULL)) {
+
+            this_ptr->continue_thread_pool = true;
+            this_ptr->parked = NULL;
+            this_ptr->passive_threads = 0;
+            this_ptr->running_threads = 0;
+            this_ptr->blocked_threads = 0;
+            this_ptr->helping_threads = 0;
+            this_ptr->idle_timeout = THREAD_POOL_IDLE_TIMEOUT;
+            this_ptr->tasks = 0;
+            this_ptr->spin_count = 0u;
+
+            if (this_ptr->cpus > 1) {
+                this_ptr->spin_count = THREAD_POOL_SPIN_COUNT;
+            }
+
+            queue_init(&this_ptr->groups);
+            pthread_mutex_init(this_ptr->mutex, NULL);
+
+            for (i = 0; i < this_ptr->thread_max; i++) {
+                this_ptr->workers[i].thread_pool = this_ptr;
+                this_ptr->workers[i].next_parked = NULL;
+                this_ptr->workers[i].state = THREAD_POOL_WORKER_FREE;
+                this_ptr->workers[i].futex = 0;
+                this_ptr->workers[i].on_parked_stack = false;
+                this_ptr->workers[i].woken = false;
+            }
+
+            locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+            for (i = 0; i < this_ptr->thread_size; i++) {
+                thread_pool_grow(this_ptr);
+            }
+            stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+
+        } else {
+            free(this_ptr->workers);
+            free(this_ptr->mutex);
+            free(this_ptr);
+            this_ptr = NULL;
+        }
+    }
+    return this_ptr;
+}
+
+/*!
+ * Stops all the threads in the thread pool. Tasks that haven't been started
+ * are not executed.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ */
+int thread_pool_exit(thread_pool_t *this_ptr)
+{
+    thread_pool_worker_t *worker;
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+    this_ptr->continue_thread_pool = false;
+    worker = thread_pool_unpark(this_ptr,
+                                (unsigned int) this_ptr->thread_max);
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+
+    thread_pool_wake(worker);
+    return 0;
+}
+
+/*!
+ * Registers that the calling thread is going to block, for example while it
+ * waits for a process. If there are tasks waiting and too few runnable
+ * threads then an extra thread is started.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ */
+void thread_pool_block_begin(thread_pool_t *this_ptr)
+{
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+    this_ptr->blocked_threads++;
+    if ((this_ptr->tasks > 0) && (this_ptr->parked == NULL)) {
+        thread_pool_grow(this_ptr);
+    }
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+}
+
+/*!
+ * Registers that the calling thread is no longer blocked.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ */
+void thread_pool_block_end(thread_pool_t *this_ptr)
+{
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+    this_ptr->blocked_threads--;
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+}
+
+/*!
+ * Creates a group of tasks for a thread pool.
+ *
+ * \param thread_pool - A pointer to the thread pool which executes the tasks.
+ * \param task_exec - The callback function which executes a task.
+ *
+ * \return A pointer to the group if it was created, \c NULL otherwise.
+ */
+thread_pool_group_t *thread_pool_group_create(thread_pool_t *thread_pool,
+                                              int (*task_exec)(void *task))
+{
+    thread_pool_group_t *this_ptr = NULL;
+    unsigned long locked;
+
+    if ((thread_pool != NULL) && (task_exec != NULL)) {
+        this_ptr = (thread_pool_group_t*) malloc(sizeof(thread_pool_group_t));
+
+        if (this_ptr != NULL) {
+            this_ptr->thread_pool = thread_pool;
+            this_ptr->task_exec = task_exec;
+            this_ptr->pending = 0;
+            this_ptr->waiters = 0;
+            queue_init(&this_ptr->queue);
+            pthread_cond_init(&this_ptr->condition, NULL);
+
+            locked = stats_lock(STATS_LOCK_THREAD_POOL, thread_pool->mutex);
+            if (queue_push(&thread_pool->groups, this_ptr) != QUEUE_SUCESS) {
+                pthread_cond_destroy(&this_ptr->condition);
+                free(this_ptr);
+                this_ptr = NULL;
+            }
+            stats_unlock(STATS_LOCK_THREAD_POOL, thread_pool->mutex, locked);
+        }
+    }
+    return this_ptr;
+}
+
+int thread_pool_group_add_task(thread_pool_group_t *this_ptr, void *task)
+{
+    return thread_pool_group_add_tasks(this_ptr, &task, 1u);
+}
+
+/*!
+ * Adds several tasks to a group at once. All the tasks are published while
+ * holding the mutex once and one parked thread is woken up for each new task.
+ *
+ * \param this_ptr - A pointer to the group.
+ * \param tasks - An array with the tasks that should be added.
+ * \param tasks_size - The number of tasks in the array.
+ *
+ * \return \c QUEUE_SUCESS if all the tasks were added, otherwise the error
+ *         code from the queue.
+ */
+int thread_pool_group_add_tasks(thread_pool_group_t *this_ptr, void **tasks,
+                                unsigned int tasks_size)
+{
+    thread_pool_t *thread_pool = this_ptr->thread_pool;
+    thread_pool_worker_t *worker;
+    int status = QUEUE_SUCESS;
+    unsigned long locked;
+    unsigned int added = 0u;
+    unsigned int i;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, thread_pool->mutex);
+    for (i = 0u; i < tasks_size; i++) {
+        if (queue_push(&this_ptr->queue, tasks[i]) == QUEUE_SUCESS) {
+            added++;
+        } else {
+            status = QUEUE_ERROR;
+        }
+    }
+    this_ptr->pending += (int) added;
+    __atomic_add_fetch(&thread_pool->tasks, (int) added, __ATOMIC_RELEASE);
+    stats_sample_depth((unsigned long) thread_pool->tasks);
+
+    if ((added > 0u) && (this_ptr->waiters > 0)) {
+        /* Let the threads that wait for the group help out. */
+        pthread_cond_broadcast(&this_ptr->condition);
+    }
+    worker = thread_pool_unpark(thread_pool, added);
+    if ((worker == NULL) && (added > 0u)) {
+        /* All the threads are busy, start an extra thread if some of them
+           are blocked. */
+        thread_pool_grow(thread_pool);
+    }
+    stats_unlock(STATS_LOCK_THREAD_POOL, thread_pool->mutex, locked);
+
+    /* The system calls are done after the mutex has been released so that
+       the woken up threads doesn't have to wait for the mutex. */
+    thread_pool_wake(worker);
+
+    return status;
+}
+
+/*!
+ * Waits until all the tasks in the group have been executed, including tasks
+ * which are added while waiting. The calling thread executes tasks from the
+ * group while it is waiting.
+ *
+ * \param this_ptr - A pointer to the group.
+ */
+int thread_pool_group_wait(thread_pool_group_t *this_ptr)
+{
+    thread_pool_t *thread_pool = this_ptr->thread_pool;
+    void *task;
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, thread_pool->mutex);
+    this_ptr->waiters++;
+
+    while (this_ptr->pending > 0) {
+        task = queue_pop(&this_ptr->queue);
+
+        if (task != NULL) {
+            __atomic_sub_fetch(&thread_pool->tasks, 1, __ATOMIC_RELAXED);
+            thread_pool->helping_threads++;
+            stats_unlock(STATS_LOCK_THREAD_POOL, thread_pool->mutex, locked);
+            thread_pool_exec(this_ptr, task);
+            locked = stats_lock(STATS_LOCK_THREAD_POOL, thread_pool->mutex);
+            thread_pool->helping_threads--;
+        } else {
+            stats_cond_wait(STATS_LOCK_THREAD_POOL, &this_ptr->condition,
+                            thread_pool->mutex, &locked);
+        }
+    }
+
+    this_ptr->waiters--;
+    stats_unlock(STATS_LOCK_THREAD_POOL, thread_pool->mutex, locked);
+    return 0;
+}
+
+/*!
+ * Removes a group from the thread pool and deallocates it. The group must not
+ * have any pending tasks.
+ *
+ * \param this_ptr - A pointer to the group.
+ */
+void thread_pool_group_destroy(thread_pool_group_t *this_ptr)
+{
+    thread_pool_t *thread_pool;
+    unsigned long locked;
+
+    if (this_ptr != NULL) {
+        thread_pool = this_ptr->thread_pool;
+
+        locked = stats_lock(STATS_LOCK_THREAD_POOL, thread_pool->mutex);
+        queue_first(&thread_pool->groups);
+        while (queue_get_current(&thread_pool->groups) != NULL) {
+            if (queue_get_current(&thread_pool->groups) == this_ptr) {
+                queue_remove_current(&thread_pool->groups);
+            }
+            queue_next(&thread_pool->groups);
+        }
+        /* Tasks which never were started are dropped. */
+        while (queue_pop(&this_ptr->queue) != NULL) {
+            __atomic_sub_fetch(&thread_pool->tasks, 1, __ATOMIC_RELAXED);
+        }
+        stats_unlock(STATS_LOCK_THREAD_POOL, thread_pool->mutex, locked);
+
+        pthread_cond_destroy(&this_ptr->condition);
+        free(this_ptr);
+    }
+}
+
+void *thread_pool_run_thread(void *arg)
+{
+    thread_pool_worker_t *worker = (thread_pool_worker_t*) arg;
+    thread_pool_t *this_ptr = worker->thread_pool;
+    thread_pool_group_t *group;
+    void *task;
+    unsigned long locked;
+    unsigned long start;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+
+    while (this_ptr->continue_thread_pool) {
+        task = thread_pool_pop(this_ptr, &group);
+        if ((task != NULL) && worker->woken) {
+            stats_add(STATS_USEFUL_WAKEUPS, 1u);
+        }
+        worker->woken = false;
+
+        if (task != NULL) {
+            stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+            start = stats_now();
+            thread_pool_exec(group, task);
+            stats_add(STATS_BUSY_TIME, stats_now() - start);
+            locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+
+        } else {
+            /* Check for new tasks for a while before parking, a task that
+               arrives soon after is then started without any system call. */
+            stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+            start = stats_now();
+            if (!thread_pool_spin(this_ptr) && !thread_pool_park(worker)) {
+                /* The thread has been idle for too long and isn't needed. */
+                stats_add(STATS_IDLE_TIME, stats_now() - start);
+                return 0;
+            }
+            stats_add(STATS_IDLE_TIME, stats_now() - start);
+            locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+        }
+    }
+
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+    return 0;
+}
+
+/*!
+ * Gets the next task from the groups. The groups are checked in the order
+ * they were created.
+ *
+ * \note The mutex must be locked by the caller.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ * \param group - Set to the group that the task belongs to.
+ *
+ * \return The next task or \c NULL if there are no tasks.
+ */
+static void *thread_pool_pop(thread_pool_t *this_ptr,
+                             thread_pool_group_t **group)
+{
+    void *task = NULL;
+
+    queue_first(&this_ptr->groups);
+    while ((task == NULL) &&
+           ((*group = queue_get_current(&this_ptr->groups)) != NULL)) {
+
+        task = queue_pop(&(*group)->queue);
+        queue_next(&this_ptr->groups);
+    }
+
+    if (task != NULL) {
+        __atomic_sub_fetch(&this_ptr->tasks, 1, __ATOMIC_RELAXED);
+        stats_sample_depth((unsigned long) this_ptr->tasks);
+    }
+    return task;
+}
+
+/*!
+ * Executes a task and signals the threads that wait for the group if it was
+ * the last task in the group.
+ *
+ * \param group - A pointer to the group that the task belongs to.
+ * \param task - A pointer to the task.
+ */
+static void thread_pool_exec(thread_pool_group_t *group, void *task)
+{
+    thread_pool_t *this_ptr = group->thread_pool;
+    unsigned long locked;
+
+    group->task_exec(task);
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+    group->pending--;
+    if ((group->pending == 0) && (group->waiters > 0)) {
+        pthread_cond_broadcast(&group->condition);
+    }
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+}
+
+/*!
+ * Spins for a while and checks if there are any new tasks.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ *
+ * \return \c true if a new task was detected or if the thread pool is
+ *         exiting, \c false otherwise.
+ */
+static bool thread_pool_spin(thread_pool_t *this_ptr)
+{
+    unsigned int i;
+
+    for (i = 0u; i < this_ptr->spin_count; i++) {
+        if ((__atomic_load_n(&this_ptr->tasks, __ATOMIC_ACQUIRE) > 0) ||
+            !__atomic_load_n(&this_ptr->continue_thread_pool,
+                             __ATOMIC_RELAXED)) {
+            return true;
+        }
+#if defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#endif
+    }
+    return false;
+}
+
+/*!
+ * Parks the thread until a new task has been added. The thread is put on the
+ * stack of parked threads and sleeps on its own futex word.
+ *
+ * \param worker - A pointer to the thread that should be parked.
+ *
+ * \return \c true if the thread should continue, \c false if the thread has
+ *         retired and should exit.
+ */
+static bool thread_pool_park(thread_pool_worker_t *worker)
+{
+    thread_pool_t *this_ptr = worker->thread_pool;
+    struct timespec timeout;
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+    if ((this_ptr->tasks > 0) || !this_ptr->continue_thread_pool) {
+        /* Something has changed since the spinning, let the main loop deal
+           with it. */
+        stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+        return true;
+    }
+    worker->futex = 0;
+    worker->next_parked = this_ptr->parked;
+    worker->on_parked_stack = true;
+    this_ptr->parked = worker;
+    this_ptr->passive_threads++;
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+
+    timeout.tv_sec = this_ptr->idle_timeout / 1000;
+    timeout.tv_nsec = (this_ptr->idle_timeout % 1000) * 1000000L;
+
+    while (__atomic_load_n(&worker->futex, __ATOMIC_ACQUIRE) == 0) {
+        if ((syscall(SYS_futex, &worker->futex, FUTEX_WAIT_PRIVATE, 0,
+                     &timeout, NULL, 0) == -1) && (errno == ETIMEDOUT) &&
+            thread_pool_retire(worker)) {
+
+            return false;
+        }
+    }
+    worker->woken = true;
+    stats_add(STATS_WAKEUPS, 1u);
+    return true;
+}
+
+/*!
+ * Lets a parked thread exit if there are more threads than the thread pool
+ * needs to keep.
+ *
+ * \param worker - A pointer to the parked thread.
+ *
+ * \return \c true if the thread has been removed from the thread pool.
+ */
+static bool thread_pool_retire(thread_pool_worker_t *worker)
+{
+    thread_pool_t *this_ptr = worker->thread_pool;
+    thread_pool_worker_t **parked;
+    bool retired = false;
+    unsigned long locked;
+
+    locked = stats_lock(STATS_LOCK_THREAD_POOL, this_ptr->mutex);
+    if (worker->on_parked_stack &&
+        (this_ptr->running_threads > this_ptr->thread_size)) {
+
+        /* A thread which has been taken off the stack has been handed a
+           task and is about to be woken up, it must not retire. */
+        parked = &this_ptr->parked;
+        while (*parked != worker) {
+            parked = &(*parked)->next_parked;
+        }
+        *parked = worker->next_parked;
+        worker->on_parked_stack = false;
+
+        this_ptr->passive_threads--;
+        this_ptr->running_threads--;
+        worker->state = THREAD_POOL_WORKER_RETIRED;
+        retired = true;
+    }
+    stats_unlock(STATS_LOCK_THREAD_POOL, this_ptr->mutex, locked);
+
+    return retired;
+}
+
+/*!
+ * Starts a new thread if the thread pool is below its base size, or if too
+ * few threads are runnable because of blocked threads and the maximum number
+ * of threads hasn't been reached.
+ *
+ * \note The mutex must be locked by the caller.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ */
+static void thread_pool_grow(thread_pool_t *this_ptr)
+{
+    thread_pool_worker_t *worker;
+    int i;
+
+    if (!this_ptr->continue_thread_pool) {
+        return;
+    }
+
+    if ((this_ptr->running_threads >= this_ptr->thread_size) &&
+        ((this_ptr->running_threads + this_ptr->helping_threads -
+          this_ptr->blocked_threads >= this_ptr->cpus) ||
+         (this_ptr->running_threads >= this_ptr->thread_max))) {
+
+        return;
+    }
+
+    for (i = 0; i < this_ptr->thread_max; i++) {
+        worker = &this_ptr->workers[i];
+
+        if (worker->state == THREAD_POOL_WORKER_RETIRED) {
+            /* The thread has already released the mutex and is exiting. */
+            pthread_join(worker->thread, NULL);
+            worker->state = THREAD_POOL_WORKER_FREE;
+        }
+
+        if (worker->state == THREAD_POOL_WORKER_FREE) {
+            worker->next_parked = NULL;
+            worker->futex = 0;
+            worker->on_parked_stack = false;
+            if (pthread_create(&worker->thread, NULL, thread_pool_run_thread,
+                               worker) == 0) {
+
+                worker->state = THREAD_POOL_WORKER_RUNNING;
+                this_ptr->running_threads++;
+            }
+            return;
+        }
+    }
+}
+
+/*!
+ * Removes parked threads from the stack of parked threads.
+ *
+ * \note The mutex must be locked by the caller.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ * \param tasks_size - The maximum number of threads to remove.
+ *
+ * \return A list of the removed threads which should be passed to
+ *         \c thread_pool_wake after the mutex has been released.
+ */
+static thread_pool_worker_t *thread_pool_unpark(thread_pool_t *this_ptr,
+                                                unsigned int tasks_size)
+{
+    thread_pool_worker_t *first = this_ptr->parked;
+    thread_pool_worker_t *last = NULL;
+    unsigned int i;
+
+    for (i = 0u; (i < tasks_size) && (this_ptr->parked != NULL); i++) {
+        last = this_ptr->parked;
+        last->on_parked_stack = false;
+        this_ptr->parked = last->next_parked;
+        this_ptr->passive_threads--;
+    }
+
+    if (last == NULL) {
+        return NULL;
+    }
+    last->next_parked = NULL;
+    return first;
+}
+
+/*!
+ * Wakes up a list of threads that have been removed from the stack of parked
+ * threads.
+ *
+ * \param worker - The first thread in the list.
+ */
+static void thread_pool_wake(thread_pool_worker_t *worker)
+{
+    thread_pool_worker_t *next;
+
+    while (worker != NULL) {
+        /* The thread can continue as soon as the futex word has been set so
+           the next pointer needs to be fetched before. */
+        next = worker->next_parked;
+        __atomic_store_n(&worker->futex, 1, __ATOMIC_RELEASE);
+        syscall(SYS_futex, &worker->futex, FUTEX_WAKE_PRIVATE, 1,
+                NULL, NULL, 0);
+        worker = next;
+    }
+}
+
+int thread_pool_task_size(thread_pool_t *this_ptr)
+{
+    return __atomic_load_n(&this_ptr->tasks, __ATOMIC_RELAXED);
+}
+
+/*!
+ * Stops all the threads and deallocates the thread pool. All the groups must
+ * have been destroyed before.
+ *
+ * \param this_ptr - A pointer to the thread pool.
+ */
+void thread_pool_destroy(thread_pool_t *this_ptr)
+{
+    int i;
+
+    if (this_ptr != NULL) {
+        thread_pool_exit(this_ptr);
+
+        for(i = 0; i < this_ptr->thread_max; i++) {
+            if (this_ptr->workers[i].state != THREAD_POOL_WORKER_FREE) {
+                pthread_join(this_ptr->workers[i].thread, NULL);
+            }
+        }
+
+        pthread_mutex_destroy(this_ptr->mutex);
+
+        free(this_ptr->mutex);
+        queue_deinit(&this_ptr->groups);
+        free(this_ptr->workers);
+        free(this_ptr);
+    }
+}
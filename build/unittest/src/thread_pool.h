@@ -0,0 +1,131 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef _SPEEDY_THREAD_POOL_H_
+#define _SPEEDY_THREAD_POOL_H_
+
+#include "queue.h"
+
+#include <stdbool.h>
+#include <pthread.h>
+
+struct thread_pool_t;
+
+/*! The thread slot is not used. */
+#define THREAD_POOL_WORKER_FREE 0
+/*! The thread is running. */
+#define THREAD_POOL_WORKER_RUNNING 1
+/*! The thread has exited since it was idle, it needs to be joined before the
+ *  slot can be used again. */
+#define THREAD_POOL_WORKER_RETIRED 2
+
+/*!
+ * Keeps track of a single thread in the thread pool. An idle thread parks
+ * itself on its own futex word so that a new task can wake up exactly one
+ * thread instead of all the threads that are waiting on a shared condition.
+ */
+typedef struct thread_pool_worker_t {
+    /*! The thread pool that the thread belongs to. */
+    struct thread_pool_t *thread_pool;
+    /*! The next parked thread, used for the stack of parked threads. */
+    struct thread_pool_worker_t *next_parked;
+    pthread_t thread;
+    /*! The state of the thread slot, \c THREAD_POOL_WORKER_FREE,
+     *  \c THREAD_POOL_WORKER_RUNNING or \c THREAD_POOL_WORKER_RETIRED. */
+    int state;
+    /*! The futex word which the thread sleeps on, 0 while the thread is
+     *  parked and 1 when it has been woken up. */
+    int futex;
+    /*! \c true while the thread is on the stack of parked threads, it is
+     *  only changed with the mutex locked. A thread that has been taken off
+     *  the stack may still see 0 in its futex word until it is woken up. */
+    bool on_parked_stack;
+    /*! Set when the thread has been woken up from the futex, used to count
+     *  the wake-ups that found a task. */
+    bool woken;
+} thread_pool_worker_t;
+
+/*!
+ * A group of tasks which are executed by the threads in a thread pool. Each
+ * group has its own callback function and can be waited on individually, this
+ * makes it possible for several users to share the same threads.
+ */
+typedef struct thread_pool_group_t {
+    /*! The thread pool that executes the tasks in the group. */
+    struct thread_pool_t *thread_pool;
+    /*! The tasks in the group that haven't been started yet. */
+    queue_t queue;
+    /*! The number of tasks that have been added but haven't finished. */
+    int pending;
+    /*! The number of threads that are waiting for the group. */
+    int waiters;
+    /*! Signaled when the group is finished or when a new task has been added
+     *  while there are threads waiting for the group. */
+    pthread_cond_t condition;
+    int (*task_exec)(void *task);
+} thread_pool_group_t;
+
+typedef struct thread_pool_t {
+    /*! All the groups which are using the thread pool. */
+    queue_t groups;
+    thread_pool_worker_t *workers;
+    /*! A stack of the threads that are currently parked. */
+    thread_pool_worker_t *parked;
+    pthread_mutex_t *mutex;
+    /*! The number of threads that are always kept. */
+    int thread_size;
+    /*! The maximum number of threads, the pool grows up to this limit when
+     *  threads are blocked. */
+    int thread_max;
+    /*! The number of threads that are currently running. */
+    int running_threads;
+    /*! The number of threads that have registered that they are blocked. */
+    int blocked_threads;
+    /*! The number of threads that execute tasks while they wait for a
+     *  group. */
+    int helping_threads;
+    /*! The number of online CPUs, the pool tries to keep this many threads
+     *  runnable. */
+    int cpus;
+    /*! Time in milliseconds before an idle thread above \c thread_size
+     *  exits. */
+    int idle_timeout;
+    bool continue_thread_pool;
+    int passive_threads;
+    int tasks;
+    /*! The number of times an idle thread checks for new tasks before it
+     *  parks itself. */
+    unsigned int spin_count;
+} thread_pool_t;
+
+thread_pool_t *thread_pool_create(unsigned int threads);
+int thread_pool_exit(thread_pool_t *this_ptr);
+int thread_pool_task_size(thread_pool_t *this_ptr);
+void thread_pool_block_begin(thread_pool_t *this_ptr);
+void thread_pool_block_end(thread_pool_t *this_ptr);
+void thread_pool_destroy(thread_pool_t *this_ptr);
+
+thread_pool_group_t *thread_pool_group_create(thread_pool_t *thread_pool,
+                                              int (*task_exec)(void *task));
+
+int thread_pool_group_add_task(thread_pool_group_t *this_ptr, void *task);
+int thread_pool_group_add_tasks(thread_pool_group_t *this_ptr, void **tasks,
+                                unsigned int tasks_size);
+int thread_pool_group_wait(thread_pool_group_t *this_ptr);
+
+void thread_pool_group_destroy(thread_pool_group_t *this_ptr);
+
+#endif /* _SPEEDY_THREAD_POOL_H_ */
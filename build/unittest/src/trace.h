@@ -0,0 +1,116 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#ifndef _SPEEDY_TRACE_H_
+#define _SPEEDY_TRACE_H_
+
+#include "queue.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+/*! The operation was successfully executed. */
+#define TRACE_SUCCESS 0
+/*! The trace couldn't be written or the memory couldn't be allocated. */
+#define TRACE_FAIL -1
+/*! The number of events that each thread keeps, the oldest events are
+ *  overwritten when a thread records more. */
+#define TRACE_BUFFER_SIZE 16384u
+
+struct task_graph_t;
+struct task_t;
+
+/*!
+ * The state transitions of a task in the order that they normally happen.
+ */
+typedef enum trace_event_type_t {
+    TRACE_PARSED, /*!< The task has been read from the configuration. */
+    TRACE_WIRED, /*!< The dependencies of the task have been connected. */
+    TRACE_READY, /*!< All the dependencies of the task are done. */
+    TRACE_DISPATCHED, /*!< A worker thread has picked up the task. */
+    TRACE_SPAWNED, /*!< The process or the action has been started. */
+    TRACE_READINESS, /*!< The service has reported that it is ready. */
+    TRACE_EXITED, /*!< The process or the action has finished. */
+    TRACE_NOTIFIED, /*!< The dependents of the task have been notified. */
+    TRACE_EVENT_TYPES /*!< The number of event types. */
+} trace_event_type_t;
+
+/*!
+ * A recorded state transition.
+ */
+typedef struct trace_event_t {
+    uint64_t time; /*!< Nanoseconds since the trace was created. */
+    unsigned int task; /*!< The hashed name of the task. */
+    trace_event_type_t type; /*!< The transition. */
+} trace_event_t;
+
+/*!
+ * A change of the number of tasks that may run at the same time because of
+ * the system pressure.
+ */
+typedef struct trace_limit_t {
+    uint64_t time; /*!< Nanoseconds since the trace was created. */
+    /*! The number of tasks that may run, 0 if there isn't any limit. */
+    unsigned int limit;
+    /*! The resource whose pressure was above its threshold, \c NULL if all
+     *  of them were below. */
+    const char *resource;
+    double pressure; /*!< The sampled pressure of the resource in percent. */
+    double threshold; /*!< The threshold of the resource in percent. */
+} trace_limit_t;
+
+/*!
+ * The events of one thread in a ring, only the thread itself writes to it.
+ */
+typedef struct trace_buffer_t {
+    unsigned int track; /*!< The number of the thread in the trace. */
+    /*! The number of events that have been recorded, the last
+     *  \c TRACE_BUFFER_SIZE of them are kept. */
+    unsigned long head;
+    trace_event_t *events; /*!< The ring of events. */
+} trace_buffer_t;
+
+/*!
+ * Records the state transitions of the tasks without any locking on the hot
+ * path. Each thread gets its own buffer the first time it records an event,
+ * and the buffers are dumped as a Chrome trace when the boot is done.
+ */
+typedef struct trace_t {
+    /*! The buffer of the calling thread. */
+    pthread_key_t key;
+    pthread_mutex_t mutex; /*!< Protects the list of buffers. */
+    queue_t buffers; /*!< The buffers of all the threads. */
+    unsigned int tracks; /*!< The number of buffers. */
+    unsigned int capacity; /*!< The number of events in each buffer. */
+    /*! The changes of the pressure limit, they are rare so they are kept in
+     *  one list that is protected by the mutex. */
+    queue_t limits;
+    struct timespec start; /*!< The time when the trace was created. */
+} trace_t;
+
+trace_t *trace_create(unsigned int capacity);
+
+void trace_record(trace_t *this_ptr, trace_event_type_t type,
+                  unsigned int task);
+void trace_record_limit(trace_t *this_ptr, unsigned int limit,
+                        const char *resource, double pressure,
+                        double threshold);
+int trace_write(trace_t *this_ptr, const char *path,
+                struct task_graph_t *graph, struct task_t **nodes);
+
+void trace_destroy(trace_t *this_ptr);
+
+#endif /* _SPEEDY_TRACE_H_ */
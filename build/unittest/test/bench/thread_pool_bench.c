@@ -0,0 +1,165 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+ * Measures the dispatch latency of the thread pool, the time from when a
+ * task is added until a pool thread starts to execute it. The tasks are
+ * added in bursts with a pause in between, long enough for the threads to
+ * stop spinning and park, so every burst measures the wake-up path.
+ *
+ * Usage: thread_pool_bench [ROUNDS]
+ *
+ * Build it with "make bench", the program is build/bench/thread_pool_bench.
+ * The bursts are waited for by polling instead of waiting for the group,
+ * since the waiting thread would otherwise help out and hide the wake-ups.
+ * This also keeps the program to the few calls that every version of the
+ * thread pool has, so the same bursts can be run against older versions.
+ */
+
+#include "../../src/thread_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*! The number of tasks that are added at once. */
+#define BENCH_BURST_SIZE 8u
+/*! The number of bursts if none is given. */
+#define BENCH_ROUNDS 500u
+/*! The pause between two bursts in microseconds. */
+#define BENCH_PAUSE 2000L
+/*! The time between two checks if a burst is done in microseconds. */
+#define BENCH_POLL 20L
+
+/*! A task which remembers when it was added and when it started. */
+typedef struct bench_task_t {
+    struct timespec added;
+    unsigned long latency;
+} bench_task_t;
+
+/*! The number of tasks that have been executed. */
+static unsigned int priv_bench_done;
+
+static unsigned long bench_elapsed(const struct timespec *from,
+                                   const struct timespec *to)
+{
+    long elapsed = (long) (to->tv_sec - from->tv_sec) * 1000000000L +
+                   (to->tv_nsec - from->tv_nsec);
+
+    return (elapsed > 0) ? (unsigned long) elapsed : 0u;
+}
+
+static int bench_exec(void *arg)
+{
+    bench_task_t *task = (bench_task_t*) arg;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    task->latency = bench_elapsed(&task->added, &now);
+    __atomic_add_fetch(&priv_bench_done, 1u, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int bench_compare(const void *first, const void *second)
+{
+    unsigned long a = *((const unsigned long*) first);
+    unsigned long b = *((const unsigned long*) second);
+
+    return (a > b) - (a < b);
+}
+
+/*!
+ * Runs the bursts on a pool with a number of threads and prints the median
+ * and the 99th percentile of the dispatch latency.
+ */
+static int bench_run(unsigned int threads, unsigned int rounds)
+{
+    struct timespec pause = {0, BENCH_PAUSE * 1000L};
+    struct timespec poll = {0, BENCH_POLL * 1000L};
+    bench_task_t tasks[BENCH_BURST_SIZE];
+    void *burst[BENCH_BURST_SIZE];
+    thread_pool_group_t *group;
+    thread_pool_t *pool;
+    unsigned long *latencies;
+    unsigned int size = 0u;
+    unsigned int round;
+    unsigned int i;
+
+    latencies = malloc(sizeof(unsigned long) * rounds * BENCH_BURST_SIZE);
+    pool = thread_pool_create(threads);
+    group = (pool != NULL) ? thread_pool_group_create(pool, bench_exec) :
+                             NULL;
+    if ((latencies == NULL) || (group == NULL)) {
+        if (pool != NULL) {
+            thread_pool_destroy(pool);
+        }
+        free(latencies);
+        return EXIT_FAILURE;
+    }
+
+    priv_bench_done = 0u;
+    for (round = 0u; round < rounds; round++) {
+        nanosleep(&pause, NULL);
+        for (i = 0u; i < BENCH_BURST_SIZE; i++) {
+            memset(&tasks[i], 0, sizeof(bench_task_t));
+            burst[i] = &tasks[i];
+        }
+        for (i = 0u; i < BENCH_BURST_SIZE; i++) {
+            clock_gettime(CLOCK_MONOTONIC, &tasks[i].added);
+        }
+        thread_pool_group_add_tasks(group, burst, BENCH_BURST_SIZE);
+        while (__atomic_load_n(&priv_bench_done, __ATOMIC_ACQUIRE) <
+               (round + 1u) * BENCH_BURST_SIZE) {
+            nanosleep(&poll, NULL);
+        }
+
+        for (i = 0u; i < BENCH_BURST_SIZE; i++) {
+            latencies[size++] = tasks[i].latency;
+        }
+    }
+
+    thread_pool_group_destroy(group);
+    thread_pool_destroy(pool);
+
+    qsort(latencies, size, sizeof(unsigned long), bench_compare);
+    printf("threads %2u: median %7.1f us  p99 %8.1f us  (%u samples)\n",
+           threads, (double) latencies[size / 2u] / 1000.0,
+           (double) latencies[(size * 99u) / 100u] / 1000.0, size);
+    free(latencies);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned int threads[] = {2u, 3u, 5u, 9u};
+    unsigned int rounds = BENCH_ROUNDS;
+    unsigned int i;
+
+    if (argc > 1) {
+        rounds = (unsigned int) strtoul(argv[1], NULL, 10);
+    }
+    if (rounds == 0u) {
+        rounds = BENCH_ROUNDS;
+    }
+
+    for (i = 0u; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        if (bench_run(threads[i], rounds) != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "unity/unity.h"
+#include <string.h>
+
+#define TEST_CASE_PATH "./test/test-case/"
+
+typedef struct test_case_t {
+    const char* name;
+    unsigned int line;
+    void (*init)(void);
+    void (*clean)(void);
+    void (*test)(void);
+} test_case_t;
+
+void test_handler_init(int argc, char *argv[]);
+void test_handler_deinit(void);
+
+void test_handler_run_test(test_case_t *test_case);
+
+const char* test_handler_get_current_path(void);
+
+unsigned int test_handler_count_processes(const char *argument,
+                                          unsigned int wait);
+
+#define TEST_CASE_RUN(init_exec, clean_exec, test_exec) \
+            do { \
+                test_case_t test_case; \
+                test_case.name = #test_exec; \
+                test_case.line = __LINE__; \
+                test_case.init = (init_exec); \
+                test_case.clean = (clean_exec); \
+                test_case.test = (test_exec); \
+                test_handler_run_test(&test_case); \
+            } while(0)
+
+#define TEST_CASE_START() \
+            do { \
+                UnityPrint(__FILE__); \
+                UNITY_OUTPUT_CHAR('\n'); \
+            } while(0)
+
+#define TEST_CASE_END() UNITY_OUTPUT_CHAR('\n')
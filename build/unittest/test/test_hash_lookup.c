@@ -0,0 +1,54 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+#include "../src/hash_lookup.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+static hash_lookup_t *priv_test_hash_lookup;
+
+static void test_hash_lookup_null_init(void)
+{
+    priv_test_hash_lookup = NULL;
+}
+
+static void test_hash_lookup_null_cleanup(void)
+{
+    hash_lookup_destroy(priv_test_hash_lookup);
+}
+
+static void test_hash_lookup_null(void)
+{
+    TEST_ASSERT_EQUAL(NULL, hash_lookup_find(priv_test_hash_lookup, 0));
+    TEST_ASSERT_EQUAL(NULL, hash_lookup_remove(priv_test_hash_lookup, 0));
+    TEST_ASSERT_EQUAL(HASH_LOOKUP_EMPTY, hash_lookup_insert(
+                      priv_test_hash_lookup, 0, 0));
+}
+
+void test_hash_lookup(void)
+{
+    TEST_CASE_START();
+
+    /* Test when the hash lookup is null. */
+    TEST_CASE_RUN(test_hash_lookup_null_init,
+                  test_hash_lookup_null_cleanup,
+                  test_hash_lookup_null);
+
+
+    TEST_CASE_END();
+}
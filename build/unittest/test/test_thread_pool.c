@@ -0,0 +1,253 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+#include "../src/thread_pool.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define TEST_THREAD_POOL_TASKS 100
+
+static thread_pool_t *priv_test_thread_pool;
+static thread_pool_group_t *priv_test_group;
+static thread_pool_group_t *priv_test_other_group;
+static pthread_mutex_t priv_test_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int priv_test_executed;
+static int priv_test_tasks[TEST_THREAD_POOL_TASKS];
+
+static int test_thread_pool_exec(void *task)
+{
+    (void) task;
+
+    pthread_mutex_lock(&priv_test_mutex);
+    priv_test_executed++;
+    pthread_mutex_unlock(&priv_test_mutex);
+    return 0;
+}
+
+/* Every task adds two new tasks until there are no more tasks left, this
+ * behaves like a task which releases several dependent tasks at once. */
+static int test_thread_pool_fan_out_exec(void *task)
+{
+    int index = *((int*) task);
+    void *tasks[2];
+    unsigned int tasks_size = 0u;
+
+    test_thread_pool_exec(task);
+
+    if ((index * 2 + 1) < TEST_THREAD_POOL_TASKS) {
+        tasks[tasks_size++] = &priv_test_tasks[index * 2 + 1];
+    }
+    if ((index * 2 + 2) < TEST_THREAD_POOL_TASKS) {
+        tasks[tasks_size++] = &priv_test_tasks[index * 2 + 2];
+    }
+    thread_pool_group_add_tasks(priv_test_other_group, tasks, tasks_size);
+    return 0;
+}
+
+/* A task which blocks for a while and registers it to the thread pool. */
+static int test_thread_pool_blocking_exec(void *task)
+{
+    struct timespec delay = {0, 100000000L};
+
+    thread_pool_block_begin(priv_test_thread_pool);
+    nanosleep(&delay, NULL);
+    thread_pool_block_end(priv_test_thread_pool);
+
+    return test_thread_pool_exec(task);
+}
+
+/* A task which blocks shortly, the extra threads that it causes retire
+ * soon after since the idle timeout is short. */
+static int test_thread_pool_short_blocking_exec(void *task)
+{
+    struct timespec delay = {0, 2000000L};
+
+    thread_pool_block_begin(priv_test_thread_pool);
+    nanosleep(&delay, NULL);
+    thread_pool_block_end(priv_test_thread_pool);
+
+    return test_thread_pool_exec(task);
+}
+
+static void test_thread_pool_init(void)
+{
+    int i;
+
+    priv_test_executed = 0;
+    for (i = 0; i < TEST_THREAD_POOL_TASKS; i++) {
+        priv_test_tasks[i] = i;
+    }
+    priv_test_thread_pool = thread_pool_create(4);
+    priv_test_group = thread_pool_group_create(priv_test_thread_pool,
+                                               test_thread_pool_exec);
+    priv_test_other_group = thread_pool_group_create(priv_test_thread_pool,
+                                             test_thread_pool_fan_out_exec);
+}
+
+static void test_thread_pool_blocking_init(void)
+{
+    priv_test_executed = 0;
+    priv_test_thread_pool = thread_pool_create(1);
+    priv_test_thread_pool->idle_timeout = 50;
+    priv_test_group = thread_pool_group_create(priv_test_thread_pool,
+                                         test_thread_pool_blocking_exec);
+    priv_test_other_group = NULL;
+}
+
+static void test_thread_pool_retire_init(void)
+{
+    priv_test_executed = 0;
+    priv_test_thread_pool = thread_pool_create(1);
+    priv_test_thread_pool->idle_timeout = 1;
+    priv_test_group = thread_pool_group_create(priv_test_thread_pool,
+                                     test_thread_pool_short_blocking_exec);
+    priv_test_other_group = NULL;
+}
+
+static void test_thread_pool_cleanup(void)
+{
+    thread_pool_group_destroy(priv_test_group);
+    thread_pool_group_destroy(priv_test_other_group);
+    thread_pool_destroy(priv_test_thread_pool);
+}
+
+static void test_thread_pool_no_tasks(void)
+{
+    TEST_ASSERT_EQUAL(0, thread_pool_group_wait(priv_test_group));
+    TEST_ASSERT_EQUAL(0, priv_test_executed);
+}
+
+static void test_thread_pool_add_tasks(void)
+{
+    void *tasks[TEST_THREAD_POOL_TASKS];
+    int i;
+
+    for (i = 0; i < TEST_THREAD_POOL_TASKS; i++) {
+        tasks[i] = &priv_test_tasks[i];
+    }
+    thread_pool_group_add_task(priv_test_group, tasks[0]);
+    thread_pool_group_add_tasks(priv_test_group, &tasks[1],
+                                TEST_THREAD_POOL_TASKS - 1);
+    thread_pool_group_wait(priv_test_group);
+
+    TEST_ASSERT_EQUAL(TEST_THREAD_POOL_TASKS, priv_test_executed);
+}
+
+static void test_thread_pool_fan_out(void)
+{
+    thread_pool_group_add_task(priv_test_other_group, &priv_test_tasks[0]);
+    thread_pool_group_wait(priv_test_other_group);
+
+    TEST_ASSERT_EQUAL(TEST_THREAD_POOL_TASKS, priv_test_executed);
+}
+
+static void test_thread_pool_reuse(void)
+{
+    /* The same threads should be able to execute the tasks in several
+     * rounds. */
+    test_thread_pool_add_tasks();
+    priv_test_executed = 0;
+    test_thread_pool_add_tasks();
+}
+
+static void test_thread_pool_blocking(void)
+{
+    struct timespec start;
+    struct timespec end;
+    struct timespec delay = {0, 300000000L};
+    long elapsed;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < 4; i++) {
+        thread_pool_group_add_task(priv_test_group, &priv_test_tasks[i]);
+    }
+    thread_pool_group_wait(priv_test_group);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = (end.tv_sec - start.tv_sec) * 1000L +
+              (end.tv_nsec - start.tv_nsec) / 1000000L;
+
+    /* The blocked tasks should have been executed by extra threads at the
+     * same time instead of one after the other. */
+    TEST_ASSERT_EQUAL(4, priv_test_executed);
+    TEST_ASSERT_TRUE(elapsed < 300);
+
+    /* The extra threads should exit when they have been idle. */
+    nanosleep(&delay, NULL);
+    TEST_ASSERT_EQUAL(0, priv_test_thread_pool->running_threads);
+}
+
+static void test_thread_pool_retire(void)
+{
+    struct timespec delay = {0, 1000000L};
+    int round;
+    int i;
+
+    /* The tasks are added about when the idle threads time out, a thread
+     * that has been handed a task must not retire before it wakes up. */
+    for (round = 0; round < 100; round++) {
+        for (i = 0; i < 4; i++) {
+            thread_pool_group_add_task(priv_test_group, &priv_test_tasks[i]);
+        }
+        thread_pool_group_wait(priv_test_group);
+        nanosleep(&delay, NULL);
+    }
+    TEST_ASSERT_EQUAL(400, priv_test_executed);
+    TEST_ASSERT_EQUAL(0, thread_pool_task_size(priv_test_thread_pool));
+}
+
+void test_thread_pool(void)
+{
+    TEST_CASE_START();
+
+    /* Test that waiting on a thread pool without any tasks returns. */
+    TEST_CASE_RUN(test_thread_pool_init,
+                  test_thread_pool_cleanup,
+                  test_thread_pool_no_tasks);
+
+    /* Test that all tasks are executed when they are added at once. */
+    TEST_CASE_RUN(test_thread_pool_init,
+                  test_thread_pool_cleanup,
+                  test_thread_pool_add_tasks);
+
+    /* Test that tasks which add new tasks are executed. */
+    TEST_CASE_RUN(test_thread_pool_init,
+                  test_thread_pool_cleanup,
+                  test_thread_pool_fan_out);
+
+    /* Test that a group can be waited on several times. */
+    TEST_CASE_RUN(test_thread_pool_init,
+                  test_thread_pool_cleanup,
+                  test_thread_pool_reuse);
+
+    /* Test that the thread pool grows when threads are blocked and shrinks
+     * when the threads are idle. */
+    TEST_CASE_RUN(test_thread_pool_blocking_init,
+                  test_thread_pool_cleanup,
+                  test_thread_pool_blocking);
+
+    /* Test that threads which time out while they are woken up don't
+     * lose their tasks. */
+    TEST_CASE_RUN(test_thread_pool_retire_init,
+                  test_thread_pool_cleanup,
+                  test_thread_pool_retire);
+
+    TEST_CASE_END();
+}
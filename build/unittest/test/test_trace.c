@@ -0,0 +1,193 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "test_handler.h"
+#include "../src/pressure.h"
+#include "../src/trace.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_TRACE_PATH "/tmp/speedy_test_trace.json"
+#define TEST_TRACE_CAPACITY 4u
+
+static trace_t *priv_test_trace;
+
+/* Reads the written trace, the caller frees it. */
+static char *test_trace_read(void)
+{
+    FILE *file = fopen(TEST_TRACE_PATH, "r");
+    char *content = calloc(4096, 1);
+
+    if ((file != NULL) && (content != NULL)) {
+        TEST_ASSERT_TRUE(fread(content, 1, 4095, file) > 0u);
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    return content;
+}
+
+/* Counts how many times a string occurs in another string. */
+static unsigned int test_trace_count(const char *content, const char *str)
+{
+    unsigned int count = 0u;
+
+    while ((content = strstr(content, str)) != NULL) {
+        count++;
+        content += strlen(str);
+    }
+    return count;
+}
+
+/* A synthetic pressure source where only the CPU is under pressure. */
+static int test_trace_pressure_read(pressure_t *this_ptr,
+                                    pressure_sample_t *sample)
+{
+    (void) this_ptr;
+
+    sample->pressure[PRESSURE_CPU] = 80.0;
+    sample->pressure[PRESSURE_IO] = 0.0;
+    sample->pressure[PRESSURE_MEMORY] = 0.0;
+    return PRESSURE_SUCCESS;
+}
+
+static void *test_trace_thread(void *arg)
+{
+    trace_record(priv_test_trace, TRACE_DISPATCHED, 0x1234u);
+    trace_record(priv_test_trace, TRACE_NOTIFIED, 0x1234u);
+    return arg;
+}
+
+static void test_trace_init(void)
+{
+    unlink(TEST_TRACE_PATH);
+    priv_test_trace = trace_create(TEST_TRACE_CAPACITY);
+}
+
+static void test_trace_cleanup(void)
+{
+    trace_destroy(priv_test_trace);
+    unlink(TEST_TRACE_PATH);
+}
+
+static void test_trace_threads(void)
+{
+    pthread_t thread;
+    char *content;
+
+    TEST_ASSERT_NOT_NULL(priv_test_trace);
+    trace_record(NULL, TRACE_PARSED, 1u);
+    trace_record(priv_test_trace, TRACE_PARSED, 0x1234u);
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, test_trace_thread,
+                                        NULL));
+    pthread_join(thread, NULL);
+    TEST_ASSERT_EQUAL(2u, priv_test_trace->tracks);
+
+    /* Each thread is a track, and the run on the second thread is a slice
+       named by the hashed name since there aren't any tasks. */
+    TEST_ASSERT_EQUAL(TRACE_SUCCESS,
+                      trace_write(priv_test_trace, TEST_TRACE_PATH, NULL,
+                                  NULL));
+    content = test_trace_read();
+    TEST_ASSERT_NOT_NULL(content);
+    TEST_ASSERT_EQUAL(2u, test_trace_count(content, "\"thread_name\""));
+    TEST_ASSERT_EQUAL(3u, test_trace_count(content, "\"ph\":\"i\""));
+    TEST_ASSERT_NOT_NULL(strstr(content, "{\"name\":\"00001234\","
+                                         "\"cat\":\"run\",\"ph\":\"X\","
+                                         "\"pid\":1,\"tid\":1,"));
+    TEST_ASSERT_NOT_NULL(strstr(content, "\"parsed\""));
+    free(content);
+}
+
+static void test_trace_ring(void)
+{
+    char *content;
+    unsigned int i;
+
+    /* Only the newest events are kept, the oldest one in a full ring is
+       left out since it may be overwritten while it is written. */
+    TEST_ASSERT_NOT_NULL(priv_test_trace);
+    for (i = 0u; i < 10u; i++) {
+        trace_record(priv_test_trace, TRACE_READY, i);
+    }
+    TEST_ASSERT_EQUAL(TRACE_SUCCESS,
+                      trace_write(priv_test_trace, TEST_TRACE_PATH, NULL,
+                                  NULL));
+    content = test_trace_read();
+    TEST_ASSERT_NOT_NULL(content);
+    TEST_ASSERT_EQUAL(TEST_TRACE_CAPACITY - 1u,
+                      test_trace_count(content, "\"ready\""));
+    TEST_ASSERT_NULL(strstr(content, "\"00000006\""));
+    TEST_ASSERT_NOT_NULL(strstr(content, "\"00000009\""));
+    free(content);
+}
+
+static void test_trace_pressure(void)
+{
+    pressure_t *pressure = pressure_create();
+    char *content;
+
+    /* Each change of the limit is a counter and an instant event with the
+       resource and the sample that caused it, an unchanged limit isn't
+       recorded. */
+    TEST_ASSERT_NOT_NULL(pressure);
+    pressure->read = test_trace_pressure_read;
+    pressure->interval = 0;
+    pressure->trace = priv_test_trace;
+    pressure_set_threshold(pressure, "cpu", 50.0);
+    TEST_ASSERT_EQUAL(4u, pressure_get_limit(pressure, 8u));
+    TEST_ASSERT_EQUAL(1u, pressure_get_limit(pressure, 2u));
+    TEST_ASSERT_EQUAL(1u, pressure_get_limit(pressure, 1u));
+    pressure_destroy(pressure);
+
+    TEST_ASSERT_EQUAL(TRACE_SUCCESS,
+                      trace_write(priv_test_trace, TEST_TRACE_PATH, NULL,
+                                  NULL));
+    content = test_trace_read();
+    TEST_ASSERT_NOT_NULL(content);
+    TEST_ASSERT_EQUAL(2u, test_trace_count(content, "\"ph\":\"C\""));
+    TEST_ASSERT_NOT_NULL(strstr(content, "\"args\":{\"limit\":4}"));
+    TEST_ASSERT_NOT_NULL(strstr(content, "\"args\":{\"limit\":1,"
+                                         "\"resource\":\"cpu\","
+                                         "\"pressure\":80.00,"
+                                         "\"threshold\":50.00}"));
+    free(content);
+}
+
+void test_trace(void)
+{
+    TEST_CASE_START();
+
+    /* Test that every thread records into its own track. */
+    TEST_CASE_RUN(test_trace_init,
+                  test_trace_cleanup,
+                  test_trace_threads);
+
+    /* Test that the buffers keep the newest events. */
+    TEST_CASE_RUN(test_trace_init,
+                  test_trace_cleanup,
+                  test_trace_ring);
+
+    /* Test that the changes of the pressure limit are in the trace. */
+    TEST_CASE_RUN(test_trace_init,
+                  test_trace_cleanup,
+                  test_trace_pressure);
+
+    TEST_CASE_END();
+}
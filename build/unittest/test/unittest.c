@@ -0,0 +1,60 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+
+#include "test_queue.h"
+#include "test_hash.h"
+#include "test_hash_lookup.h"
+#include "test_observer.h"
+#include "test_subject.h"
+#include "test_config_parser.h"
+#include "test_thread_pool.h"
+#include "test_task_handler.h"
+#include "test_pressure.h"
+#include "test_listener.h"
+#include "test_timer_wheel.h"
+#include "test_task_graph.h"
+#include "test_shutdown.h"
+#include "test_timing_db.h"
+#include "test_stats.h"
+#include "test_trace.h"
+
+int main(int argc, char *argv[])
+{
+    test_handler_init(argc, argv);
+
+    test_queue();
+    test_hash();
+    test_hash_lookup();
+    test_observer();
+    test_subject();
+    test_config_parser();
+    test_thread_pool();
+    test_task_handler();
+    test_pressure();
+    test_listener();
+    test_timer_wheel();
+    test_task_graph();
+    test_shutdown();
+    test_timing_db();
+    test_stats();
+    test_trace();
+
+    test_handler_deinit();
+
+    return 0;
+}
@@ -49,6 +49,7 @@ int config_parser_read_file(const char* filename, config_handler_t *handler)
     char* buffer_ptr;
     char* char_ptr;
     char* last_char_ptr;
+    char* newline_ptr;
 
     bool exit = false;
 
@@ -79,6 +80,7 @@ int config_parser_read_file(const char* filename, config_handler_t *handler)
         char_ptr = parser_buffer;
         /* Calculate the last character. */
         last_char_ptr = char_ptr + size;
+        newline_ptr = NULL;
 
         while (char_ptr < last_char_ptr) {
             fprintf(stderr, "STATE: %d %c\n", state, *char_ptr);
@@ -143,7 +145,7 @@ int config_parser_read_file(const char* filename, config_handler_t *handler)
                         case '\n':
                             state = PARSER_STATE_NEW_LINE;
                             handler->func_namespace(handler->handler,
-                                                    command_buffer);
+                                                    command_buffer, line);
                             break;
 
                         case ' ':
@@ -154,7 +156,7 @@ int config_parser_read_file(const char* filename, config_handler_t *handler)
                         case '#':
                             state = PARSER_STATE_COMMENT;
                             handler->func_namespace(handler->handler,
-                                                    command_buffer);
+                                                    command_buffer, line);
                             break;
 
                         default:
@@ -409,8 +411,11 @@ int config_parser_read_file(const char* filename, config_handler_t *handler)
                     break;
             }
 
-            if (*char_ptr == '\n') {
+            /* A character which is parsed again in a new state is only
+               counted once. */
+            if ((*char_ptr == '\n') && (char_ptr != newline_ptr)) {
                 line = line + 1;
+                newline_ptr = char_ptr;
             }
 
             /* Get the next character. */
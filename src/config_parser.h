@@ -33,7 +33,7 @@ typedef struct config_handler_t {
     void *handler;
     void (*func_start_config)(void *handler);
     void (*func_end_config)(void *handler);
-    void (*func_namespace)(void *handler, const char *name);
+    void (*func_namespace)(void *handler, const char *name, int line);
     void (*func_command)(void *handler, const char *command);
     void (*func_argument)(void *handler, const char *argument);
     void (*func_error)(void *handler, const char* filename, int line,
@@ -17,6 +17,39 @@
 #ifndef _SPEEDY_CORE_TYPE_H_
 #define _SPEEDY_CORE_TYPE_H_
 
+/*! Used for the scheduling values of a service/daemon which haven't been
+ *  set, the values are then inherited from Speedy. */
+#define SERVICE_NOT_SET -1000
+
+/*! Describes when a service/daemon is ready so that the services/daemons
+ *  that depend on it can start. */
+typedef enum service_type_t {
+    /*! The service is ready when it has exited. */
+    SERVICE_TYPE_ONESHOT,
+    /*! The service is ready when it writes "READY=1" to the file descriptor
+     *  in the environment variable NOTIFY_FD, it keeps running after that. */
+    SERVICE_TYPE_NOTIFY,
+    /*! The service doesn't execute anything, it is reached as soon as its
+     *  dependencies are. It is used for grouping services. */
+    SERVICE_TYPE_TARGET
+} service_type_t;
+
+/*! The CPU scheduling policies that can be used by a service/daemon. */
+typedef enum service_sched_t {
+    SERVICE_SCHED_NOT_SET,
+    SERVICE_SCHED_OTHER,
+    SERVICE_SCHED_BATCH,
+    SERVICE_SCHED_IDLE
+} service_sched_t;
+
+/*! The I/O scheduling classes that can be used by a service/daemon. */
+typedef enum service_io_class_t {
+    SERVICE_IO_CLASS_NOT_SET,
+    SERVICE_IO_CLASS_REALTIME,
+    SERVICE_IO_CLASS_BEST_EFFORT,
+    SERVICE_IO_CLASS_IDLE
+} service_io_class_t;
+
 /*!
  * Specifies the interface for each service/daemon that is going to be
  * started during system initialization or stopped during system shutdown.
@@ -30,16 +63,69 @@ typedef struct service_t {
     /*! A common name for a service/daemon. Used when there are several
      *  services/daemons that provides the same functionality. */
     char* provides;
-    /*! Contains the dependencies that needs to be started before the current
-     *  service/daemon can start.
-     *  \note Currently there isn't any decision if the dependency should be
-     *        mandatory or optional. This might be divided in future into
-     *        two dependency lists where one is optional and the other is
-     *        mandatory. */
+    /*! Contains the mandatory dependencies that needs to be started before
+     *  the current service/daemon can start. The service/daemon fails if any
+     *  of them is missing or fails. */
     char** dependency;
+    /*! Contains the optional dependencies, the service/daemon starts after
+     *  them but it doesn't matter if they are missing or fail. */
+    char** wants;
+    /*! Contains services/daemons that the current service/daemon only is
+     *  ordered after if they are started anyway. */
+    char** after;
     /*! Contains a function pointer to a function which is used for
         executing a certain action. */
     int (*action)(void);
+    /*! A shell command which is executed if there isn't any action. */
+    char* exec;
+    /*! Describes when the service is ready. */
+    service_type_t type;
+    /*! The addresses of the sockets that Speedy creates for the service
+     *  before anything is started, for example "unix:/run/x.sock" or
+     *  "tcp:127.0.0.1:80". The services that depend on it don't need to
+     *  wait for it since they can connect to the sockets directly. */
+    char** listen;
+    /*! The nice value, \c SERVICE_NOT_SET if it should be inherited. */
+    int nice;
+    /*! The CPU scheduling policy. */
+    service_sched_t sched;
+    /*! The I/O scheduling class. */
+    service_io_class_t io_class;
+    /*! The priority within the I/O scheduling class, 0 is the highest and 7
+     *  is the lowest. \c SERVICE_NOT_SET if the default should be used. */
+    int io_priority;
+    /*! A list of CPUs that the service is allowed to run on, for example
+     *  "0-3,6". \c NULL if it isn't restricted. */
+    char* cpus;
+    /*! The name of the concurrency group that the service belongs to,
+     *  \c NULL if it doesn't belong to any group. */
+    char* group;
+    /*! The number of I/O tokens that the service needs while it is
+     *  running. */
+    unsigned int io;
+    /*! The amount of memory in kilobytes that the service needs while it is
+     *  running. */
+    unsigned long mem;
+    /*! The time in milliseconds that the command may run before it is ready
+     *  or has exited, 0 if there isn't any timeout and \c SERVICE_NOT_SET if
+     *  the default timeout should be used. */
+    int timeout;
+    /*! The time in milliseconds that the process gets to exit after SIGTERM
+     *  when it is stopped before it is killed, \c SERVICE_NOT_SET if the
+     *  default should be used. */
+    int stop_timeout;
+    /*! The expected time in milliseconds from when the service is started
+     *  until it is ready or has exited, it is used instead of the recorded
+     *  durations. \c SERVICE_NOT_SET if it isn't known. */
+    int duration;
+    /*! The configuration file where the service/daemon is declared, \c NULL
+     *  if it isn't declared in any file. */
+    char* file;
+    /*! The line in the configuration file where the service/daemon is
+     *  declared, 0 if it is declared by the name of the file. */
+    int line;
 } service_t;
 
+void service_init(service_t *service);
+
 #endif /* _SPEEDY_CORE_TYPE_H_ */
@@ -16,6 +16,7 @@
 
 #include "queue.h"
 #include "observer.h"
+#include "stats.h"
 #include "subject.h"
 
 #include <stdlib.h>
@@ -65,17 +66,18 @@ void observer_init(observer_t *this_ptr,
 int observer_notify(observer_t *this_ptr, struct subject_t *from, void *msg)
 {
     int status = OBSERVER_SUCESS;
+    unsigned long locked;
 
     if (this_ptr != NULL) {
 
-        pthread_mutex_lock(&this_ptr->mutex);
+        locked = stats_lock(STATS_LOCK_OBSERVER, &this_ptr->mutex);
         if (this_ptr->notify != NULL) {
             this_ptr->notify(this_ptr, from, msg);
         } else {
             status = OBSERVER_CALLBACK_NULL;
         }
 
-        pthread_mutex_unlock(&this_ptr->mutex);
+        stats_unlock(STATS_LOCK_OBSERVER, &this_ptr->mutex, locked);
 
     } else {
         status = OBSERVER_NULL;
@@ -0,0 +1,320 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "pressure.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/*! The default minimum time in milliseconds between two samples, the PSI
+ *  averages are only updated every other second by the kernel. */
+#define PRESSURE_INTERVAL 500
+/*! The throttled limit is removed when it has grown to this value. */
+#define PRESSURE_MAX_LIMIT 256u
+/*! The maximum length of a path to a PSI file. */
+#define PRESSURE_MAX_PATH 256
+
+static const char *priv_pressure_names[PRESSURE_RESOURCES] = {
+    "cpu", "io", "memory"
+};
+
+static int pressure_read_psi(pressure_t *this_ptr, pressure_resource_t resource,
+                             double *pressure);
+static int pressure_read_fallback(pressure_t *this_ptr,
+                                  pressure_sample_t *sample);
+static bool pressure_is_due(pressure_t *this_ptr);
+static void pressure_update_limit(pressure_t *this_ptr,
+                                  const pressure_sample_t *sample,
+                                  unsigned int running);
+
+/*!
+ * Creates a pressure tracker which doesn't have any thresholds.
+ *
+ * \return A pointer to the pressure tracker or \c NULL if it couldn't be
+ *         created.
+ */
+pressure_t *pressure_create(void)
+{
+    pressure_t *this_ptr = (pressure_t*) malloc(sizeof(pressure_t));
+
+    if (this_ptr != NULL) {
+        pressure_init(this_ptr);
+    }
+    return this_ptr;
+}
+
+/*!
+ * Initializes a pressure tracker to read the system pressure from /proc.
+ *
+ * \param this_ptr - A pointer to the pressure tracker.
+ */
+void pressure_init(pressure_t *this_ptr)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    this_ptr->pressure_path = "/proc/pressure";
+    this_ptr->loadavg_path = "/proc/loadavg";
+    this_ptr->meminfo_path = "/proc/meminfo";
+    this_ptr->cpus = (cpus > 0) ? (unsigned int) cpus : 1u;
+    this_ptr->interval = PRESSURE_INTERVAL;
+    this_ptr->last_sample.tv_sec = 0;
+    this_ptr->last_sample.tv_nsec = 0;
+    this_ptr->limit = PRESSURE_NO_LIMIT;
+    this_ptr->read = pressure_read;
+    this_ptr->trace = NULL;
+
+    for (i = 0; i < PRESSURE_RESOURCES; i++) {
+        this_ptr->threshold[i] = 0.0;
+    }
+}
+
+/*!
+ * Sets the threshold for a resource.
+ *
+ * \param this_ptr - A pointer to the pressure tracker.
+ * \param resource - The name of the resource, "cpu", "io" or "memory".
+ * \param threshold - The threshold in percent, 0 disables the threshold.
+ *
+ * \return \c PRESSURE_SUCCESS if the threshold was set,
+ *         \c PRESSURE_FAIL if the resource is unknown.
+ */
+int pressure_set_threshold(pressure_t *this_ptr, const char *resource,
+                           double threshold)
+{
+    int i;
+
+    for (i = 0; i < PRESSURE_RESOURCES; i++) {
+        if (strcmp(resource, priv_pressure_names[i]) == 0) {
+            this_ptr->threshold[i] = threshold;
+            return PRESSURE_SUCCESS;
+        }
+    }
+    return PRESSURE_FAIL;
+}
+
+/*!
+ * Reads the current pressure of all the resources. The average over the last
+ * 10 seconds of the "some" line from PSI is used. If PSI isn't supported the
+ * CPU pressure is estimated as the share of the runnable tasks that don't
+ * have a CPU, and the memory pressure as the share of the memory that isn't
+ * available. The I/O pressure can't be estimated and is then 0.
+ *
+ * \param this_ptr - A pointer to the pressure tracker.
+ * \param sample - The pressure is stored here.
+ *
+ * \return \c PRESSURE_SUCCESS if the pressure was read,
+ *         \c PRESSURE_FAIL otherwise.
+ */
+int pressure_read(pressure_t *this_ptr, pressure_sample_t *sample)
+{
+    int i;
+
+    for (i = 0; i < PRESSURE_RESOURCES; i++) {
+        if (pressure_read_psi(this_ptr, (pressure_resource_t) i,
+                              &sample->pressure[i]) != PRESSURE_SUCCESS) {
+
+            return pressure_read_fallback(this_ptr, sample);
+        }
+    }
+    return PRESSURE_SUCCESS;
+}
+
+/*!
+ * Gets the number of tasks that can be running at the same time. A new
+ * sample is read if the previous sample is older than the interval. The limit
+ * is halved each time any resource is above its threshold and it is doubled
+ * when all resources are below their thresholds, until the limit is removed.
+ *
+ * \param this_ptr - A pointer to the pressure tracker.
+ * \param running - The number of tasks that are currently running.
+ *
+ * \return The number of tasks that can be running, \c PRESSURE_NO_LIMIT if
+ *         the admission isn't limited.
+ */
+unsigned int pressure_get_limit(pressure_t *this_ptr, unsigned int running)
+{
+    pressure_sample_t sample;
+
+    if (pressure_is_due(this_ptr) &&
+        (this_ptr->read(this_ptr, &sample) == PRESSURE_SUCCESS)) {
+
+        pressure_update_limit(this_ptr, &sample, running);
+    }
+    return this_ptr->limit;
+}
+
+/*!
+ * Destroys a pressure tracker.
+ *
+ * \param this_ptr - A pointer to the pressure tracker.
+ */
+void pressure_destroy(pressure_t *this_ptr)
+{
+    free(this_ptr);
+}
+
+/*!
+ * Reads the pressure of a resource from PSI.
+ */
+static int pressure_read_psi(pressure_t *this_ptr, pressure_resource_t resource,
+                             double *pressure)
+{
+    char path[PRESSURE_MAX_PATH];
+    int status = PRESSURE_FAIL;
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s/%s", this_ptr->pressure_path,
+             priv_pressure_names[resource]);
+
+    file = fopen(path, "r");
+    if (file != NULL) {
+        if (fscanf(file, "some avg10=%lf", pressure) == 1) {
+            status = PRESSURE_SUCCESS;
+        }
+        fclose(file);
+    }
+    return status;
+}
+
+/*!
+ * Estimates the pressure from the load average and the available memory.
+ */
+static int pressure_read_fallback(pressure_t *this_ptr,
+                                  pressure_sample_t *sample)
+{
+    unsigned long mem_total = 0u;
+    unsigned long mem_available = 0u;
+    unsigned long value;
+    char line[128];
+    double load;
+    FILE *file;
+
+    file = fopen(this_ptr->loadavg_path, "r");
+    if (file == NULL) {
+        return PRESSURE_FAIL;
+    }
+    if (fscanf(file, "%lf", &load) != 1) {
+        fclose(file);
+        return PRESSURE_FAIL;
+    }
+    fclose(file);
+
+    sample->pressure[PRESSURE_CPU] = 0.0;
+    if (load > (double) this_ptr->cpus) {
+        sample->pressure[PRESSURE_CPU] = (load - this_ptr->cpus) * 100.0 /
+                                         load;
+    }
+    sample->pressure[PRESSURE_IO] = 0.0;
+    sample->pressure[PRESSURE_MEMORY] = 0.0;
+
+    file = fopen(this_ptr->meminfo_path, "r");
+    if (file != NULL) {
+        while (fgets(line, sizeof(line), file) != NULL) {
+            if (sscanf(line, "MemTotal: %lu kB", &value) == 1) {
+                mem_total = value;
+            } else if (sscanf(line, "MemAvailable: %lu kB", &value) == 1) {
+                mem_available = value;
+            }
+        }
+        fclose(file);
+
+        if ((mem_total > 0u) && (mem_available <= mem_total)) {
+            sample->pressure[PRESSURE_MEMORY] =
+                    (mem_total - mem_available) * 100.0 / mem_total;
+        }
+    }
+    return PRESSURE_SUCCESS;
+}
+
+/*!
+ * Checks if it is time to read a new sample.
+ */
+static bool pressure_is_due(pressure_t *this_ptr)
+{
+    struct timespec now;
+    long elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - this_ptr->last_sample.tv_sec) * 1000L +
+              (now.tv_nsec - this_ptr->last_sample.tv_nsec) / 1000000L;
+
+    if ((this_ptr->last_sample.tv_sec != 0) && (elapsed < this_ptr->interval)) {
+        return false;
+    }
+    this_ptr->last_sample = now;
+    return true;
+}
+
+/*!
+ * Updates the limit from a new sample and reports when it changes, both on
+ * the standard output and in the trace.
+ */
+static void pressure_update_limit(pressure_t *this_ptr,
+                                  const pressure_sample_t *sample,
+                                  unsigned int running)
+{
+    unsigned int limit = this_ptr->limit;
+    int exceeded = -1;
+    int i;
+
+    for (i = 0; (i < PRESSURE_RESOURCES) && (exceeded < 0); i++) {
+        if ((this_ptr->threshold[i] > 0.0) &&
+            (sample->pressure[i] > this_ptr->threshold[i])) {
+            exceeded = i;
+        }
+    }
+
+    if (exceeded >= 0) {
+        if (running < limit) {
+            limit = running;
+        }
+        limit = (limit > 1u) ? limit / 2u : 1u;
+    } else if (limit != PRESSURE_NO_LIMIT) {
+        limit *= 2u;
+        if (limit >= PRESSURE_MAX_LIMIT) {
+            limit = PRESSURE_NO_LIMIT;
+        }
+    }
+
+    if (limit != this_ptr->limit) {
+        if (exceeded >= 0) {
+            printf("Pressure: %s %.2f above %.2f, limiting to %u tasks.\n",
+                   priv_pressure_names[exceeded], sample->pressure[exceeded],
+                   this_ptr->threshold[exceeded], limit);
+        } else if (limit != PRESSURE_NO_LIMIT) {
+            printf("Pressure: below the thresholds, limiting to %u tasks.\n",
+                   limit);
+        } else {
+            printf("Pressure: below the thresholds, no limit.\n");
+        }
+
+        if (exceeded >= 0) {
+            trace_record_limit(this_ptr->trace, limit,
+                               priv_pressure_names[exceeded],
+                               sample->pressure[exceeded],
+                               this_ptr->threshold[exceeded]);
+        } else {
+            trace_record_limit(this_ptr->trace,
+                               (limit != PRESSURE_NO_LIMIT) ? limit : 0u,
+                               NULL, 0.0, 0.0);
+        }
+        this_ptr->limit = limit;
+    }
+}
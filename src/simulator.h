@@ -0,0 +1,105 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#ifndef _SPEEDY_SIMULATOR_H_
+#define _SPEEDY_SIMULATOR_H_
+
+#include <stdbool.h>
+
+/*! The operation was successfully executed. */
+#define SIMULATOR_SUCCESS 0
+/*! General error which mostly likely happens during malloc. */
+#define SIMULATOR_FAIL -1
+
+struct task_handler_t;
+struct task_graph_t;
+struct task_t;
+
+/*!
+ * The order in which the ready tasks are started.
+ */
+typedef enum simulator_policy_t {
+    /*! The highest priority first, like the task handler does. */
+    SIMULATOR_PRIORITY,
+    /*! The order in which the tasks became ready. */
+    SIMULATOR_FIFO
+} simulator_policy_t;
+
+/*!
+ * The predicted outcome of a boot.
+ */
+typedef struct simulator_result_t {
+    unsigned int threads; /*!< The number of worker threads. */
+    /*! The time in milliseconds until the last task has finished. */
+    unsigned long makespan;
+    /*! The total time in milliseconds that the workers were busy. */
+    unsigned long busy;
+    /*! The number of tasks that finished, the others were never admitted. */
+    unsigned int finished;
+    /*! The nodes of the chain of tasks that decided the makespan, each task
+     *  was started by the end of the task before it. */
+    unsigned int *chain;
+    unsigned int chain_size; /*!< The number of nodes in the chain. */
+} simulator_result_t;
+
+/*!
+ * Runs the scheduling of the task handler against a virtual clock. Every
+ * task takes its estimated cost, and a task occupies one of a fixed number
+ * of workers while it runs. The events are handled one at a time in the
+ * same way as the task handler handles a finished task: the dependents are
+ * released, the admission is done and the admitted tasks are started in the
+ * order that they were admitted.
+ */
+typedef struct simulator_t {
+    struct task_handler_t *handler; /*!< The task handler, not owned. */
+    struct task_graph_t *graph; /*!< The checked dependency graph. */
+    struct task_t **nodes; /*!< The task of each node. */
+    simulator_policy_t policy; /*!< The order of the ready tasks. */
+    unsigned int threads; /*!< The number of workers. */
+    unsigned long now; /*!< The virtual time in milliseconds. */
+    /*! The position in \c index of the first dependent edge of each node. */
+    unsigned int *first;
+    unsigned int *index; /*!< The edges in the order of their dependencies. */
+    /*! The number of dependencies of each node that haven't finished. */
+    unsigned int *remaining;
+    bool *released; /*!< \c true if the node has become ready. */
+    unsigned long *ready_at; /*!< The time when each node became ready. */
+    unsigned long *end; /*!< The time when each node finished. */
+    /*! The node whose end started each node, \c TASK_GRAPH_NONE for the
+     *  nodes that started at once. */
+    unsigned int *cause;
+    struct task_t **batch; /*!< The tasks which became ready together. */
+    unsigned int batch_size; /*!< The number of tasks in the batch. */
+    /*! The tasks which didn't fit in the admission, in admission order. */
+    struct task_t **pending;
+    unsigned int pending_size; /*!< The number of pending tasks. */
+    /*! The tasks which are kept pending while the admission is merged. */
+    struct task_t **kept;
+    /*! The admitted tasks which wait for a worker, as a ring. */
+    struct task_t **queue;
+    unsigned int queue_first; /*!< The position of the first queued task. */
+    unsigned int queue_size; /*!< The number of queued tasks. */
+    struct task_t **running; /*!< The tasks which occupy a worker. */
+    unsigned int running_size; /*!< The number of running tasks. */
+    unsigned int *stack; /*!< The reached targets to release. */
+    unsigned long busy; /*!< The time that the workers have been busy. */
+    unsigned int finished; /*!< The number of finished tasks. */
+} simulator_t;
+
+int simulator_run(struct task_handler_t *handler, unsigned int threads,
+                  simulator_policy_t policy, simulator_result_t *result);
+void simulator_result_deinit(simulator_result_t *result);
+
+#endif /* _SPEEDY_SIMULATOR_H_ */
@@ -0,0 +1,387 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "timer_wheel.h"
+
+#include <stdlib.h>
+
+/*! The mask for a slot index within a level. */
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+static void timer_wheel_insert(timer_wheel_t *this_ptr,
+                               timer_wheel_timer_t *timer);
+static void timer_wheel_unlink(timer_wheel_timer_t *timer);
+static void timer_wheel_cascade(timer_wheel_t *this_ptr, int level);
+static void timer_wheel_tick(timer_wheel_t *this_ptr);
+static unsigned long timer_wheel_now(timer_wheel_t *this_ptr);
+static void *timer_wheel_thread(void *arg);
+
+/*!
+ * Creates a timer wheel, the timers are driven by \c timer_wheel_advance
+ * until the timer thread is started.
+ *
+ * \param resolution - The number of milliseconds per tick.
+ *
+ * \return A pointer to the timer wheel or \c NULL if it couldn't be created.
+ */
+timer_wheel_t *timer_wheel_create(unsigned int resolution)
+{
+    timer_wheel_t *this_ptr = (timer_wheel_t*) malloc(sizeof(timer_wheel_t));
+    pthread_condattr_t attributes;
+    int level;
+    int slot;
+
+    if (this_ptr != NULL) {
+        for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+            for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+                this_ptr->slots[level][slot].next =
+                        &this_ptr->slots[level][slot];
+                this_ptr->slots[level][slot].previous =
+                        &this_ptr->slots[level][slot];
+            }
+        }
+        this_ptr->current = 0u;
+        this_ptr->resolution = (resolution > 0u) ? resolution : 1u;
+        this_ptr->timers = 0u;
+        this_ptr->running = NULL;
+        this_ptr->started = false;
+        this_ptr->exit = false;
+
+        pthread_mutex_init(&this_ptr->mutex, NULL);
+        pthread_condattr_init(&attributes);
+        pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+        pthread_cond_init(&this_ptr->condition, &attributes);
+        pthread_condattr_destroy(&attributes);
+    }
+    return this_ptr;
+}
+
+/*!
+ * Initializes a timer.
+ *
+ * \param timer - A pointer to the timer.
+ * \param expired - Called when the timer expires.
+ * \param context - A pointer which can be used by the expired function.
+ */
+void timer_wheel_timer_init(timer_wheel_timer_t *timer,
+                            void (*expired)(timer_wheel_timer_t *timer),
+                            void *context)
+{
+    timer->next = NULL;
+    timer->previous = NULL;
+    timer->expires = 0u;
+    timer->armed = false;
+    timer->expired = expired;
+    timer->context = context;
+}
+
+/*!
+ * Adds a timer to the timer wheel, a timer which already is in the timer
+ * wheel is moved.
+ *
+ * \param this_ptr - A pointer to the timer wheel.
+ * \param timer - A pointer to the timer.
+ * \param timeout - The time in milliseconds until the timer expires.
+ */
+void timer_wheel_add(timer_wheel_t *this_ptr, timer_wheel_timer_t *timer,
+                     unsigned long timeout)
+{
+    /* Round up so that the timer never expires too early. */
+    unsigned long ticks = (timeout + this_ptr->resolution - 1u) /
+                          this_ptr->resolution;
+    unsigned long now;
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    if (timer->armed) {
+        timer_wheel_unlink(timer);
+        this_ptr->timers--;
+    }
+    if (this_ptr->started && (this_ptr->timers == 0u)) {
+        /* The timer thread doesn't tick an empty timer wheel, so the ticks
+         * since the last timer are skipped. */
+        now = timer_wheel_now(this_ptr);
+        if (now > this_ptr->current) {
+            this_ptr->current = now;
+        }
+    }
+    timer->expires = this_ptr->current + ((ticks > 0u) ? ticks : 1u);
+    timer->armed = true;
+    timer_wheel_insert(this_ptr, timer);
+    this_ptr->timers++;
+    pthread_cond_broadcast(&this_ptr->condition);
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Removes a timer from the timer wheel. If the expired function of the timer
+ * is running, the function waits until it has returned, so the timer can
+ * safely be reused or freed afterwards.
+ *
+ * \note This function must not be called from the expired function of the
+ *       same timer.
+ *
+ * \param this_ptr - A pointer to the timer wheel.
+ * \param timer - A pointer to the timer.
+ */
+void timer_wheel_cancel(timer_wheel_t *this_ptr, timer_wheel_timer_t *timer)
+{
+    pthread_mutex_lock(&this_ptr->mutex);
+    while (this_ptr->running == timer) {
+        pthread_cond_wait(&this_ptr->condition, &this_ptr->mutex);
+    }
+    if (timer->armed) {
+        timer_wheel_unlink(timer);
+        timer->armed = false;
+        this_ptr->timers--;
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Starts the thread which drives the timer wheel in real time.
+ *
+ * \param this_ptr - A pointer to the timer wheel.
+ *
+ * \return \c TIMER_WHEEL_SUCCESS if the thread is running,
+ *         \c TIMER_WHEEL_FAIL otherwise.
+ */
+int timer_wheel_start(timer_wheel_t *this_ptr)
+{
+    int status = TIMER_WHEEL_SUCCESS;
+    unsigned long elapsed;
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    if (!this_ptr->started) {
+        /* Start the clock as if the current tick was reached now. */
+        elapsed = this_ptr->current * this_ptr->resolution;
+        clock_gettime(CLOCK_MONOTONIC, &this_ptr->start);
+        this_ptr->start.tv_sec -= (time_t) (elapsed / 1000u);
+        this_ptr->start.tv_nsec -= (long) (elapsed % 1000u) * 1000000L;
+        if (this_ptr->start.tv_nsec < 0) {
+            this_ptr->start.tv_sec--;
+            this_ptr->start.tv_nsec += 1000000000L;
+        }
+        if (pthread_create(&this_ptr->thread, NULL, timer_wheel_thread,
+                           this_ptr) == 0) {
+            this_ptr->started = true;
+        } else {
+            status = TIMER_WHEEL_FAIL;
+        }
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    return status;
+}
+
+/*!
+ * Advances the timer wheel and calls the expired functions of the timers
+ * that have expired. This is done by the timer thread when it is running.
+ *
+ * \param this_ptr - A pointer to the timer wheel.
+ * \param ticks - The number of ticks to advance.
+ */
+void timer_wheel_advance(timer_wheel_t *this_ptr, unsigned long ticks)
+{
+    pthread_mutex_lock(&this_ptr->mutex);
+    while (ticks > 0u) {
+        timer_wheel_tick(this_ptr);
+        ticks--;
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+}
+
+/*!
+ * Destroys a timer wheel, the timers that haven't expired are discarded.
+ *
+ * \param this_ptr - A pointer to the timer wheel.
+ */
+void timer_wheel_destroy(timer_wheel_t *this_ptr)
+{
+    if (this_ptr == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    this_ptr->exit = true;
+    pthread_cond_broadcast(&this_ptr->condition);
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    if (this_ptr->started) {
+        pthread_join(this_ptr->thread, NULL);
+    }
+    pthread_cond_destroy(&this_ptr->condition);
+    pthread_mutex_destroy(&this_ptr->mutex);
+    free(this_ptr);
+}
+
+/*!
+ * Inserts a timer in the slot that matches its expiry time. A timer which
+ * expires within 64 ticks is put in the first level, a timer which expires
+ * within 64 * 64 ticks in the second level and so on. The mutex must be
+ * locked by the caller.
+ */
+static void timer_wheel_insert(timer_wheel_t *this_ptr,
+                               timer_wheel_timer_t *timer)
+{
+    unsigned long max = (1ul << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS))
+                        - 1u;
+    unsigned long delta;
+    timer_wheel_timer_t *head;
+    int level = 0;
+
+    if (timer->expires < this_ptr->current) {
+        timer->expires = this_ptr->current;
+    }
+    delta = timer->expires - this_ptr->current;
+    if (delta > max) {
+        /* Timers beyond the last level expire at the end of it. */
+        timer->expires = this_ptr->current + max;
+        delta = max;
+    }
+
+    while ((level < (TIMER_WHEEL_LEVELS - 1)) &&
+           (delta >= (1ul << (TIMER_WHEEL_SLOT_BITS * (level + 1))))) {
+        level++;
+    }
+
+    head = &this_ptr->slots[level][(timer->expires >>
+            (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK];
+
+    timer->next = head;
+    timer->previous = head->previous;
+    head->previous->next = timer;
+    head->previous = timer;
+}
+
+/*!
+ * Removes a timer from its slot.
+ */
+static void timer_wheel_unlink(timer_wheel_timer_t *timer)
+{
+    timer->previous->next = timer->next;
+    timer->next->previous = timer->previous;
+    timer->next = NULL;
+    timer->previous = NULL;
+}
+
+/*!
+ * Moves the timers in the current slot of a level to the lower levels. This
+ * is done each time the lower level has gone around once. The mutex must be
+ * locked by the caller.
+ */
+static void timer_wheel_cascade(timer_wheel_t *this_ptr, int level)
+{
+    timer_wheel_timer_t *head = &this_ptr->slots[level][(this_ptr->current >>
+            (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK];
+    timer_wheel_timer_t *timer;
+
+    /* Cascade the next level first when this level also has gone around. */
+    if ((level < (TIMER_WHEEL_LEVELS - 1)) &&
+        (((this_ptr->current >> (TIMER_WHEEL_SLOT_BITS * level)) &
+          TIMER_WHEEL_SLOT_MASK) == 0u)) {
+        timer_wheel_cascade(this_ptr, level + 1);
+    }
+
+    while (head->next != head) {
+        timer = head->next;
+        timer_wheel_unlink(timer);
+        timer_wheel_insert(this_ptr, timer);
+    }
+}
+
+/*!
+ * Expires the timers of the current tick and moves to the next tick. The
+ * mutex must be locked by the caller, it is unlocked while the expired
+ * functions are called.
+ */
+static void timer_wheel_tick(timer_wheel_t *this_ptr)
+{
+    unsigned long index = this_ptr->current & TIMER_WHEEL_SLOT_MASK;
+    timer_wheel_timer_t *head;
+    timer_wheel_timer_t *timer;
+
+    if ((index == 0u) && (this_ptr->current > 0u)) {
+        timer_wheel_cascade(this_ptr, 1);
+    }
+
+    head = &this_ptr->slots[0][index];
+    while (head->next != head) {
+        timer = head->next;
+        timer_wheel_unlink(timer);
+        timer->armed = false;
+        this_ptr->timers--;
+        this_ptr->running = timer;
+
+        pthread_mutex_unlock(&this_ptr->mutex);
+        timer->expired(timer);
+        pthread_mutex_lock(&this_ptr->mutex);
+
+        this_ptr->running = NULL;
+        pthread_cond_broadcast(&this_ptr->condition);
+    }
+    this_ptr->current++;
+}
+
+/*!
+ * Gets the number of ticks since the timer thread was started.
+ */
+static unsigned long timer_wheel_now(timer_wheel_t *this_ptr)
+{
+    struct timespec now;
+    long elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (long) (now.tv_sec - this_ptr->start.tv_sec) * 1000L +
+              (now.tv_nsec - this_ptr->start.tv_nsec) / 1000000L;
+    return (unsigned long) elapsed / this_ptr->resolution;
+}
+
+/*!
+ * The timer thread, it advances the timer wheel in real time. The thread
+ * sleeps until a timer is added when there aren't any timers.
+ */
+static void *timer_wheel_thread(void *arg)
+{
+    timer_wheel_t *this_ptr = arg;
+    struct timespec wake_up;
+    unsigned long next;
+
+    pthread_mutex_lock(&this_ptr->mutex);
+    while (!this_ptr->exit) {
+        next = timer_wheel_now(this_ptr);
+        while ((this_ptr->current <= next) && !this_ptr->exit) {
+            timer_wheel_tick(this_ptr);
+        }
+
+        if (this_ptr->timers == 0u) {
+            pthread_cond_wait(&this_ptr->condition, &this_ptr->mutex);
+        } else {
+            next = (this_ptr->current * this_ptr->resolution);
+            wake_up.tv_sec = this_ptr->start.tv_sec + (time_t) (next / 1000u);
+            wake_up.tv_nsec = this_ptr->start.tv_nsec +
+                              (long) (next % 1000u) * 1000000L;
+            if (wake_up.tv_nsec >= 1000000000L) {
+                wake_up.tv_sec++;
+                wake_up.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&this_ptr->condition, &this_ptr->mutex,
+                                   &wake_up);
+        }
+    }
+    pthread_mutex_unlock(&this_ptr->mutex);
+
+    return NULL;
+}
@@ -0,0 +1,268 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "core_type.h"
+#include "hash.h"
+#include "hash_lookup.h"
+#include "timing_db.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*! A new duration moves the estimate by 1 / TIMING_DB_WEIGHT of the
+ *  difference, so a single slow boot doesn't throw it off. */
+#define TIMING_DB_WEIGHT 4
+/*! Spreads the service type over the bits of the configuration hash. */
+#define TIMING_DB_TYPE_MIX 0x9e3779b9u
+/*! The maximum length of the path of the temporary file. */
+#define TIMING_DB_MAX_PATH 4096
+
+static timing_db_entry_t *timing_db_add(timing_db_t *this_ptr,
+                                        unsigned int name_id,
+                                        unsigned int config_id);
+static void timing_db_load(timing_db_t *this_ptr);
+
+/*!
+ * Creates a timing database and reads the entries from its file, the
+ * database is empty if the file doesn't exist yet.
+ *
+ * \param path - The file of the database.
+ *
+ * \return A pointer to the database or \c NULL if it couldn't be created.
+ */
+timing_db_t *timing_db_create(const char *path)
+{
+    timing_db_t *this_ptr = (timing_db_t*) malloc(sizeof(timing_db_t));
+
+    if (this_ptr != NULL) {
+        this_ptr->path = strdup(path);
+        this_ptr->lookup = hash_lookup_create(64);
+        this_ptr->changed = false;
+        queue_init(&this_ptr->entries);
+
+        if ((this_ptr->path == NULL) || (this_ptr->lookup == NULL)) {
+            timing_db_destroy(this_ptr);
+            return NULL;
+        }
+        timing_db_load(this_ptr);
+    }
+    return this_ptr;
+}
+
+/*!
+ * Generates the hash of the parts of the configuration of a service which
+ * affect how long it takes to start.
+ *
+ * \param service - A pointer to the service.
+ *
+ * \return The hash of the configuration.
+ */
+unsigned int timing_db_config_id(const service_t *service)
+{
+    const char *exec = (service->exec != NULL) ? service->exec : "";
+
+    return hash_generate(exec) ^
+           ((unsigned int) service->type * TIMING_DB_TYPE_MIX);
+}
+
+/*!
+ * Gets the estimated duration of a service.
+ *
+ * \param this_ptr - A pointer to the database.
+ * \param name_id - The hash of the name of the service.
+ * \param config_id - The hash of the configuration of the service.
+ * \param estimate - Set to the estimate in milliseconds.
+ *
+ * \return \c true if there is an estimate for the service with this
+ *         configuration, \c false otherwise.
+ */
+bool timing_db_get(timing_db_t *this_ptr, unsigned int name_id,
+                   unsigned int config_id, unsigned long *estimate)
+{
+    timing_db_entry_t *entry = hash_lookup_find(this_ptr->lookup, name_id);
+
+    if ((entry == NULL) || (entry->config_id != config_id) ||
+        (entry->samples == 0u)) {
+        return false;
+    }
+    *estimate = entry->estimate;
+    return true;
+}
+
+/*!
+ * Records a duration of a service. The first duration becomes the estimate,
+ * the later ones are weighted in. The estimate starts over if the
+ * configuration of the service has changed.
+ *
+ * \param this_ptr - A pointer to the database.
+ * \param name_id - The hash of the name of the service.
+ * \param config_id - The hash of the configuration of the service.
+ * \param duration - The duration in milliseconds.
+ *
+ * \return \c TIMING_DB_SUCCESS if the duration was recorded,
+ *         \c TIMING_DB_FAIL otherwise.
+ */
+int timing_db_update(timing_db_t *this_ptr, unsigned int name_id,
+                     unsigned int config_id, unsigned long duration)
+{
+    timing_db_entry_t *entry = hash_lookup_find(this_ptr->lookup, name_id);
+
+    if (entry == NULL) {
+        entry = timing_db_add(this_ptr, name_id, config_id);
+        if (entry == NULL) {
+            return TIMING_DB_FAIL;
+        }
+    }
+
+    if ((entry->config_id != config_id) || (entry->samples == 0u)) {
+        entry->config_id = config_id;
+        entry->estimate = duration;
+        entry->samples = 1u;
+    } else {
+        if (duration > entry->estimate) {
+            entry->estimate += (duration - entry->estimate) / TIMING_DB_WEIGHT;
+        } else {
+            entry->estimate -= (entry->estimate - duration) / TIMING_DB_WEIGHT;
+        }
+        entry->samples++;
+    }
+    this_ptr->changed = true;
+    return TIMING_DB_SUCCESS;
+}
+
+/*!
+ * Writes the database to its file if anything has changed. The entries are
+ * written to a temporary file which then replaces the file, so a crash
+ * during the write never leaves a truncated database.
+ *
+ * \param this_ptr - A pointer to the database.
+ *
+ * \return \c TIMING_DB_SUCCESS if the database was written or didn't need
+ *         to be, \c TIMING_DB_FAIL otherwise.
+ */
+int timing_db_save(timing_db_t *this_ptr)
+{
+    char path[TIMING_DB_MAX_PATH];
+    timing_db_entry_t *entry;
+    int status = TIMING_DB_SUCCESS;
+    FILE *file;
+
+    if (!this_ptr->changed) {
+        return TIMING_DB_SUCCESS;
+    }
+
+    snprintf(path, sizeof(path), "%s.tmp", this_ptr->path);
+    file = fopen(path, "w");
+    if (file == NULL) {
+        return TIMING_DB_FAIL;
+    }
+
+    queue_first(&this_ptr->entries);
+    while ((entry = queue_get_current(&this_ptr->entries)) != NULL) {
+        if (fprintf(file, "%08x %08x %lu %u\n", entry->name_id,
+                    entry->config_id, entry->estimate, entry->samples) < 0) {
+            status = TIMING_DB_FAIL;
+        }
+        queue_next(&this_ptr->entries);
+    }
+
+    if ((fclose(file) != 0) || (status != TIMING_DB_SUCCESS) ||
+        (rename(path, this_ptr->path) != 0)) {
+        remove(path);
+        return TIMING_DB_FAIL;
+    }
+    this_ptr->changed = false;
+    return TIMING_DB_SUCCESS;
+}
+
+/*!
+ * Destroys the database without writing it.
+ */
+void timing_db_destroy(timing_db_t *this_ptr)
+{
+    timing_db_entry_t *entry;
+
+    while ((entry = queue_pop(&this_ptr->entries)) != NULL) {
+        free(entry);
+    }
+    queue_deinit(&this_ptr->entries);
+    if (this_ptr->lookup != NULL) {
+        hash_lookup_destroy(this_ptr->lookup);
+    }
+    free(this_ptr->path);
+    free(this_ptr);
+}
+
+/*!
+ * Adds an empty entry for a service.
+ *
+ * \return A pointer to the entry or \c NULL if it couldn't be added.
+ */
+static timing_db_entry_t *timing_db_add(timing_db_t *this_ptr,
+                                        unsigned int name_id,
+                                        unsigned int config_id)
+{
+    timing_db_entry_t *entry = malloc(sizeof(timing_db_entry_t));
+
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->name_id = name_id;
+    entry->config_id = config_id;
+    entry->estimate = 0u;
+    entry->samples = 0u;
+
+    if (hash_lookup_insert(this_ptr->lookup, name_id, entry) !=
+        HASH_LOOKUP_SUCESS) {
+        free(entry);
+        return NULL;
+    }
+    if (queue_push(&this_ptr->entries, entry) != QUEUE_SUCESS) {
+        hash_lookup_remove(this_ptr->lookup, name_id);
+        free(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+/*!
+ * Reads the entries from the file of the database, one entry per line.
+ * Reading stops at the first line which can't be parsed.
+ */
+static void timing_db_load(timing_db_t *this_ptr)
+{
+    timing_db_entry_t *entry;
+    unsigned int name_id;
+    unsigned int config_id;
+    unsigned long estimate;
+    unsigned int samples;
+    FILE *file;
+
+    file = fopen(this_ptr->path, "r");
+    if (file == NULL) {
+        return;
+    }
+
+    while (fscanf(file, "%x %x %lu %u", &name_id, &config_id, &estimate,
+                  &samples) == 4) {
+        entry = timing_db_add(this_ptr, name_id, config_id);
+        if (entry != NULL) {
+            entry->estimate = estimate;
+            entry->samples = samples;
+        }
+    }
+    fclose(file);
+}
@@ -41,7 +41,8 @@ void missing_file_end_callback(void *handler)
     TEST_FAIL();
 }
 
-void missing_file_namespace_callback(void *handler, const char *name)
+void missing_file_namespace_callback(void *handler, const char *name,
+                                    int line)
 {
     TEST_FAIL();
 }
@@ -101,7 +102,8 @@ void empty_file_end_callback(void *handler)
     priv_end = true;
 }
 
-void empty_file_namespace_callback(void *handler, const char *name)
+void empty_file_namespace_callback(void *handler, const char *name,
+                                    int line)
 {
     TEST_FAIL();
 }
@@ -168,23 +170,29 @@ void normal_file_end_callback(void *handler)
     priv_end = true;
 }
 
-void normal_file_namespace_callback(void *handler, const char *name)
+void normal_file_namespace_callback(void *handler, const char *name,
+                                    int line)
 {
     switch(priv_counter) {
         case 0:
             TEST_ASSERT_EQUAL_STRING("example0", name);
+            TEST_ASSERT_EQUAL(3, line);
             break;
         case 1:
             TEST_ASSERT_EQUAL_STRING("example1", name);
+            TEST_ASSERT_EQUAL(5, line);
             break;
         case 8:
             TEST_ASSERT_EQUAL_STRING("example2", name);
+            TEST_ASSERT_EQUAL(11, line);
             break;
         case 11:
             TEST_ASSERT_EQUAL_STRING("example3", name);
+            TEST_ASSERT_EQUAL(14, line);
             break;
         case 17:
             TEST_ASSERT_EQUAL_STRING("example3", name);
+            TEST_ASSERT_EQUAL(22, line);
             break;
         default:
             fprintf(stderr, "Counter: %d\n", priv_counter);
@@ -360,7 +368,8 @@ void errornous_file_end_callback(void *handler)
     priv_end = true;
 }
 
-void errornous_file_namespace_callback(void *handler, const char *name)
+void errornous_file_namespace_callback(void *handler, const char *name,
+                                    int line)
 {
     fprintf(stderr, "Counter: %d\n", priv_counter);
     TEST_FAIL();
@@ -16,9 +16,13 @@
 
 #include "test_handler.h"
 
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 
 static char *priv_path = NULL;
 
@@ -58,6 +62,79 @@ const char* test_handler_get_current_path(void)
     return priv_path;
 }
 
+/* Checks if a process is still running and has an argument, a zombie that
+ * nobody has reaped yet isn't running. */
+static bool test_handler_has_argument(const char *pid, const char *argument)
+{
+    char path[64];
+    char line[512];
+    char *fields;
+    size_t size;
+    size_t offset;
+    FILE *file;
+
+    snprintf(path, sizeof(path), "/proc/%.32s/stat", pid);
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    /* The name of the command may contain spaces, the state follows it. */
+    size = fread(line, 1u, sizeof(line) - 1u, file);
+    fclose(file);
+    line[size] = '\0';
+    fields = strrchr(line, ')');
+    if ((fields == NULL) || (fields[1] == '\0') || (fields[2] == 'Z')) {
+        return false;
+    }
+
+    snprintf(path, sizeof(path), "/proc/%.32s/cmdline", pid);
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    size = fread(line, 1u, sizeof(line) - 1u, file);
+    fclose(file);
+    line[size] = '\0';
+    for (offset = 0u; offset < size; offset += strlen(&line[offset]) + 1u) {
+        if (strcmp(&line[offset], argument) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Waits up to a number of milliseconds for the processes that have an
+ * argument to exit, returns the number of processes that are left. */
+unsigned int test_handler_count_processes(const char *argument,
+                                          unsigned int wait)
+{
+    struct timespec delay = {0, 10000000L};
+    struct dirent *entry;
+    unsigned int count;
+    DIR *proc;
+
+    for (;;) {
+        count = 0u;
+        proc = opendir("/proc");
+        if (proc == NULL) {
+            return 0u;
+        }
+        while ((entry = readdir(proc)) != NULL) {
+            if ((entry->d_name[0] >= '0') && (entry->d_name[0] <= '9') &&
+                test_handler_has_argument(entry->d_name, argument)) {
+
+                count++;
+            }
+        }
+        closedir(proc);
+        if ((count == 0u) || (wait < 10u)) {
+            return count;
+        }
+        nanosleep(&delay, NULL);
+        wait -= 10u;
+    }
+}
+
 void test_handler_init(int argc, char *argv[])
 {
     char *path = strdup(argv[0]);
@@ -34,6 +34,9 @@ void test_handler_run_test(test_case_t *test_case);
 
 const char* test_handler_get_current_path(void);
 
+unsigned int test_handler_count_processes(const char *argument,
+                                          unsigned int wait);
+
 #define TEST_CASE_RUN(init_exec, clean_exec, test_exec) \
             do { \
                 test_case_t test_case; \
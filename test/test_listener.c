@@ -0,0 +1,98 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+#include "../src/listener.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define TEST_LISTENER_PATH "/tmp/speedy_test_listener.sock"
+
+static int priv_test_fd;
+
+static void test_listener_init(void)
+{
+    priv_test_fd = LISTENER_FAIL;
+}
+
+static void test_listener_cleanup(void)
+{
+    if (priv_test_fd != LISTENER_FAIL) {
+        close(priv_test_fd);
+    }
+    unlink(TEST_LISTENER_PATH);
+}
+
+static void test_listener_unix(void)
+{
+    struct sockaddr_un address;
+    int fd;
+
+    /* A stale socket file should be replaced. */
+    close(listener_open("unix:" TEST_LISTENER_PATH));
+    priv_test_fd = listener_open("unix:" TEST_LISTENER_PATH);
+    TEST_ASSERT_TRUE(priv_test_fd >= 0);
+
+    /* It should be possible to connect before anyone accepts. */
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, TEST_LISTENER_PATH);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr*) &address,
+                                 sizeof(address)));
+    close(fd);
+}
+
+static void test_listener_tcp(void)
+{
+    priv_test_fd = listener_open("tcp:127.0.0.1:0");
+    TEST_ASSERT_TRUE(priv_test_fd >= 0);
+}
+
+static void test_listener_invalid(void)
+{
+    TEST_ASSERT_EQUAL(LISTENER_FAIL, listener_open("udp:127.0.0.1:80"));
+    TEST_ASSERT_EQUAL(LISTENER_FAIL, listener_open("tcp:127.0.0.1"));
+    TEST_ASSERT_EQUAL(LISTENER_FAIL,
+                      listener_open("unix:/missing/directory/x.sock"));
+}
+
+void test_listener(void)
+{
+    TEST_CASE_START();
+
+    /* Test that a Unix domain socket is listening. */
+    TEST_CASE_RUN(test_listener_init,
+                  test_listener_cleanup,
+                  test_listener_unix);
+
+    /* Test that a TCP socket is listening. */
+    TEST_CASE_RUN(test_listener_init,
+                  test_listener_cleanup,
+                  test_listener_tcp);
+
+    /* Test that invalid addresses are rejected. */
+    TEST_CASE_RUN(test_listener_init,
+                  test_listener_cleanup,
+                  test_listener_invalid);
+
+    TEST_CASE_END();
+}
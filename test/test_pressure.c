@@ -0,0 +1,165 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+#include "../src/pressure.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+static pressure_t *priv_test_pressure;
+static double priv_test_cpu_pressure;
+
+/* A synthetic pressure source which only reports CPU pressure. */
+static int test_pressure_synthetic_read(pressure_t *this_ptr,
+                                        pressure_sample_t *sample)
+{
+    (void) this_ptr;
+
+    sample->pressure[PRESSURE_CPU] = priv_test_cpu_pressure;
+    sample->pressure[PRESSURE_IO] = 0.0;
+    sample->pressure[PRESSURE_MEMORY] = 0.0;
+    return PRESSURE_SUCCESS;
+}
+
+static void test_pressure_init(void)
+{
+    priv_test_pressure = pressure_create();
+    priv_test_pressure->pressure_path = TEST_CASE_PATH "pressure";
+    priv_test_pressure->loadavg_path = TEST_CASE_PATH "pressure_loadavg.txt";
+    priv_test_pressure->meminfo_path = TEST_CASE_PATH "pressure_meminfo.txt";
+    priv_test_pressure->cpus = 2u;
+    priv_test_pressure->interval = 0;
+}
+
+static void test_pressure_cleanup(void)
+{
+    pressure_destroy(priv_test_pressure);
+}
+
+static void test_pressure_read_psi(void)
+{
+    pressure_sample_t sample;
+
+    TEST_ASSERT_EQUAL(PRESSURE_SUCCESS,
+                      pressure_read(priv_test_pressure, &sample));
+    TEST_ASSERT_TRUE(sample.pressure[PRESSURE_CPU] == 12.5);
+    TEST_ASSERT_TRUE(sample.pressure[PRESSURE_IO] == 3.0);
+    TEST_ASSERT_TRUE(sample.pressure[PRESSURE_MEMORY] == 0.5);
+}
+
+static void test_pressure_read_fallback(void)
+{
+    pressure_sample_t sample;
+
+    priv_test_pressure->pressure_path = TEST_CASE_PATH "missing";
+
+    TEST_ASSERT_EQUAL(PRESSURE_SUCCESS,
+                      pressure_read(priv_test_pressure, &sample));
+    /* A load of 6 on 2 CPUs means that 4 of 6 runnable tasks are waiting. */
+    TEST_ASSERT_TRUE((sample.pressure[PRESSURE_CPU] > 66.6) &&
+                     (sample.pressure[PRESSURE_CPU] < 66.7));
+    TEST_ASSERT_TRUE(sample.pressure[PRESSURE_IO] == 0.0);
+    TEST_ASSERT_TRUE(sample.pressure[PRESSURE_MEMORY] == 75.0);
+}
+
+static void test_pressure_thresholds(void)
+{
+    TEST_ASSERT_EQUAL(PRESSURE_SUCCESS,
+                      pressure_set_threshold(priv_test_pressure, "memory",
+                                             20.0));
+    TEST_ASSERT_EQUAL(PRESSURE_FAIL,
+                      pressure_set_threshold(priv_test_pressure, "disk",
+                                             20.0));
+
+    /* The PSI test case is below all thresholds. */
+    TEST_ASSERT_EQUAL(PRESSURE_NO_LIMIT,
+                      pressure_get_limit(priv_test_pressure, 8u));
+
+    /* The fallback memory pressure is above the threshold. */
+    priv_test_pressure->pressure_path = TEST_CASE_PATH "missing";
+    TEST_ASSERT_EQUAL(4u, pressure_get_limit(priv_test_pressure, 8u));
+}
+
+static void test_pressure_limit(void)
+{
+    unsigned int limit;
+    int i;
+
+    priv_test_pressure->read = test_pressure_synthetic_read;
+    pressure_set_threshold(priv_test_pressure, "cpu", 50.0);
+
+    /* The limit is halved while the pressure is above the threshold but it
+     * never goes below one task. */
+    priv_test_cpu_pressure = 80.0;
+    TEST_ASSERT_EQUAL(4u, pressure_get_limit(priv_test_pressure, 8u));
+    TEST_ASSERT_EQUAL(2u, pressure_get_limit(priv_test_pressure, 4u));
+    TEST_ASSERT_EQUAL(1u, pressure_get_limit(priv_test_pressure, 2u));
+    TEST_ASSERT_EQUAL(1u, pressure_get_limit(priv_test_pressure, 1u));
+
+    /* The limit grows again when the pressure goes down and is finally
+     * removed. */
+    priv_test_cpu_pressure = 10.0;
+    TEST_ASSERT_EQUAL(2u, pressure_get_limit(priv_test_pressure, 1u));
+    for (i = 0; i < 16; i++) {
+        limit = pressure_get_limit(priv_test_pressure, 1u);
+    }
+    TEST_ASSERT_EQUAL(PRESSURE_NO_LIMIT, limit);
+}
+
+static void test_pressure_interval(void)
+{
+    priv_test_pressure->read = test_pressure_synthetic_read;
+    priv_test_pressure->interval = 10000;
+    pressure_set_threshold(priv_test_pressure, "cpu", 50.0);
+
+    /* Only the first call reads a sample within the interval. */
+    priv_test_cpu_pressure = 80.0;
+    TEST_ASSERT_EQUAL(4u, pressure_get_limit(priv_test_pressure, 8u));
+    TEST_ASSERT_EQUAL(4u, pressure_get_limit(priv_test_pressure, 4u));
+}
+
+void test_pressure(void)
+{
+    TEST_CASE_START();
+
+    /* Test that the pressure is read from PSI. */
+    TEST_CASE_RUN(test_pressure_init,
+                  test_pressure_cleanup,
+                  test_pressure_read_psi);
+
+    /* Test that the pressure is estimated without PSI. */
+    TEST_CASE_RUN(test_pressure_init,
+                  test_pressure_cleanup,
+                  test_pressure_read_fallback);
+
+    /* Test that the thresholds are compared with the right resources. */
+    TEST_CASE_RUN(test_pressure_init,
+                  test_pressure_cleanup,
+                  test_pressure_thresholds);
+
+    /* Test how the limit follows the pressure. */
+    TEST_CASE_RUN(test_pressure_init,
+                  test_pressure_cleanup,
+                  test_pressure_limit);
+
+    /* Test that samples aren't read more often than the interval. */
+    TEST_CASE_RUN(test_pressure_init,
+                  test_pressure_cleanup,
+                  test_pressure_interval);
+
+    TEST_CASE_END();
+}
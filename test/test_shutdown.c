@@ -0,0 +1,181 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "test_handler.h"
+#include "../src/shutdown.h"
+#include "../src/task_graph.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define TEST_SHUTDOWN_NODES 4u
+
+static task_graph_t *priv_test_graph;
+static shutdown_t *priv_test_shutdown;
+static pid_t priv_test_pids[TEST_SHUTDOWN_NODES];
+static unsigned int priv_test_order[TEST_SHUTDOWN_NODES];
+static shutdown_result_t priv_test_results[TEST_SHUTDOWN_NODES];
+static unsigned int priv_test_stopped;
+
+/* Starts a process which sleeps until it is signaled. SIGTERM is ignored
+   around the fork so that the child ignores it from the start. The process
+   leads a new process group unless a group is given, like a service. */
+static pid_t test_shutdown_spawn(bool ignore_term, pid_t group)
+{
+    void (*saved)(int) = signal(SIGTERM, ignore_term ? SIG_IGN : SIG_DFL);
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        setpgid(0, group);
+        execlp("sleep", "sleep", "10", (char*) NULL);
+        _exit(127);
+    }
+    if (pid > 0) {
+        setpgid(pid, (group > 0) ? group : pid);
+    }
+    signal(SIGTERM, saved);
+    return pid;
+}
+
+static void test_shutdown_stopped(void *context, unsigned int node,
+                                  shutdown_result_t result)
+{
+    (void) context;
+    priv_test_order[priv_test_stopped] = node;
+    priv_test_results[node] = result;
+    priv_test_stopped++;
+}
+
+static void test_shutdown_init(void)
+{
+    unsigned int i;
+
+    /* 0 requires 1 which wants 2, 3 is independent. */
+    priv_test_graph = task_graph_create(TEST_SHUTDOWN_NODES);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 1u, 2u, false);
+    priv_test_shutdown = shutdown_create(priv_test_graph);
+    shutdown_set_callback(priv_test_shutdown, test_shutdown_stopped, NULL);
+    priv_test_stopped = 0u;
+
+    for (i = 0u; i < TEST_SHUTDOWN_NODES; i++) {
+        priv_test_pids[i] = 0;
+    }
+}
+
+static void test_shutdown_cleanup(void)
+{
+    unsigned int i;
+
+    for (i = 0u; i < TEST_SHUTDOWN_NODES; i++) {
+        if (priv_test_pids[i] > 0) {
+            kill(-priv_test_pids[i], SIGKILL);
+            while (waitpid(-priv_test_pids[i], NULL, 0) > 0) {
+            }
+        }
+    }
+    shutdown_destroy(priv_test_shutdown);
+    task_graph_destroy(priv_test_graph);
+}
+
+static void test_shutdown_order(void)
+{
+    unsigned int i;
+
+    TEST_ASSERT_NOT_NULL(priv_test_shutdown);
+
+    for (i = 0u; i < 3u; i++) {
+        priv_test_pids[i] = test_shutdown_spawn(false, 0);
+        TEST_ASSERT_TRUE(priv_test_pids[i] > 0);
+        shutdown_set_process(priv_test_shutdown, i, priv_test_pids[i], 5000u);
+    }
+
+    TEST_ASSERT_EQUAL(SHUTDOWN_SUCCESS, shutdown_run(priv_test_shutdown));
+    TEST_ASSERT_EQUAL(TEST_SHUTDOWN_NODES, priv_test_stopped);
+
+    /* The independent service isn't running, so it is down at once. */
+    TEST_ASSERT_EQUAL(SHUTDOWN_NOT_RUNNING, priv_test_results[3]);
+
+    /* A service isn't stopped before the services that depend on it. */
+    for (i = 0u; i < 3u; i++) {
+        TEST_ASSERT_EQUAL(SHUTDOWN_STOPPED, priv_test_results[i]);
+    }
+    TEST_ASSERT_EQUAL(0u, priv_test_order[1]);
+    TEST_ASSERT_EQUAL(1u, priv_test_order[2]);
+    TEST_ASSERT_EQUAL(2u, priv_test_order[3]);
+}
+
+static void test_shutdown_timeout(void)
+{
+    TEST_ASSERT_NOT_NULL(priv_test_shutdown);
+
+    /* The dependent ignores SIGTERM, its dependency has to wait until it has
+       been killed. */
+    priv_test_pids[0] = test_shutdown_spawn(true, 0);
+    priv_test_pids[1] = test_shutdown_spawn(false, 0);
+    TEST_ASSERT_TRUE((priv_test_pids[0] > 0) && (priv_test_pids[1] > 0));
+    shutdown_set_process(priv_test_shutdown, 0u, priv_test_pids[0], 50u);
+    shutdown_set_process(priv_test_shutdown, 1u, priv_test_pids[1], 5000u);
+
+    TEST_ASSERT_EQUAL(SHUTDOWN_SUCCESS, shutdown_run(priv_test_shutdown));
+    TEST_ASSERT_EQUAL(SHUTDOWN_KILLED, priv_test_results[0]);
+    TEST_ASSERT_EQUAL(SHUTDOWN_STOPPED, priv_test_results[1]);
+    TEST_ASSERT_EQUAL(SHUTDOWN_NOT_RUNNING, priv_test_results[2]);
+    TEST_ASSERT_EQUAL(0u, priv_test_order[1]);
+    TEST_ASSERT_EQUAL(1u, priv_test_order[2]);
+}
+
+static void test_shutdown_group(void)
+{
+    pid_t member;
+
+    TEST_ASSERT_NOT_NULL(priv_test_shutdown);
+
+    /* The leader exits on SIGTERM but another process in its group ignores
+       it, the service isn't down until that one has been killed too. */
+    priv_test_pids[2] = test_shutdown_spawn(false, 0);
+    TEST_ASSERT_TRUE(priv_test_pids[2] > 0);
+    member = test_shutdown_spawn(true, priv_test_pids[2]);
+    TEST_ASSERT_TRUE(member > 0);
+    shutdown_set_process(priv_test_shutdown, 2u, priv_test_pids[2], 50u);
+
+    TEST_ASSERT_EQUAL(SHUTDOWN_SUCCESS, shutdown_run(priv_test_shutdown));
+    TEST_ASSERT_EQUAL(SHUTDOWN_KILLED, priv_test_results[2]);
+    TEST_ASSERT_EQUAL(-1, kill(member, 0));
+}
+
+void test_shutdown(void)
+{
+    TEST_CASE_START();
+
+    /* Test that the services are stopped in reverse dependency order. */
+    TEST_CASE_RUN(test_shutdown_init,
+                  test_shutdown_cleanup,
+                  test_shutdown_order);
+
+    /* Test that a service is killed when it doesn't exit in time. */
+    TEST_CASE_RUN(test_shutdown_init,
+                  test_shutdown_cleanup,
+                  test_shutdown_timeout);
+
+    /* Test that a service is down only when its process group is empty. */
+    TEST_CASE_RUN(test_shutdown_init,
+                  test_shutdown_cleanup,
+                  test_shutdown_group);
+
+    TEST_CASE_END();
+}
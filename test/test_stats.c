@@ -0,0 +1,140 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "test_handler.h"
+#include "../src/stats.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_STATS_PATH "/tmp/speedy_test_stats.json"
+
+/* Reads the written statistics, the caller frees it. */
+static char *test_stats_read(void)
+{
+    FILE *file = fopen(TEST_STATS_PATH, "r");
+    char *content = calloc(8192, 1);
+
+    if ((file != NULL) && (content != NULL)) {
+        TEST_ASSERT_TRUE(fread(content, 1, 8191, file) > 0u);
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    return content;
+}
+
+static void test_stats_init(void)
+{
+    unlink(TEST_STATS_PATH);
+}
+
+static void test_stats_cleanup(void)
+{
+    stats_finish();
+    unlink(TEST_STATS_PATH);
+}
+
+static void test_stats_histograms(void)
+{
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    unsigned long locked;
+    char *content;
+
+    /* Nothing is collected until the statistics are enabled. */
+    stats_sample(STATS_READY_TO_DISPATCH, 5u);
+    TEST_ASSERT_FALSE(stats_is_enabled());
+    TEST_ASSERT_EQUAL(0u, stats_now());
+
+    TEST_ASSERT_EQUAL(STATS_SUCCESS, stats_enable(TEST_STATS_PATH));
+    TEST_ASSERT_TRUE(stats_is_enabled());
+    TEST_ASSERT_EQUAL(STATS_FAIL, stats_enable(TEST_STATS_PATH));
+
+    stats_sample(STATS_READY_TO_DISPATCH, 0u);
+    stats_sample(STATS_READY_TO_DISPATCH, 2u);
+    stats_sample(STATS_READY_TO_DISPATCH, 3u);
+    stats_sample(STATS_READY_TO_DISPATCH, 1000u);
+    stats_add(STATS_WAKEUPS, 3u);
+    stats_add(STATS_USEFUL_WAKEUPS, 2u);
+    stats_sample_depth(4u);
+    stats_sample_depth(7u);
+
+    locked = stats_lock(STATS_LOCK_OBSERVER, &mutex);
+    stats_unlock(STATS_LOCK_OBSERVER, &mutex, locked);
+
+    TEST_ASSERT_EQUAL(STATS_SUCCESS, stats_write(TEST_STATS_PATH));
+    content = test_stats_read();
+    TEST_ASSERT_NOT_NULL(content);
+
+    /* The buckets are written with their upper bounds, and the last point
+       of the series is the latest depth. */
+    TEST_ASSERT_NOT_NULL(strstr(content, "\"wakeups\": 3"));
+    TEST_ASSERT_NOT_NULL(strstr(content, "\"useful_wakeups\": 2"));
+    TEST_ASSERT_NOT_NULL(strstr(content,
+        "\"ready_to_dispatch_us\": {\"count\": 4, \"sum\": 1005, "
+        "\"max\": 1000, \"buckets\": [[0, 1], [3, 2], [1023, 1]]}"));
+    TEST_ASSERT_NOT_NULL(strstr(content,
+        "\"queue_depth\": {\"count\": 2, \"sum\": 11, \"max\": 7"));
+    TEST_ASSERT_NOT_NULL(strstr(content,
+        "\"observer_mutex_wait_us\": {\"count\": 1,"));
+    TEST_ASSERT_NOT_NULL(strstr(content,
+        "\"observer_mutex_hold_us\": {\"count\": 1,"));
+    TEST_ASSERT_NOT_NULL(strstr(content,
+        "\"task_parser_mutex_wait_us\": {\"count\": 0,"));
+    TEST_ASSERT_NOT_NULL(strstr(content, ", 7]]"));
+    free(content);
+}
+
+static void test_stats_signal(void)
+{
+    struct timespec delay = {0, 10000000L};
+    unsigned int i;
+
+    /* The statistics are written by the writer thread on SIGUSR1, and a
+       last time when they are finished. */
+    TEST_ASSERT_EQUAL(STATS_SUCCESS, stats_enable(TEST_STATS_PATH));
+    TEST_ASSERT_EQUAL(0, raise(SIGUSR1));
+    for (i = 0u; (i < 100u) && (access(TEST_STATS_PATH, R_OK) != 0); i++) {
+        nanosleep(&delay, NULL);
+    }
+    TEST_ASSERT_EQUAL(0, access(TEST_STATS_PATH, R_OK));
+
+    unlink(TEST_STATS_PATH);
+    stats_finish();
+    TEST_ASSERT_FALSE(stats_is_enabled());
+    TEST_ASSERT_EQUAL(0, access(TEST_STATS_PATH, R_OK));
+}
+
+void test_stats(void)
+{
+    TEST_CASE_START();
+
+    /* Test that the samples are written to the histograms. */
+    TEST_CASE_RUN(test_stats_init,
+                  test_stats_cleanup,
+                  test_stats_histograms);
+
+    /* Test that the statistics are written on SIGUSR1 and at exit. */
+    TEST_CASE_RUN(test_stats_init,
+                  test_stats_cleanup,
+                  test_stats_signal);
+
+    TEST_CASE_END();
+}
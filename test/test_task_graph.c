@@ -0,0 +1,268 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+#include "../src/task_graph.h"
+
+#include <stdlib.h>
+
+static task_graph_t *priv_test_graph;
+
+static void test_task_graph_init(void)
+{
+    priv_test_graph = task_graph_create(4u);
+}
+
+static void test_task_graph_cleanup(void)
+{
+    task_graph_destroy(priv_test_graph);
+}
+
+static void test_task_graph_reduce(void)
+{
+    unsigned int removed;
+
+    /* The first node requires the others, the last node requires the
+     * second and the third node as well. */
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 0u, 2u, true);
+    task_graph_add_edge(priv_test_graph, 0u, 3u, true);
+    task_graph_add_edge(priv_test_graph, 3u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 3u, 2u, true);
+
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_reduce(priv_test_graph, &removed));
+    TEST_ASSERT_EQUAL(2u, removed);
+    TEST_ASSERT_TRUE(task_graph_is_removed(priv_test_graph, 0u));
+    TEST_ASSERT_TRUE(task_graph_is_removed(priv_test_graph, 1u));
+    TEST_ASSERT_FALSE(task_graph_is_removed(priv_test_graph, 2u));
+    TEST_ASSERT_FALSE(task_graph_is_removed(priv_test_graph, 3u));
+    TEST_ASSERT_FALSE(task_graph_is_removed(priv_test_graph, 4u));
+}
+
+static void test_task_graph_strength(void)
+{
+    unsigned int removed;
+
+    /* A path with a weak edge doesn't imply the edge from the first node to
+     * the last node, a path with strong edges only implies the weak edge
+     * from the second node to the last node. */
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, false);
+    task_graph_add_edge(priv_test_graph, 1u, 3u, true);
+    task_graph_add_edge(priv_test_graph, 0u, 3u, true);
+    task_graph_add_edge(priv_test_graph, 1u, 2u, true);
+    task_graph_add_edge(priv_test_graph, 2u, 3u, true);
+
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_reduce(priv_test_graph, &removed));
+    TEST_ASSERT_EQUAL(1u, removed);
+    TEST_ASSERT_TRUE(task_graph_is_removed(priv_test_graph, 1u));
+    TEST_ASSERT_FALSE(task_graph_is_removed(priv_test_graph, 2u));
+}
+
+static void test_task_graph_duplicate(void)
+{
+    unsigned int removed;
+
+    /* The strong duplicate should be kept. */
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, false);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, false);
+
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_reduce(priv_test_graph, &removed));
+    TEST_ASSERT_EQUAL(2u, removed);
+    TEST_ASSERT_TRUE(task_graph_is_removed(priv_test_graph, 0u));
+    TEST_ASSERT_FALSE(task_graph_is_removed(priv_test_graph, 1u));
+    TEST_ASSERT_TRUE(task_graph_is_removed(priv_test_graph, 2u));
+}
+
+static void test_task_graph_cycle(void)
+{
+    unsigned int removed;
+
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 1u, 2u, true);
+    task_graph_add_edge(priv_test_graph, 2u, 0u, true);
+    task_graph_add_edge(priv_test_graph, 3u, 0u, true);
+    task_graph_add_edge(priv_test_graph, 3u, 0u, true);
+    TEST_ASSERT_EQUAL(TASK_GRAPH_FAIL,
+                      task_graph_add_edge(priv_test_graph, 4u, 0u, true));
+
+    /* Nothing should be removed from a graph with a cycle. */
+    TEST_ASSERT_EQUAL(TASK_GRAPH_FAIL,
+                      task_graph_reduce(priv_test_graph, &removed));
+    TEST_ASSERT_EQUAL(0u, removed);
+    TEST_ASSERT_FALSE(task_graph_is_removed(priv_test_graph, 4u));
+}
+
+static void test_task_graph_components(void)
+{
+    unsigned int component[4];
+    unsigned int cycle[4];
+    unsigned int size;
+
+    /* The second and the third node depend on each other and the last node
+     * depends on itself. */
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 1u, 2u, true);
+    task_graph_add_edge(priv_test_graph, 2u, 1u, false);
+    task_graph_add_edge(priv_test_graph, 3u, 3u, true);
+
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_components(priv_test_graph, component,
+                                            &size));
+    TEST_ASSERT_EQUAL(3u, size);
+    TEST_ASSERT_EQUAL(component[1], component[2]);
+    TEST_ASSERT_TRUE(component[1] < component[0]);
+    TEST_ASSERT_TRUE(component[3] != component[0]);
+    TEST_ASSERT_TRUE(component[3] != component[1]);
+
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_find_cycles(priv_test_graph, component,
+                                             cycle));
+    TEST_ASSERT_EQUAL(TASK_GRAPH_NONE, cycle[0]);
+    TEST_ASSERT_EQUAL(1u, cycle[1]);
+    TEST_ASSERT_EQUAL(2u, cycle[2]);
+    TEST_ASSERT_EQUAL(3u, cycle[3]);
+
+    /* The cycle is gone when one of its edges is removed. */
+    task_graph_remove_edge(priv_test_graph, 2u);
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_components(priv_test_graph, component,
+                                            &size));
+    TEST_ASSERT_EQUAL(4u, size);
+}
+
+static void test_task_graph_closure(void)
+{
+    task_graph_closure_t *closure;
+    unsigned int nodes[4];
+
+    /* The first node depends on the second and the fourth node, which both
+     * depend on the third node. */
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 1u, 2u, true);
+    task_graph_add_edge(priv_test_graph, 3u, 2u, false);
+    task_graph_add_edge(priv_test_graph, 0u, 3u, true);
+
+    closure = task_graph_closure_create(priv_test_graph);
+    TEST_ASSERT_NOT_NULL(closure);
+
+    TEST_ASSERT_EQUAL(3u, task_graph_closure_dependencies(closure, 0u,
+                                                          nodes));
+    TEST_ASSERT_EQUAL(1u, nodes[0]);
+    TEST_ASSERT_EQUAL(2u, nodes[1]);
+    TEST_ASSERT_EQUAL(3u, nodes[2]);
+    TEST_ASSERT_EQUAL(0u, task_graph_closure_dependencies(closure, 2u,
+                                                          nodes));
+
+    TEST_ASSERT_EQUAL(3u, task_graph_closure_dependents(closure, 2u, nodes));
+    TEST_ASSERT_EQUAL(0u, nodes[0]);
+    TEST_ASSERT_EQUAL(1u, nodes[1]);
+    TEST_ASSERT_EQUAL(3u, nodes[2]);
+
+    TEST_ASSERT_TRUE(task_graph_closure_depends(closure, 0u, 2u));
+    TEST_ASSERT_FALSE(task_graph_closure_depends(closure, 2u, 0u));
+    TEST_ASSERT_FALSE(task_graph_closure_depends(closure, 3u, 1u));
+    task_graph_closure_destroy(closure);
+
+    /* There isn't any closure of a graph with a cycle. */
+    task_graph_add_edge(priv_test_graph, 2u, 0u, true);
+    TEST_ASSERT_NULL(task_graph_closure_create(priv_test_graph));
+}
+
+static void test_task_graph_longest_paths(void)
+{
+    unsigned long cost[4] = {10u, 1u, 5u, 100u};
+    unsigned long length[4];
+
+    /* The first node depends on the second and the fourth node, which both
+     * depend on the third node. The edge from the fourth node is removed. */
+    TEST_ASSERT_NOT_NULL(priv_test_graph);
+    task_graph_add_edge(priv_test_graph, 0u, 1u, true);
+    task_graph_add_edge(priv_test_graph, 1u, 2u, true);
+    task_graph_add_edge(priv_test_graph, 3u, 2u, false);
+    task_graph_add_edge(priv_test_graph, 0u, 3u, true);
+
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_longest_paths(priv_test_graph, cost,
+                                               length));
+    TEST_ASSERT_EQUAL(10u, length[0]);
+    TEST_ASSERT_EQUAL(11u, length[1]);
+    TEST_ASSERT_EQUAL(110u, length[3]);
+    TEST_ASSERT_EQUAL(115u, length[2]);
+
+    task_graph_remove_edge(priv_test_graph, 2u);
+    TEST_ASSERT_EQUAL(TASK_GRAPH_SUCCESS,
+                      task_graph_longest_paths(priv_test_graph, cost,
+                                               length));
+    TEST_ASSERT_EQUAL(16u, length[2]);
+
+    /* There aren't any paths in a graph with a cycle. */
+    task_graph_add_edge(priv_test_graph, 2u, 0u, true);
+    TEST_ASSERT_EQUAL(TASK_GRAPH_FAIL,
+                      task_graph_longest_paths(priv_test_graph, cost,
+                                               length));
+}
+
+void test_task_graph(void)
+{
+    TEST_CASE_START();
+
+    /* Test that the implied edges are removed. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_reduce);
+
+    /* Test that only strong paths imply edges. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_strength);
+
+    /* Test that duplicate edges are removed. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_duplicate);
+
+    /* Test that a graph with a cycle isn't reduced. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_cycle);
+
+    /* Test that the cycles are found. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_components);
+
+    /* Test the transitive closure. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_closure);
+
+    /* Test the longest paths through the dependents. */
+    TEST_CASE_RUN(test_task_graph_init,
+                  test_task_graph_cleanup,
+                  test_task_graph_longest_paths);
+
+    TEST_CASE_END();
+}
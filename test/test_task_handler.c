@@ -0,0 +1,968 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#define _GNU_SOURCE
+
+#include "test_handler.h"
+#include "../src/analysis.h"
+#include "../src/core_type.h"
+#include "../src/hash.h"
+#include "../src/hash_lookup.h"
+#include "../src/observer.h"
+#include "../src/queue.h"
+#include "../src/simulator.h"
+#include "../src/subject.h"
+#include "../src/timer_wheel.h"
+#include "../src/process.h"
+#include "../src/task.h"
+#include "../src/task_graph.h"
+#include "../src/task_handler.h"
+#include "../src/thread_pool.h"
+#include "../src/timing_db.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#define TEST_TASK_HANDLER_SERVICES 6
+#define TEST_TASK_HANDLER_TIMING_DB "/tmp/speedy_test_handler_timing.db"
+
+static thread_pool_t *priv_test_thread_pool;
+static task_handler_t *priv_test_handler;
+static service_t priv_test_services[TEST_TASK_HANDLER_SERVICES];
+static char priv_test_names[TEST_TASK_HANDLER_SERVICES][8];
+static pthread_mutex_t priv_test_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int priv_test_executed;
+static int priv_test_running;
+static int priv_test_max_running;
+static int priv_test_first_executed;
+static pid_t priv_test_class_tid;
+static int priv_test_class_policy;
+static int priv_test_class_nice;
+
+/* An action which keeps track of how many actions are running at the same
+ * time. */
+static int test_task_handler_action(void)
+{
+    struct timespec delay = {0, 20000000L};
+
+    pthread_mutex_lock(&priv_test_mutex);
+    priv_test_running++;
+    if (priv_test_running > priv_test_max_running) {
+        priv_test_max_running = priv_test_running;
+    }
+    pthread_mutex_unlock(&priv_test_mutex);
+
+    nanosleep(&delay, NULL);
+
+    pthread_mutex_lock(&priv_test_mutex);
+    priv_test_running--;
+    priv_test_executed++;
+    pthread_mutex_unlock(&priv_test_mutex);
+    return 0;
+}
+
+/* An action which fails. */
+static int test_task_handler_fail_action(void)
+{
+    test_task_handler_action();
+    return -1;
+}
+
+/* An action which records how many actions had finished when it started. */
+static int test_task_handler_first_action(void)
+{
+    pthread_mutex_lock(&priv_test_mutex);
+    priv_test_first_executed = priv_test_executed;
+    pthread_mutex_unlock(&priv_test_mutex);
+    return test_task_handler_action();
+}
+
+/* An action which records the worker thread and its scheduling class. */
+static int test_task_handler_class_action(void)
+{
+    priv_test_class_tid = (pid_t) syscall(SYS_gettid);
+    priv_test_class_policy = sched_getscheduler(priv_test_class_tid);
+    priv_test_class_nice = getpriority(PRIO_PROCESS, priv_test_class_tid);
+    return test_task_handler_action();
+}
+
+static task_t *test_task_handler_find(int index)
+{
+    return hash_lookup_find(priv_test_handler->task_lookup,
+                            hash_generate(priv_test_names[index]));
+}
+
+static void test_task_handler_init(void)
+{
+    service_t *service;
+    int i;
+
+    priv_test_executed = 0;
+    priv_test_running = 0;
+    priv_test_max_running = 0;
+    priv_test_first_executed = -1;
+
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        service = &priv_test_services[i];
+        sprintf(priv_test_names[i], "test%d", i);
+
+        service_init(service);
+        service->name = priv_test_names[i];
+        service->action = test_task_handler_action;
+    }
+
+    priv_test_thread_pool = thread_pool_create(4);
+    priv_test_handler = task_handler_create(priv_test_thread_pool);
+}
+
+static void test_task_handler_cleanup(void)
+{
+    task_handler_destroy(priv_test_handler);
+    thread_pool_destroy(priv_test_thread_pool);
+}
+
+/* Runs all the services and checks how many actions that were executed. */
+static void test_task_handler_run_size(int executed)
+{
+    task_handler_add_tasks(priv_test_handler, priv_test_services,
+                           TEST_TASK_HANDLER_SERVICES);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+
+    TEST_ASSERT_EQUAL(executed, priv_test_executed);
+    TEST_ASSERT_EQUAL(0, priv_test_running);
+}
+
+static void test_task_handler_run(void)
+{
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES);
+}
+
+static void test_task_handler_group_limit(void)
+{
+    int i;
+
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].group = "disk";
+    }
+    TEST_ASSERT_EQUAL(TASK_HANDLER_FAIL,
+                      task_handler_set_group_limit(priv_test_handler,
+                                                   "disk", 0u));
+    TEST_ASSERT_EQUAL(TASK_HANDLER_SUCCESS,
+                      task_handler_set_group_limit(priv_test_handler,
+                                                   "disk", 1u));
+    test_task_handler_run();
+
+    TEST_ASSERT_EQUAL(1, priv_test_max_running);
+}
+
+static void test_task_handler_io_budget(void)
+{
+    int i;
+
+    /* Two tasks fit within the budget at the same time and the last task
+     * needs more than the whole budget, it should still be executed. */
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].io = 2u;
+    }
+    priv_test_services[TEST_TASK_HANDLER_SERVICES - 1].io = 10u;
+    task_handler_set_io_budget(priv_test_handler, 4u);
+    test_task_handler_run();
+
+    TEST_ASSERT_TRUE(priv_test_max_running <= 2);
+    TEST_ASSERT_EQUAL(0u, priv_test_handler->io_used);
+}
+
+static void test_task_handler_mem_budget(void)
+{
+    int i;
+
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].mem = 512u * 1024u;
+    }
+    task_handler_set_mem_budget(priv_test_handler, 1024u * 1024u);
+    test_task_handler_run();
+
+    TEST_ASSERT_TRUE(priv_test_max_running <= 2);
+    TEST_ASSERT_EQUAL(0u, priv_test_handler->mem_used);
+}
+
+static void test_task_handler_notify(void)
+{
+    char *dependency[] = {priv_test_names[0], NULL};
+    task_t *task;
+
+    /* The first service keeps running after it is ready and the second
+     * service depends on it. */
+    priv_test_services[0].action = NULL;
+    priv_test_services[0].exec = "echo READY=1 >&$NOTIFY_FD; sleep 0.3";
+    priv_test_services[0].type = SERVICE_TYPE_NOTIFY;
+    priv_test_services[1].dependency = dependency;
+
+    task_handler_add_tasks(priv_test_handler, priv_test_services, 2u);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+
+    task = test_task_handler_find(0);
+    TEST_ASSERT_EQUAL(1, priv_test_executed);
+    TEST_ASSERT_EQUAL(TASK_STATE_READY, task_get_state(task));
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, task->status);
+
+    task_handler_supervise(priv_test_handler);
+    TEST_ASSERT_EQUAL(TASK_STATE_EXITED, task_get_state(task));
+}
+
+static void test_task_handler_environment(void)
+{
+    task_t *task;
+
+    /* The command gets the variables of its own sockets and readiness
+     * pipe, never the ones that Speedy itself was started with. */
+    setenv("LISTEN_FDS", "9", 1);
+    priv_test_services[0].action = NULL;
+    priv_test_services[0].exec = "test -z \"$LISTEN_FDS$LISTEN_PID\" && "
+                                 "test -n \"$HOME$PATH\"";
+
+    task_handler_add_tasks(priv_test_handler, priv_test_services, 1u);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+    unsetenv("LISTEN_FDS");
+
+    task = test_task_handler_find(0);
+    TEST_ASSERT_EQUAL(TASK_STATE_EXITED, task_get_state(task));
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, task->status);
+}
+
+static void test_task_handler_dependency_kinds(void)
+{
+    char *failed[] = {priv_test_names[0], NULL};
+    char *missing[] = {"missing", NULL};
+
+    priv_test_services[0].action = test_task_handler_fail_action;
+    priv_test_services[1].dependency = failed;
+    priv_test_services[2].wants = failed;
+    priv_test_services[3].after = failed;
+    priv_test_services[4].dependency = missing;
+    priv_test_services[5].wants = missing;
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES - 2);
+
+    /* Only the tasks which require a failed or missing task are skipped. */
+    TEST_ASSERT_EQUAL(TASK_FAIL, test_task_handler_find(0)->status);
+    TEST_ASSERT_EQUAL(TASK_FAIL, test_task_handler_find(1)->status);
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(2)->status);
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(3)->status);
+    TEST_ASSERT_EQUAL(TASK_FAIL, test_task_handler_find(4)->status);
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(5)->status);
+}
+
+static void test_task_handler_skip(void)
+{
+    char *failed[] = {priv_test_names[0], NULL};
+    char *skipped[] = {priv_test_names[1], NULL};
+    char *slow[] = {priv_test_names[2], NULL};
+    char *missing[] = {"missing", NULL};
+    task_t *task;
+
+    /* The second task requires the failed task and wants a slow task, it
+     * should be skipped at once instead of waiting for the slow task. The
+     * fourth task requires the skipped task. */
+    priv_test_services[0].action = test_task_handler_fail_action;
+    priv_test_services[1].dependency = failed;
+    priv_test_services[1].wants = slow;
+    priv_test_services[3].dependency = skipped;
+    priv_test_services[4].dependency = missing;
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES - 3);
+
+    task = test_task_handler_find(1);
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED, task_get_state(task));
+    TEST_ASSERT_EQUAL_STRING("required dependency test0 failed",
+                             task->skip_reason);
+
+    task = test_task_handler_find(3);
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED, task_get_state(task));
+    TEST_ASSERT_EQUAL_STRING("required dependency test1 failed",
+                             task->skip_reason);
+
+    task = test_task_handler_find(4);
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED, task_get_state(task));
+    TEST_ASSERT_EQUAL_STRING("required dependency missing is missing",
+                             task->skip_reason);
+
+    TEST_ASSERT_EQUAL(TASK_STATE_EXITED, task_get_state(
+                      test_task_handler_find(0)));
+    TEST_ASSERT_EQUAL(4u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_timeout(void)
+{
+    char *dependency[] = {priv_test_names[0], NULL};
+    task_t *task;
+
+    /* The first service runs for longer than the default timeout, the third
+     * service runs for longer as well but doesn't have any timeout. */
+    task_handler_set_timeout(priv_test_handler, 100u);
+    priv_test_services[0].action = NULL;
+    priv_test_services[0].exec = "sleep 5";
+    priv_test_services[1].dependency = dependency;
+    priv_test_services[2].action = NULL;
+    priv_test_services[2].exec = "sleep 0.3";
+    priv_test_services[2].timeout = 0;
+
+    task_handler_add_tasks(priv_test_handler, priv_test_services, 3u);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+
+    task = test_task_handler_find(0);
+    TEST_ASSERT_TRUE(task->timed_out);
+    TEST_ASSERT_EQUAL(TASK_FAIL, task->status);
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED, task_get_state(
+                      test_task_handler_find(1)));
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(2)->status);
+    TEST_ASSERT_EQUAL(0, priv_test_executed);
+}
+
+static void test_task_handler_timeout_group(void)
+{
+    task_t *task;
+
+    /* The shell forks the sleep instead of executing it, the timeout must
+     * stop the sleep as well. */
+    task_handler_set_timeout(priv_test_handler, 100u);
+    priv_test_services[0].action = NULL;
+    priv_test_services[0].exec = "sleep 30.0037; :";
+
+    task_handler_add_tasks(priv_test_handler, priv_test_services, 1u);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+
+    task = test_task_handler_find(0);
+    TEST_ASSERT_TRUE(task->timed_out);
+    TEST_ASSERT_EQUAL(0u, test_handler_count_processes("30.0037", 1000u));
+}
+
+static void test_task_handler_targets(void)
+{
+    char *requires[] = {priv_test_names[1], NULL};
+    char *wants[] = {priv_test_names[2], NULL};
+    char *after[] = {priv_test_names[3], NULL};
+
+    /* The first task requires the second task which wants the third task,
+     * the first task is only ordered after the fourth task. */
+    priv_test_services[0].dependency = requires;
+    priv_test_services[0].after = after;
+    priv_test_services[1].wants = wants;
+    TEST_ASSERT_EQUAL(TASK_HANDLER_SUCCESS,
+                      task_handler_add_target(priv_test_handler,
+                                              priv_test_names[0]));
+    TEST_ASSERT_EQUAL(TASK_HANDLER_SUCCESS,
+                      task_handler_add_target(priv_test_handler, "missing"));
+    test_task_handler_run_size(3);
+
+    /* Only the closure of the target should be kept. */
+    TEST_ASSERT_NOT_NULL(test_task_handler_find(0));
+    TEST_ASSERT_NOT_NULL(test_task_handler_find(1));
+    TEST_ASSERT_NOT_NULL(test_task_handler_find(2));
+    TEST_ASSERT_NULL(test_task_handler_find(3));
+    TEST_ASSERT_NULL(test_task_handler_find(4));
+    TEST_ASSERT_EQUAL(0u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_target(void)
+{
+    char *members[] = {priv_test_names[1], priv_test_names[2], NULL};
+    char *target[] = {priv_test_names[0], NULL};
+    task_t *task;
+
+    /* The first service is a target for the second and the third service,
+     * the fourth and the fifth service require the target. */
+    priv_test_services[0].type = SERVICE_TYPE_TARGET;
+    priv_test_services[0].dependency = members;
+    priv_test_services[3].dependency = target;
+    priv_test_services[4].dependency = target;
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES - 1);
+
+    task = test_task_handler_find(0);
+    TEST_ASSERT_EQUAL(TASK_STATE_EXITED, task_get_state(task));
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, task->status);
+    TEST_ASSERT_EQUAL(2u, task->dependents);
+    TEST_ASSERT_EQUAL(0u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_collapse(void)
+{
+    char *requires[] = {priv_test_names[0], priv_test_names[1], NULL};
+    char *reordered[] = {priv_test_names[1], priv_test_names[0], NULL};
+    int i;
+
+    /* Three services require the same two services, the first of which
+     * fails. */
+    priv_test_services[0].action = test_task_handler_fail_action;
+    priv_test_services[3].dependency = requires;
+    priv_test_services[4].dependency = reordered;
+    priv_test_services[5].dependency = requires;
+    task_handler_set_collapse(priv_test_handler, true);
+    test_task_handler_run_size(3);
+
+    /* The required services should have a single dependent target. */
+    TEST_ASSERT_EQUAL(1u, test_task_handler_find(0)->dependents);
+    TEST_ASSERT_EQUAL(1u, test_task_handler_find(1)->dependents);
+    TEST_ASSERT_EQUAL(QUEUE_SUCESS, queue_first(priv_test_handler->collapsed));
+
+    for (i = 3; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED,
+                          task_get_state(test_task_handler_find(i)));
+        TEST_ASSERT_EQUAL_STRING("required dependency test0 failed",
+                                 test_task_handler_find(i)->skip_reason);
+    }
+}
+
+static void test_task_handler_reduce(void)
+{
+    char *all[] = {priv_test_names[1], priv_test_names[2], priv_test_names[3],
+                   NULL};
+    char *base[] = {priv_test_names[1], priv_test_names[2], NULL};
+
+    /* The first task requires the three next tasks, but the fourth task
+     * already requires the second and the third task. */
+    priv_test_services[0].dependency = all;
+    priv_test_services[3].dependency = base;
+    task_handler_set_reduce(priv_test_handler, true);
+    test_task_handler_run();
+
+    TEST_ASSERT_EQUAL(1u, test_task_handler_find(1)->dependents);
+    TEST_ASSERT_EQUAL(1u, test_task_handler_find(2)->dependents);
+    TEST_ASSERT_EQUAL(1u, test_task_handler_find(3)->dependents);
+    TEST_ASSERT_EQUAL(0u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_cycle(void)
+{
+    char *first[] = {priv_test_names[1], NULL};
+    char *second[] = {priv_test_names[2], NULL};
+    char *third[] = {priv_test_names[3], NULL};
+    char *fourth[] = {priv_test_names[4], NULL};
+
+    /* The second and the third task require each other, the fourth and the
+     * fifth task are only ordered after each other. */
+    priv_test_services[0].wants = first;
+    priv_test_services[1].dependency = second;
+    priv_test_services[2].dependency = first;
+    priv_test_services[3].wants = fourth;
+    priv_test_services[4].after = third;
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES - 2);
+
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED,
+                      task_get_state(test_task_handler_find(1)));
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED,
+                      task_get_state(test_task_handler_find(2)));
+    TEST_ASSERT_EQUAL_STRING("in a dependency cycle",
+                             test_task_handler_find(1)->skip_reason);
+    TEST_ASSERT_EQUAL(2u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_query(void)
+{
+    char *first[] = {priv_test_names[1], NULL};
+    char *second[] = {priv_test_names[2], NULL};
+    task_t **tasks;
+
+    /* The first task requires the second task, which wants the third
+     * task. Nothing is started during a dry run. */
+    priv_test_services[0].dependency = first;
+    priv_test_services[1].wants = second;
+    task_handler_set_dry_run(priv_test_handler, true);
+    test_task_handler_run_size(0);
+
+    tasks = task_handler_get_dependents(priv_test_handler,
+                                        priv_test_names[2]);
+    TEST_ASSERT_NOT_NULL(tasks);
+    TEST_ASSERT_EQUAL_PTR(test_task_handler_find(0), tasks[0]);
+    TEST_ASSERT_EQUAL_PTR(test_task_handler_find(1), tasks[1]);
+    TEST_ASSERT_NULL(tasks[2]);
+    free(tasks);
+
+    tasks = task_handler_get_dependencies(priv_test_handler,
+                                          priv_test_names[3]);
+    TEST_ASSERT_NOT_NULL(tasks);
+    TEST_ASSERT_NULL(tasks[0]);
+    free(tasks);
+
+    TEST_ASSERT_TRUE(task_handler_depends_on(priv_test_handler,
+                                             priv_test_names[0],
+                                             priv_test_names[2]));
+    TEST_ASSERT_FALSE(task_handler_depends_on(priv_test_handler,
+                                              priv_test_names[2],
+                                              priv_test_names[0]));
+    TEST_ASSERT_NULL(task_handler_get_dependents(priv_test_handler,
+                                                 "missing"));
+}
+
+static void test_task_handler_providers(void)
+{
+    char log[] = "log";
+    char db[] = "db";
+    char *requires_log[] = {log, NULL};
+    char *requires_db[] = {db, NULL};
+
+    /* The second and the third task provide the log, the first task can
+     * start when any of them is ready. The fourth and the fifth task provide
+     * the database, but both of them fail. */
+    priv_test_services[0].dependency = requires_log;
+    priv_test_services[1].provides = log;
+    priv_test_services[1].action = test_task_handler_fail_action;
+    priv_test_services[2].provides = log;
+    priv_test_services[3].provides = db;
+    priv_test_services[3].action = test_task_handler_fail_action;
+    priv_test_services[4].provides = db;
+    priv_test_services[4].action = test_task_handler_fail_action;
+    priv_test_services[5].dependency = requires_db;
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES - 1);
+
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(0)->status);
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED,
+                      task_get_state(test_task_handler_find(5)));
+    TEST_ASSERT_EQUAL_STRING("no provider of db is ready",
+                             test_task_handler_find(5)->skip_reason);
+
+    /* The three failed tasks, the skipped database and the fifth task. */
+    TEST_ASSERT_EQUAL(5u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_provides_conflict(void)
+{
+    char *requires_0[] = {priv_test_names[0], NULL};
+    char *requires_3[] = {priv_test_names[3], NULL};
+
+    /* The second task provides the name of the fourth task, which is
+     * declared after it, and the fifth task provides the name of the first
+     * task, which is declared before it. The names refer to the real tasks
+     * either way and the providers fail. */
+    priv_test_services[1].provides = priv_test_names[3];
+    priv_test_services[4].provides = priv_test_names[0];
+    priv_test_services[2].dependency = requires_3;
+    priv_test_services[5].dependency = requires_0;
+    test_task_handler_run_size(TEST_TASK_HANDLER_SERVICES - 2);
+
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED,
+                      task_get_state(test_task_handler_find(1)));
+    TEST_ASSERT_EQUAL_STRING("name conflict",
+                             test_task_handler_find(1)->skip_reason);
+    TEST_ASSERT_EQUAL(TASK_STATE_SKIPPED,
+                      task_get_state(test_task_handler_find(4)));
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(2)->status);
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, test_task_handler_find(5)->status);
+    TEST_ASSERT_EQUAL(2u, task_handler_report(priv_test_handler));
+}
+
+static void test_task_handler_priority(void)
+{
+    char *requires_3[] = {priv_test_names[3], NULL};
+    char *requires_4[] = {priv_test_names[4], NULL};
+    int i;
+
+    /* Only one task runs at a time, the head of the longest chain has to go
+     * first even though it comes after the other ready tasks. */
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].group = "disk";
+    }
+    task_handler_set_group_limit(priv_test_handler, "disk", 1u);
+    priv_test_services[4].dependency = requires_3;
+    priv_test_services[5].dependency = requires_4;
+    priv_test_services[3].action = test_task_handler_first_action;
+    test_task_handler_run();
+
+    TEST_ASSERT_EQUAL(3u, test_task_handler_find(3)->priority);
+    TEST_ASSERT_EQUAL(1u, test_task_handler_find(0)->priority);
+    TEST_ASSERT_EQUAL(0, priv_test_first_executed);
+}
+
+static void test_task_handler_timing(void)
+{
+    unsigned long estimate = 0u;
+    timing_db_t *timing_db;
+    int i;
+
+    /* The second task is known to be slow, so it goes first. The tasks
+     * without an estimate count as the average task. */
+    unlink(TEST_TASK_HANDLER_TIMING_DB);
+    TEST_ASSERT_EQUAL(TASK_HANDLER_SUCCESS,
+                      task_handler_set_timing_db(priv_test_handler,
+                                                 TEST_TASK_HANDLER_TIMING_DB));
+    timing_db = priv_test_handler->timing_db;
+    timing_db_update(timing_db, hash_generate(priv_test_names[1]),
+                     timing_db_config_id(&priv_test_services[1]), 5000u);
+    timing_db_update(timing_db, hash_generate(priv_test_names[0]),
+                     timing_db_config_id(&priv_test_services[0]), 10u);
+
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].group = "disk";
+    }
+    task_handler_set_group_limit(priv_test_handler, "disk", 1u);
+    priv_test_services[1].action = test_task_handler_first_action;
+    test_task_handler_run();
+
+    TEST_ASSERT_EQUAL(5000u, test_task_handler_find(1)->priority);
+    TEST_ASSERT_EQUAL(2505u, test_task_handler_find(2)->priority);
+    TEST_ASSERT_EQUAL(0, priv_test_first_executed);
+
+    /* The durations of this run are recorded and written. */
+    timing_db = timing_db_create(TEST_TASK_HANDLER_TIMING_DB);
+    TEST_ASSERT_NOT_NULL(timing_db);
+    TEST_ASSERT_TRUE(timing_db_get(timing_db,
+                                   hash_generate(priv_test_names[0]),
+                                   timing_db_config_id(&priv_test_services[0]),
+                                   &estimate));
+    TEST_ASSERT_TRUE(estimate < 1000u);
+    TEST_ASSERT_TRUE(timing_db_get(timing_db,
+                                   hash_generate(priv_test_names[1]),
+                                   timing_db_config_id(&priv_test_services[1]),
+                                   &estimate));
+    TEST_ASSERT_TRUE(estimate < 5000u);
+    timing_db_destroy(timing_db);
+    unlink(TEST_TASK_HANDLER_TIMING_DB);
+}
+
+static void test_task_handler_simulate(void)
+{
+    static const int durations[] = {300, 200, 100, 250, 50, 100};
+    static const int chain[] = {3, 2, 1, 4};
+    char *requires_0[] = {priv_test_names[0], NULL};
+    char *requires_4[] = {priv_test_names[1], priv_test_names[2], NULL};
+    task_handler_group_t *group;
+    simulator_result_t result;
+    unsigned int i;
+
+    for (i = 0u; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].duration = durations[i];
+    }
+    priv_test_services[1].dependency = requires_0;
+    priv_test_services[4].dependency = requires_4;
+    task_handler_set_dry_run(priv_test_handler, true);
+    task_handler_add_tasks(priv_test_handler, priv_test_services,
+                           TEST_TASK_HANDLER_SERVICES);
+    task_handler_calculate_dependency(priv_test_handler);
+
+    TEST_ASSERT_EQUAL(SIMULATOR_SUCCESS,
+                      simulator_run(priv_test_handler, 1u,
+                                    SIMULATOR_PRIORITY, &result));
+    TEST_ASSERT_EQUAL(1000u, result.makespan);
+    TEST_ASSERT_EQUAL(1000u, result.busy);
+    TEST_ASSERT_EQUAL(TEST_TASK_HANDLER_SERVICES, result.finished);
+    simulator_result_deinit(&result);
+
+    /* The first task and the task with the longest chain start together,
+     * the others queue for the two workers in the order they were ready. */
+    TEST_ASSERT_EQUAL(SIMULATOR_SUCCESS,
+                      simulator_run(priv_test_handler, 2u,
+                                    SIMULATOR_PRIORITY, &result));
+    TEST_ASSERT_EQUAL(600u, result.makespan);
+    TEST_ASSERT_EQUAL(4u, result.chain_size);
+    for (i = 0u; i < result.chain_size; i++) {
+        TEST_ASSERT_EQUAL_PTR(&priv_test_services[chain[i]],
+                              priv_test_handler->nodes[result.chain[i]]->
+                              service);
+    }
+    simulator_result_deinit(&result);
+
+    /* The admission is simulated, the fourth task waits for the first one
+     * in the same group. Nothing is left admitted afterwards. */
+    task_handler_set_group_limit(priv_test_handler, "disk", 1u);
+    queue_first(priv_test_handler->groups);
+    group = queue_get_current(priv_test_handler->groups);
+    test_task_handler_find(0)->group = group;
+    test_task_handler_find(3)->group = group;
+    TEST_ASSERT_EQUAL(SIMULATOR_SUCCESS,
+                      simulator_run(priv_test_handler, 4u,
+                                    SIMULATOR_FIFO, &result));
+    TEST_ASSERT_EQUAL(550u, result.makespan);
+    simulator_result_deinit(&result);
+    TEST_ASSERT_EQUAL(0u, priv_test_handler->running);
+    TEST_ASSERT_EQUAL(0u, group->running);
+    TEST_ASSERT_EQUAL(0, priv_test_executed);
+}
+
+/* Counts the dependencies in the checked dependency graph of a handler. */
+static unsigned int test_task_handler_count_edges(task_handler_t *handler)
+{
+    unsigned int edges = 0u;
+    unsigned int i;
+
+    for (i = 0u; i < handler->graph->edges_size; i++) {
+        if (!task_graph_is_removed(handler->graph, i)) {
+            edges++;
+        }
+    }
+    return edges;
+}
+
+static void test_task_handler_simulate_listen(void)
+{
+    char *listen[] = {"tcp:127.0.0.1:0", NULL};
+    char *requires_0[] = {priv_test_names[0], NULL};
+    task_handler_t *handler;
+    simulator_result_t result;
+    int i;
+
+    /* The second task requires the first task, which listens on a socket.
+     * A real boot doesn't wait for the first task and neither does the
+     * simulated boot. */
+    for (i = 0; i < TEST_TASK_HANDLER_SERVICES; i++) {
+        priv_test_services[i].duration = 100;
+    }
+    priv_test_services[0].listen = listen;
+    priv_test_services[1].dependency = requires_0;
+    test_task_handler_run();
+    TEST_ASSERT_EQUAL(0u, test_task_handler_count_edges(priv_test_handler));
+
+    handler = task_handler_create(priv_test_thread_pool);
+    task_handler_set_dry_run(handler, true);
+    task_handler_set_simulate(handler, true);
+    task_handler_add_tasks(handler, priv_test_services,
+                           TEST_TASK_HANDLER_SERVICES);
+    task_handler_calculate_dependency(handler);
+    TEST_ASSERT_EQUAL(0u, test_task_handler_count_edges(handler));
+    TEST_ASSERT_EQUAL(SIMULATOR_SUCCESS,
+                      simulator_run(handler, 6u, SIMULATOR_PRIORITY,
+                                    &result));
+    TEST_ASSERT_EQUAL(100u, result.makespan);
+    simulator_result_deinit(&result);
+    task_handler_destroy(handler);
+
+    /* Any other dry run, like the one that stops the services, keeps the
+     * dependency since no socket is opened. */
+    handler = task_handler_create(priv_test_thread_pool);
+    task_handler_set_dry_run(handler, true);
+    task_handler_add_tasks(handler, priv_test_services,
+                           TEST_TASK_HANDLER_SERVICES);
+    task_handler_calculate_dependency(handler);
+    TEST_ASSERT_EQUAL(1u, test_task_handler_count_edges(handler));
+    task_handler_destroy(handler);
+}
+
+static void test_task_handler_analyze(void)
+{
+    char *requires_0[] = {priv_test_names[0], NULL};
+    char *requires_1[] = {priv_test_names[1], NULL};
+    analysis_t analysis;
+    task_t *task;
+    unsigned int i;
+
+    /* The chain of three tasks takes the longest, the other tasks run
+     * beside it. */
+    priv_test_services[1].dependency = requires_0;
+    priv_test_services[2].dependency = requires_1;
+    test_task_handler_run();
+
+    TEST_ASSERT_EQUAL(ANALYSIS_SUCCESS,
+                      analysis_run(priv_test_handler, &analysis));
+    TEST_ASSERT_EQUAL(3u, analysis.chain_size);
+    for (i = 0u; i < analysis.chain_size; i++) {
+        task = priv_test_handler->nodes[analysis.chain[i]];
+        TEST_ASSERT_EQUAL_PTR(&priv_test_services[i], task->service);
+        TEST_ASSERT_TRUE(task->start_time >= task->ready_time);
+        TEST_ASSERT_TRUE(task->end_time - task->start_time >= 20000u);
+    }
+    TEST_ASSERT_TRUE(test_task_handler_find(2)->ready_time >=
+                     test_task_handler_find(1)->end_time);
+    TEST_ASSERT_EQUAL(test_task_handler_find(2)->end_time, analysis.wall);
+    analysis_deinit(&analysis);
+}
+
+static void test_task_handler_usage(void)
+{
+    task_t *task;
+
+    /* The command burns some CPU time, the action of the other service
+     * isn't a process and has nothing to reap. */
+    priv_test_services[0].action = NULL;
+    priv_test_services[0].exec = "i=0; while [ $i -lt 20000 ]; do "
+                                 "i=$((i + 1)); done";
+
+    task_handler_add_tasks(priv_test_handler, priv_test_services, 2u);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+
+    task = test_task_handler_find(0);
+    TEST_ASSERT_EQUAL(TASK_SUCCESS, task->status);
+    TEST_ASSERT_TRUE(task->reaped);
+    TEST_ASSERT_TRUE(task->usage.spawn_time > 0u);
+    TEST_ASSERT_TRUE(task->usage.user_time + task->usage.system_time > 0u);
+    TEST_ASSERT_TRUE(task->usage.max_rss > 0);
+    TEST_ASSERT_TRUE(task->usage.minor_faults > 0);
+    TEST_ASSERT_FALSE(test_task_handler_find(1)->reaped);
+}
+
+static void test_task_handler_class(void)
+{
+    int nice;
+
+    /* The worker follows the class of the service while the action runs
+     * and gets its own class back afterwards. */
+    errno = 0;
+    nice = getpriority(PRIO_PROCESS, 0);
+    TEST_ASSERT_EQUAL(0, errno);
+    priv_test_services[0].action = test_task_handler_class_action;
+    priv_test_services[0].sched = SERVICE_SCHED_IDLE;
+    priv_test_services[0].nice = nice + 5;
+
+    task_handler_add_tasks(priv_test_handler, priv_test_services, 1u);
+    task_handler_calculate_dependency(priv_test_handler);
+    task_handler_wait(priv_test_handler);
+
+    TEST_ASSERT_EQUAL(1, priv_test_executed);
+    TEST_ASSERT_EQUAL(SCHED_IDLE, priv_test_class_policy);
+    TEST_ASSERT_EQUAL(nice + 5, priv_test_class_nice);
+    TEST_ASSERT_EQUAL(SCHED_OTHER, sched_getscheduler(priv_test_class_tid));
+    TEST_ASSERT_EQUAL(nice, getpriority(PRIO_PROCESS, priv_test_class_tid));
+}
+
+void test_task_handler(void)
+{
+    TEST_CASE_START();
+
+    /* Test that all tasks are executed without any limits. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_run);
+
+    /* Test that a group limit is respected. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_group_limit);
+
+    /* Test that the I/O budget is respected. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_io_budget);
+
+    /* Test that the memory budget is respected. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_mem_budget);
+
+    /* Test that the dependent tasks are started when a task is ready. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_notify);
+
+    /* Test how failed and missing dependencies affect the tasks. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_dependency_kinds);
+
+    /* Test that the tasks which require a failed task are skipped. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_skip);
+
+    /* Test that a command which runs for too long fails. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_timeout);
+
+    /* Test that only the closure of the targets is started. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_targets);
+
+    /* Test that a target is reached without being executed. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_target);
+
+    /* Test that dependencies on the same set of tasks are collapsed. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_collapse);
+
+    /* Test that the implied dependencies are removed. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_reduce);
+
+    /* Test that the dependency cycles are broken. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_cycle);
+
+    /* Test that the dependency graph can be queried. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_query);
+
+    /* Test that a name can be provided by several tasks. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_providers);
+
+    /* Test that a task can't provide the name of another task. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_provides_conflict);
+
+    /* Test that the longest chain of tasks is started first. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_priority);
+
+    /* Test that the recorded durations decide the order. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_timing);
+
+    /* Test that a boot is simulated with the estimated durations. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_simulate);
+
+    /* Test that a simulated boot doesn't wait for the tasks with sockets. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_simulate_listen);
+
+    /* Test that the chain which decided the boot time is found. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_analyze);
+
+    /* Test that a timeout stops every process of the command. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_timeout_group);
+
+    /* Test that a command gets its own environment. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_environment);
+
+    /* Test that the resources of a command are recorded when it exits. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_usage);
+
+    /* Test that a worker gets its class back after a service. */
+    TEST_CASE_RUN(test_task_handler_init,
+                  test_task_handler_cleanup,
+                  test_task_handler_class);
+
+    TEST_CASE_END();
+}
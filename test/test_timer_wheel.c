@@ -0,0 +1,166 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "test_handler.h"
+#include "../src/timer_wheel.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+static timer_wheel_t *priv_test_wheel;
+static unsigned int priv_test_expired;
+
+static void test_timer_wheel_expired(timer_wheel_timer_t *timer)
+{
+    (void) timer;
+    __atomic_add_fetch(&priv_test_expired, 1u, __ATOMIC_RELEASE);
+}
+
+/* Adds the timer again the first time it expires. */
+static void test_timer_wheel_expired_again(timer_wheel_timer_t *timer)
+{
+    if (__atomic_add_fetch(&priv_test_expired, 1u, __ATOMIC_RELEASE) == 1u) {
+        timer_wheel_add(priv_test_wheel, timer, 10u);
+    }
+}
+
+static void test_timer_wheel_init(void)
+{
+    priv_test_wheel = timer_wheel_create(1u);
+    priv_test_expired = 0u;
+}
+
+static void test_timer_wheel_cleanup(void)
+{
+    timer_wheel_destroy(priv_test_wheel);
+}
+
+static void test_timer_wheel_expires(void)
+{
+    unsigned long timeouts[] = {1u, 63u, 64u, 100u, 4095u, 5000u, 300000u};
+    timer_wheel_timer_t timers[7];
+    unsigned long elapsed = 0u;
+    unsigned int i;
+
+    TEST_ASSERT_NOT_NULL(priv_test_wheel);
+
+    /* Start somewhere in the middle so that the timers are cascaded. */
+    timer_wheel_advance(priv_test_wheel, 1000u);
+
+    for (i = 0u; i < 7u; i++) {
+        timer_wheel_timer_init(&timers[i], test_timer_wheel_expired, NULL);
+        timer_wheel_add(priv_test_wheel, &timers[i], timeouts[i]);
+    }
+
+    /* Every timer should expire on its tick, not earlier or later. */
+    for (i = 0u; i < 7u; i++) {
+        timer_wheel_advance(priv_test_wheel, timeouts[i] - elapsed);
+        elapsed = timeouts[i];
+        TEST_ASSERT_EQUAL(i, priv_test_expired);
+        timer_wheel_advance(priv_test_wheel, 1u);
+        elapsed++;
+        TEST_ASSERT_EQUAL(i + 1u, priv_test_expired);
+        TEST_ASSERT_FALSE(timers[i].armed);
+    }
+    TEST_ASSERT_EQUAL(0u, priv_test_wheel->timers);
+}
+
+static void test_timer_wheel_cancel(void)
+{
+    timer_wheel_timer_t first;
+    timer_wheel_timer_t second;
+
+    TEST_ASSERT_NOT_NULL(priv_test_wheel);
+    timer_wheel_timer_init(&first, test_timer_wheel_expired, NULL);
+    timer_wheel_timer_init(&second, test_timer_wheel_expired, NULL);
+
+    timer_wheel_add(priv_test_wheel, &first, 200u);
+    timer_wheel_add(priv_test_wheel, &second, 200u);
+    timer_wheel_cancel(priv_test_wheel, &first);
+
+    /* Cancelling a timer which isn't armed should be harmless. */
+    timer_wheel_cancel(priv_test_wheel, &first);
+
+    /* Adding an armed timer again should move it. */
+    timer_wheel_add(priv_test_wheel, &second, 300u);
+
+    timer_wheel_advance(priv_test_wheel, 301u);
+    TEST_ASSERT_EQUAL(1u, priv_test_expired);
+    TEST_ASSERT_EQUAL(0u, priv_test_wheel->timers);
+}
+
+static void test_timer_wheel_add_expired(void)
+{
+    timer_wheel_timer_t timer;
+
+    TEST_ASSERT_NOT_NULL(priv_test_wheel);
+    timer_wheel_timer_init(&timer, test_timer_wheel_expired_again, NULL);
+
+    /* The timer should be possible to add again when it expires. */
+    timer_wheel_add(priv_test_wheel, &timer, 10u);
+    timer_wheel_advance(priv_test_wheel, 11u);
+    TEST_ASSERT_EQUAL(1u, priv_test_expired);
+    TEST_ASSERT_TRUE(timer.armed);
+    timer_wheel_advance(priv_test_wheel, 10u);
+    TEST_ASSERT_EQUAL(2u, priv_test_expired);
+}
+
+static void test_timer_wheel_thread(void)
+{
+    struct timespec delay = {0, 10000000L};
+    timer_wheel_timer_t timer;
+    int i;
+
+    TEST_ASSERT_NOT_NULL(priv_test_wheel);
+    timer_wheel_timer_init(&timer, test_timer_wheel_expired, NULL);
+    TEST_ASSERT_EQUAL(TIMER_WHEEL_SUCCESS, timer_wheel_start(priv_test_wheel));
+
+    /* The timer thread should expire the timer in real time. */
+    timer_wheel_add(priv_test_wheel, &timer, 30u);
+    for (i = 0; (i < 200) &&
+         (__atomic_load_n(&priv_test_expired, __ATOMIC_ACQUIRE) == 0u); i++) {
+        nanosleep(&delay, NULL);
+    }
+    TEST_ASSERT_EQUAL(1u, __atomic_load_n(&priv_test_expired,
+                                          __ATOMIC_ACQUIRE));
+}
+
+void test_timer_wheel(void)
+{
+    TEST_CASE_START();
+
+    /* Test that timers in all levels expire on time. */
+    TEST_CASE_RUN(test_timer_wheel_init,
+                  test_timer_wheel_cleanup,
+                  test_timer_wheel_expires);
+
+    /* Test that cancelled timers don't expire. */
+    TEST_CASE_RUN(test_timer_wheel_init,
+                  test_timer_wheel_cleanup,
+                  test_timer_wheel_cancel);
+
+    /* Test that a timer can be added from its expired function. */
+    TEST_CASE_RUN(test_timer_wheel_init,
+                  test_timer_wheel_cleanup,
+                  test_timer_wheel_add_expired);
+
+    /* Test that the timer thread drives the timer wheel. */
+    TEST_CASE_RUN(test_timer_wheel_init,
+                  test_timer_wheel_cleanup,
+                  test_timer_wheel_thread);
+
+    TEST_CASE_END();
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright (c) 2013, Peter Johansson <peter.johansson@gmx.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+#include "test_handler.h"
+#include "../src/timing_db.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#define TEST_TIMING_DB_PATH "/tmp/speedy_test_timing.db"
+
+static timing_db_t *priv_test_db;
+
+static void test_timing_db_init(void)
+{
+    unlink(TEST_TIMING_DB_PATH);
+    priv_test_db = timing_db_create(TEST_TIMING_DB_PATH);
+}
+
+static void test_timing_db_cleanup(void)
+{
+    timing_db_destroy(priv_test_db);
+    unlink(TEST_TIMING_DB_PATH);
+}
+
+static void test_timing_db_estimate(void)
+{
+    unsigned long estimate = 0u;
+
+    TEST_ASSERT_NOT_NULL(priv_test_db);
+    TEST_ASSERT_FALSE(timing_db_get(priv_test_db, 1u, 2u, &estimate));
+
+    /* The first duration is the estimate, the next ones are weighted in. */
+    timing_db_update(priv_test_db, 1u, 2u, 1000u);
+    TEST_ASSERT_TRUE(timing_db_get(priv_test_db, 1u, 2u, &estimate));
+    TEST_ASSERT_EQUAL(1000u, estimate);
+
+    timing_db_update(priv_test_db, 1u, 2u, 2000u);
+    timing_db_get(priv_test_db, 1u, 2u, &estimate);
+    TEST_ASSERT_EQUAL(1250u, estimate);
+
+    timing_db_update(priv_test_db, 1u, 2u, 50u);
+    timing_db_get(priv_test_db, 1u, 2u, &estimate);
+    TEST_ASSERT_EQUAL(950u, estimate);
+
+    /* The estimate doesn't apply to another configuration and starts over
+       when the configuration changes. */
+    TEST_ASSERT_FALSE(timing_db_get(priv_test_db, 1u, 3u, &estimate));
+    timing_db_update(priv_test_db, 1u, 3u, 20u);
+    TEST_ASSERT_TRUE(timing_db_get(priv_test_db, 1u, 3u, &estimate));
+    TEST_ASSERT_EQUAL(20u, estimate);
+    TEST_ASSERT_FALSE(timing_db_get(priv_test_db, 1u, 2u, &estimate));
+}
+
+static void test_timing_db_save(void)
+{
+    unsigned long estimate = 0u;
+    timing_db_t *db;
+
+    TEST_ASSERT_NOT_NULL(priv_test_db);
+    timing_db_update(priv_test_db, 1u, 2u, 3000u);
+    timing_db_update(priv_test_db, 0xfffffffeu, 4u, 20u);
+    TEST_ASSERT_EQUAL(TIMING_DB_SUCCESS, timing_db_save(priv_test_db));
+
+    /* The estimates are read back by the next boot. */
+    db = timing_db_create(TEST_TIMING_DB_PATH);
+    TEST_ASSERT_NOT_NULL(db);
+    TEST_ASSERT_TRUE(timing_db_get(db, 1u, 2u, &estimate));
+    TEST_ASSERT_EQUAL(3000u, estimate);
+    TEST_ASSERT_TRUE(timing_db_get(db, 0xfffffffeu, 4u, &estimate));
+    TEST_ASSERT_EQUAL(20u, estimate);
+
+    timing_db_update(db, 1u, 2u, 1000u);
+    timing_db_get(db, 1u, 2u, &estimate);
+    TEST_ASSERT_EQUAL(2500u, estimate);
+    timing_db_destroy(db);
+}
+
+void test_timing_db(void)
+{
+    TEST_CASE_START();
+
+    /* Test that the durations are averaged per configuration. */
+    TEST_CASE_RUN(test_timing_db_init,
+                  test_timing_db_cleanup,
+                  test_timing_db_estimate);
+
+    /* Test that the estimates are kept between the boots. */
+    TEST_CASE_RUN(test_timing_db_init,
+                  test_timing_db_cleanup,
+                  test_timing_db_save);
+
+    TEST_CASE_END();
+}
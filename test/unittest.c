@@ -22,6 +22,16 @@
 #include "test_observer.h"
 #include "test_subject.h"
 #include "test_config_parser.h"
+#include "test_thread_pool.h"
+#include "test_task_handler.h"
+#include "test_pressure.h"
+#include "test_listener.h"
+#include "test_timer_wheel.h"
+#include "test_task_graph.h"
+#include "test_shutdown.h"
+#include "test_timing_db.h"
+#include "test_stats.h"
+#include "test_trace.h"
 
 int main(int argc, char *argv[])
 {
@@ -33,6 +43,16 @@ int main(int argc, char *argv[])
     test_observer();
     test_subject();
     test_config_parser();
+    test_thread_pool();
+    test_task_handler();
+    test_pressure();
+    test_listener();
+    test_timer_wheel();
+    test_task_graph();
+    test_shutdown();
+    test_timing_db();
+    test_stats();
+    test_trace();
 
     test_handler_deinit();
 